@@ -0,0 +1,89 @@
+#include <algo.hpp>
+#include <algorithm>
+#include <array.hpp>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector.hpp>
+
+// needle sits at the very end, so every kernel scans the whole range
+template <typename T> static vector<T> make_haystack(std::size_t n) {
+	vector<T> vec;
+	vec.resize(n);
+	vec[n - 1] = T(1);
+	return vec;
+}
+
+template <typename T> static void BM_std_find(benchmark::State &state) {
+	auto vec = make_haystack<T>(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::find(vec.begin(), vec.end(), T(1)));
+	state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template <typename T, tp::algo::isa level>
+static void BM_tp_find(benchmark::State &state) {
+	auto vec = make_haystack<T>(state.range(0));
+	tp::algo::set_isa(level);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(tp::algo::find(vec.begin(), vec.end(), T(1)));
+	tp::algo::set_isa(tp::algo::isa::avx2);
+	state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template <typename T, tp::algo::isa level>
+static void BM_tp_count(benchmark::State &state) {
+	auto vec = make_haystack<T>(state.range(0));
+	tp::algo::set_isa(level);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(
+		    tp::algo::count(vec.begin(), vec.end(), T(1)));
+	tp::algo::set_isa(tp::algo::isa::avx2);
+	state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template <typename T> static void BM_std_min_element(benchmark::State &state) {
+	auto vec = make_haystack<T>(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::min_element(vec.begin(), vec.end()));
+	state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template <typename T> static void BM_tp_min_element(benchmark::State &state) {
+	auto vec = make_haystack<T>(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(
+		    tp::algo::min_element(vec.begin(), vec.end()));
+	state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+#define TP_ALGO_SIZES RangeMultiplier(8)->Range(16, 1 << 20)
+
+BENCHMARK(BM_std_find<std::int32_t>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<std::int32_t, tp::algo::isa::scalar>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<std::int32_t, tp::algo::isa::sse2>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<std::int32_t, tp::algo::isa::avx2>)->TP_ALGO_SIZES;
+
+BENCHMARK(BM_std_find<float>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<float, tp::algo::isa::sse2>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<float, tp::algo::isa::avx2>)->TP_ALGO_SIZES;
+
+BENCHMARK(BM_std_find<std::uint8_t>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<std::uint8_t, tp::algo::isa::sse2>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_find<std::uint8_t, tp::algo::isa::avx2>)->TP_ALGO_SIZES;
+
+BENCHMARK(BM_tp_count<std::int32_t, tp::algo::isa::scalar>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_count<std::int32_t, tp::algo::isa::avx2>)->TP_ALGO_SIZES;
+
+BENCHMARK(BM_std_min_element<float>)->TP_ALGO_SIZES;
+BENCHMARK(BM_tp_min_element<float>)->TP_ALGO_SIZES;
+
+// a fixed-size tp::array, the other contiguous container
+static void BM_tp_find_array(benchmark::State &state) {
+	static tp::array<std::uint8_t, 4096> arr{};
+	arr[4095] = 1;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(
+		    tp::algo::find(arr.begin(), arr.end(), std::uint8_t(1)));
+	state.SetBytesProcessed(state.iterations() * arr.size());
+}
+BENCHMARK(BM_tp_find_array);
@@ -0,0 +1,292 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <deque.hpp>
+#include <deque>
+#include <numeric>
+#include <segmented.hpp>
+#include <vector>
+
+#include <malloc.h>
+#include <unistd.h>
+
+// FIFO queue in steady state: push at the back, pop at the front, with
+// state.range(0) elements queued. Every block's worth of traffic frees a
+// block at the front and needs a new one at the back.
+template <typename Deque>
+static void queue_traffic(benchmark::State &state, Deque &dq) {
+	for (int i = 0; i < state.range(0); ++i)
+		dq.push_back(i);
+	long sum = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < 1024; ++i) {
+			dq.push_back(i);
+			sum += dq.front();
+			dq.pop_front();
+		}
+	}
+	benchmark::DoNotOptimize(sum);
+	state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+static void BM_queue_std_deque(benchmark::State &state) {
+	std::deque<int> dq;
+	queue_traffic(state, dq);
+}
+BENCHMARK(BM_queue_std_deque)->Arg(16)->Arg(1000);
+
+static void BM_queue_tp_deque(benchmark::State &state) {
+	deque<int> dq;
+	dq.set_spare_block_limit(state.range(1));
+	queue_traffic(state, dq);
+}
+BENCHMARK(BM_queue_tp_deque)
+    ->ArgNames({"depth", "spare"})
+    ->Args({16, 0})
+    ->Args({16, DEQUE_SPARE_BLOCKS})
+    ->Args({1000, 0})
+    ->Args({1000, DEQUE_SPARE_BLOCKS});
+
+// a LIFO stack hovering around a block boundary at the back
+static void BM_stack_boundary_tp_deque(benchmark::State &state) {
+	deque<int> dq;
+	dq.set_spare_block_limit(state.range(0));
+	for (std::size_t i = 0; i < deque_buf_size(sizeof(int)) - 4; ++i)
+		dq.push_back(i);
+	for (auto _ : state) {
+		for (int i = 0; i < 8; ++i)
+			dq.push_back(i);
+		for (int i = 0; i < 8; ++i)
+			dq.pop_back();
+	}
+	state.SetItemsProcessed(state.iterations() * 16);
+}
+BENCHMARK(BM_stack_boundary_tp_deque)->ArgName("spare")->Arg(0)->Arg(1);
+
+template <std::size_t Bytes> struct blob {
+	char bytes[Bytes];
+};
+
+// push_back 8 MB worth of elements, then read them back in order and at
+// random, for a given element size and block size
+template <std::size_t ElemBytes, std::size_t BlockBytes>
+static void BM_block_size(benchmark::State &state) {
+	using elem                 = blob<ElemBytes>;
+	constexpr std::size_t n    = (std::size_t(8) << 20) / ElemBytes;
+	constexpr std::size_t mask = n - 1;
+	for (auto _ : state) {
+		deque<elem, std::allocator<elem>, BlockBytes> dq;
+		for (std::size_t i = 0; i < n; ++i)
+			dq.push_back(elem{{char(i)}});
+		long sum = 0;
+		for (auto it = dq.begin(); it != dq.end(); ++it)
+			sum += it->bytes[0];
+		for (std::size_t i = 0, j = 1; i < n; ++i, j = (j * 5 + 1) & mask)
+			sum += dq[j].bytes[0];
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * (n * ElemBytes));
+}
+
+#define TP_DEQUE_BLOCK_SIZES(elem)                                             \
+	BENCHMARK(BM_block_size<elem, 512>)->Unit(benchmark::kMillisecond);        \
+	BENCHMARK(BM_block_size<elem, 4096>)->Unit(benchmark::kMillisecond);       \
+	BENCHMARK(BM_block_size<elem, 65536>)->Unit(benchmark::kMillisecond)
+
+TP_DEQUE_BLOCK_SIZES(1);
+TP_DEQUE_BLOCK_SIZES(16);
+TP_DEQUE_BLOCK_SIZES(64);
+TP_DEQUE_BLOCK_SIZES(256);
+TP_DEQUE_BLOCK_SIZES(1024);
+
+// Bulk algorithms over a deque<int>: the std versions step deque_iterator
+// one element at a time, the tp versions (segmented.hpp) run per block over
+// raw pointers.
+static deque<int> &bulk_deque(std::size_t n) {
+	static deque<int> dq;
+	dq.clear();
+	for (std::size_t i = 0; i < n; ++i)
+		dq.push_back(int(i));
+	return dq;
+}
+
+static void BM_bulk_copy_std(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	std::vector<int> out(dq.size());
+	for (auto _ : state) {
+		std::copy(dq.begin(), dq.end(), out.begin());
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_copy_tp(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	std::vector<int> out(dq.size());
+	for (auto _ : state) {
+		tp::copy(dq.begin(), dq.end(), out.begin());
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_fill_std(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state) {
+		std::fill(dq.begin(), dq.end(), 7);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_fill_tp(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state) {
+		tp::fill(dq.begin(), dq.end(), 7);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_find_std(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::find(dq.begin(), dq.end(), -1));
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_find_tp(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(tp::find(dq.begin(), dq.end(), -1));
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_sum_std(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::accumulate(dq.begin(), dq.end(), 0L));
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+static void BM_bulk_sum_tp(benchmark::State &state) {
+	deque<int> &dq = bulk_deque(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(tp::accumulate(dq.begin(), dq.end(), 0L));
+	state.SetItemsProcessed(state.iterations() * dq.size());
+}
+
+BENCHMARK(BM_bulk_copy_std)->Arg(1 << 16);
+BENCHMARK(BM_bulk_copy_tp)->Arg(1 << 16);
+BENCHMARK(BM_bulk_fill_std)->Arg(1 << 16);
+BENCHMARK(BM_bulk_fill_tp)->Arg(1 << 16);
+BENCHMARK(BM_bulk_find_std)->Arg(1 << 16);
+BENCHMARK(BM_bulk_find_tp)->Arg(1 << 16);
+BENCHMARK(BM_bulk_sum_std)->Arg(1 << 16);
+BENCHMARK(BM_bulk_sum_tp)->Arg(1 << 16);
+
+// resident set size of the process in MiB
+static double rss_mib() {
+	long pages = 0, resident = 0;
+	if (FILE *f = std::fopen("/proc/self/statm", "r")) {
+		if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2)
+			resident = 0;
+		std::fclose(f);
+	}
+	return double(resident) * ::sysconf(_SC_PAGESIZE) / (1 << 20);
+}
+
+/*
+ * A long-lived queue takes a burst of 64 MiB of elements, drains back to
+ * 1000 and then runs as a steady FIFO queue. Counters give the RSS before
+ * the burst, at its peak, after the drain and after the steady phase,
+ * without and with shrink_to_fit() after the drain, for the default spare
+ * block cache and one large enough to keep every block. malloc_trim keeps
+ * memory glibc holds in its free lists out of the numbers.
+ */
+static void BM_burst_rss(benchmark::State &state) {
+	const bool shrink = state.range(1);
+	const int burst   = (64 << 20) / sizeof(int);
+	double idle = 0, peak = 0, drained = 0, steady = 0;
+	for (auto _ : state) {
+		::malloc_trim(0);
+		idle = rss_mib();
+		deque<int> dq;
+		dq.set_spare_block_limit(state.range(0));
+		for (int i = 0; i < burst; ++i)
+			dq.push_back(i);
+		peak = rss_mib();
+		while (dq.size() > 1000)
+			dq.pop_front();
+		if (shrink)
+			dq.shrink_to_fit();
+		::malloc_trim(0);
+		drained = rss_mib();
+		for (int i = 0; i < burst; ++i) {
+			dq.push_back(i);
+			dq.pop_front();
+		}
+		::malloc_trim(0);
+		steady = rss_mib();
+		benchmark::DoNotOptimize(dq.front());
+	}
+	state.counters["idle_MiB"]    = idle;
+	state.counters["peak_MiB"]    = peak;
+	state.counters["drained_MiB"] = drained;
+	state.counters["steady_MiB"]  = steady;
+}
+BENCHMARK(BM_burst_rss)
+    ->ArgNames({"spare", "shrink"})
+    ->Args({DEQUE_SPARE_BLOCKS, 0})
+    ->Args({DEQUE_SPARE_BLOCKS, 1})
+    ->Args({1 << 20, 0})
+    ->Args({1 << 20, 1})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+// Ingest: append batches of 16-byte records, one push_back per record or
+// one append_range per batch (memcpy per block).
+struct record {
+	long key;
+	long value;
+};
+
+static void BM_ingest_push_back(benchmark::State &state) {
+	std::vector<record> batch(state.range(0));
+	deque<record> dq;
+	for (auto _ : state) {
+		dq.clear();
+		for (int b = 0; b < 64; ++b)
+			for (const record &r : batch)
+				dq.push_back(r);
+		benchmark::DoNotOptimize(dq.back());
+	}
+	state.SetItemsProcessed(state.iterations() * 64 * batch.size());
+}
+
+static void BM_ingest_append_range(benchmark::State &state) {
+	std::vector<record> batch(state.range(0));
+	deque<record> dq;
+	for (auto _ : state) {
+		dq.clear();
+		for (int b = 0; b < 64; ++b)
+			dq.append_range(batch);
+		benchmark::DoNotOptimize(dq.back());
+	}
+	state.SetItemsProcessed(state.iterations() * 64 * batch.size());
+}
+
+static void BM_ingest_std_deque(benchmark::State &state) {
+	std::vector<record> batch(state.range(0));
+	std::deque<record> dq;
+	for (auto _ : state) {
+		dq.clear();
+		for (int b = 0; b < 64; ++b)
+			dq.insert(dq.end(), batch.begin(), batch.end());
+		benchmark::DoNotOptimize(dq.back());
+	}
+	state.SetItemsProcessed(state.iterations() * 64 * batch.size());
+}
+
+BENCHMARK(BM_ingest_push_back)->Arg(16)->Arg(1024);
+BENCHMARK(BM_ingest_append_range)->Arg(16)->Arg(1024);
+BENCHMARK(BM_ingest_std_deque)->Arg(16)->Arg(1024);
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <list.hpp>
+#include <list>
+#include <memory_resource>
+#include <random>
+#include <vector.hpp>
+
+/*
+ * Sorting n random ints in place. Values are rewritten between
+ * iterations, untimed, so every sort starts from a random order; after
+ * the first one the node order is scattered in memory too, as in a
+ * long-lived list.
+ *
+ * The node-sorting lists take their nodes from a fresh arena: otherwise
+ * a list allocated right after a big one was freed lands in its
+ * scattered free chunks, and the result depends on which case ran before.
+ */
+template <typename List>
+static void refill(List &lt, std::mt19937 &rng) {
+	for (auto &x : lt)
+		x = int(rng());
+}
+
+static void sizes(benchmark::internal::Benchmark *b) {
+	b->RangeMultiplier(10)->Range(1000, 10000000)->Unit(
+	    benchmark::kMillisecond);
+}
+
+static void BM_list_sort_std(benchmark::State &state) {
+	std::mt19937 rng(1);
+	std::pmr::monotonic_buffer_resource arena;
+	std::pmr::list<int> lt(state.range(0), &arena);
+	for (auto _ : state) {
+		state.PauseTiming();
+		refill(lt, rng);
+		state.ResumeTiming();
+		lt.sort();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_list_sort_std)->Apply(sizes);
+
+static void BM_list_sort_tp(benchmark::State &state) {
+	std::mt19937 rng(1);
+	std::pmr::monotonic_buffer_resource arena;
+	list<int, std::pmr::polymorphic_allocator<int>> lt(state.range(0),
+	                                                   &arena);
+	for (auto _ : state) {
+		state.PauseTiming();
+		refill(lt, rng);
+		state.ResumeTiming();
+		lt.sort();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_list_sort_tp)->Apply(sizes);
+
+// the old workaround: copy out to a vector, sort, rebuild the list
+static void BM_list_sort_via_vector(benchmark::State &state) {
+	std::mt19937 rng(1);
+	list<int> lt(state.range(0));
+	for (auto _ : state) {
+		state.PauseTiming();
+		refill(lt, rng);
+		state.ResumeTiming();
+		vector<int> tmp;
+		tmp.reserve(lt.size());
+		for (int x : lt)
+			tmp.push_back(x);
+		std::sort(tmp.begin(), tmp.end());
+		lt.clear();
+		for (int x : tmp)
+			lt.push_back(x);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_list_sort_via_vector)->Apply(sizes);
@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <mapped_vector.hpp>
+#include <unistd.h>
+#include <vector.hpp>
+
+struct record {
+	long key;
+	double value;
+};
+
+static constexpr long record_count = 1 << 22; // 64 MB of records
+static const char *record_path     = "/tmp/tp_bench_records";
+
+static void write_records() {
+	static bool written = false;
+	if (written)
+		return;
+	std::remove(record_path);
+	tp::mapped_vector<record> vec(record_path);
+	vec.reserve(record_count);
+	for (long i = 0; i < record_count; ++i)
+		vec.push_back({i, i * 0.25});
+	vec.flush();
+	written = true;
+}
+
+// throw the file out of the page cache
+static void drop_cache() {
+	int fd = ::open(record_path, O_RDONLY);
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	::close(fd);
+}
+
+static double sum_keys(const tp::mapped_vector<record> &vec) {
+	double sum = 0;
+	for (std::size_t i = 0; i < vec.size(); ++i)
+		sum += vec[i].key;
+	return sum;
+}
+
+// open read-only and touch every record
+static void BM_mapped_open(benchmark::State &state) {
+	write_records();
+	bool cold = state.range(0);
+	for (auto _ : state) {
+		if (cold) {
+			state.PauseTiming();
+			drop_cache();
+			state.ResumeTiming();
+		}
+		tp::mapped_vector<record> vec(
+		    record_path, tp::mapped_vector<record>::open_mode::read_only);
+		benchmark::DoNotOptimize(sum_keys(vec));
+	}
+	state.SetBytesProcessed(state.iterations() * record_count *
+	                        sizeof(record));
+}
+BENCHMARK(BM_mapped_open)->ArgName("cold")->Arg(0)->Arg(1)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
+
+// open read-only and look at one record: what a restart costs up front
+static void BM_mapped_open_lazy(benchmark::State &state) {
+	write_records();
+	for (auto _ : state) {
+		tp::mapped_vector<record> vec(
+		    record_path, tp::mapped_vector<record>::open_mode::read_only);
+		benchmark::DoNotOptimize(vec[record_count / 2].key);
+	}
+}
+BENCHMARK(BM_mapped_open_lazy)->Unit(benchmark::kMicrosecond);
+
+// the baseline: read() the whole file into a vector
+static void BM_read_into_vector(benchmark::State &state) {
+	write_records();
+	bool cold = state.range(0);
+	for (auto _ : state) {
+		if (cold) {
+			state.PauseTiming();
+			drop_cache();
+			state.ResumeTiming();
+		}
+		vector<record> vec;
+		int fd = ::open(record_path, O_RDONLY);
+		::lseek(fd, 64, SEEK_SET);
+		vec.append_uninitialized(record_count, [&](record *p, std::size_t n) {
+			return std::size_t(::read(fd, p, n * sizeof(record))) /
+			       sizeof(record);
+		});
+		::close(fd);
+		double sum = 0;
+		for (auto &r : vec)
+			sum += r.key;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * record_count *
+	                        sizeof(record));
+}
+BENCHMARK(BM_read_into_vector)->ArgName("cold")->Arg(0)->Arg(1)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <mpmc_queue.hpp>
+#include <mutex>
+#include <ring_buffer.hpp>
+#include <thread>
+#include <vector>
+
+/*
+ * Fan-in/fan-out: P producer threads push `items` longs in total through a
+ * bounded queue of `capacity` slots to C consumer threads. Arguments are
+ * {P, C}.
+ */
+static constexpr long items    = 1 << 20;
+static constexpr long capacity = 1024;
+
+// the baseline: a ring buffer behind one mutex and two condition variables
+struct locked_ring {
+	std::mutex mtx;
+	std::condition_variable not_full, not_empty;
+	tp::ring_buffer<long> rb{capacity};
+
+	void push(long v) {
+		std::unique_lock lock(mtx);
+		not_full.wait(lock, [&] { return !rb.full(); });
+		rb.push_back(v);
+		lock.unlock();
+		not_empty.notify_one();
+	}
+
+	void pop(long &v) {
+		std::unique_lock lock(mtx);
+		not_empty.wait(lock, [&] { return !rb.empty(); });
+		v = rb.front();
+		rb.pop_front();
+		lock.unlock();
+		not_full.notify_one();
+	}
+};
+
+struct mpmc {
+	tp::mpmc_queue<long, capacity> q;
+
+	void push(long v) { q.push(v); }
+
+	void pop(long &v) { q.pop(v); }
+};
+
+static void fan_counts(benchmark::internal::Benchmark *b) {
+	b->ArgsProduct({{1, 2, 4}, {1, 2, 4}})
+	    ->ArgNames({"P", "C"})
+	    ->UseRealTime()
+	    ->Unit(benchmark::kMillisecond);
+}
+
+template <typename Queue> static void fan(benchmark::State &state) {
+	long producers = state.range(0), consumers = state.range(1);
+	for (auto _ : state) {
+		Queue q;
+		std::vector<std::thread> threads;
+		for (long p = 0; p < producers; ++p)
+			threads.emplace_back([&] {
+				for (long i = 0; i < items / producers; ++i)
+					q.push(i);
+			});
+		for (long c = 0; c < consumers; ++c)
+			threads.emplace_back([&] {
+				long v, sum = 0;
+				for (long i = 0; i < items / consumers; ++i) {
+					q.pop(v);
+					sum += v;
+				}
+				benchmark::DoNotOptimize(sum);
+			});
+		for (auto &t : threads)
+			t.join();
+	}
+	state.SetItemsProcessed(state.iterations() * items);
+}
+
+static void BM_fan_locked_ring(benchmark::State &state) {
+	fan<locked_ring>(state);
+}
+BENCHMARK(BM_fan_locked_ring)->Apply(fan_counts);
+
+static void BM_fan_mpmc(benchmark::State &state) { fan<mpmc>(state); }
+BENCHMARK(BM_fan_mpmc)->Apply(fan_counts);
+
+// batches of 32 through try_push_n/try_pop_n, yielding when they get none
+static void BM_fan_mpmc_batch(benchmark::State &state) {
+	long producers = state.range(0), consumers = state.range(1);
+	for (auto _ : state) {
+		tp::mpmc_queue<long, capacity> q;
+		std::vector<std::thread> threads;
+		for (long p = 0; p < producers; ++p)
+			threads.emplace_back([&] {
+				long batch[32];
+				for (long i = 0; i < 32; ++i)
+					batch[i] = i;
+				for (long left = items / producers; left;) {
+					long n = q.try_push_n(batch, std::min(left, 32L));
+					if (n == 0)
+						std::this_thread::yield();
+					left -= n;
+				}
+			});
+		for (long c = 0; c < consumers; ++c)
+			threads.emplace_back([&] {
+				long batch[32], sum = 0;
+				for (long left = items / consumers; left;) {
+					long n = q.try_pop_n(batch, std::min(left, 32L));
+					if (n == 0)
+						std::this_thread::yield();
+					for (long k = 0; k < n; ++k)
+						sum += batch[k];
+					left -= n;
+				}
+				benchmark::DoNotOptimize(sum);
+			});
+		for (auto &t : threads)
+			t.join();
+	}
+	state.SetItemsProcessed(state.iterations() * items);
+}
+BENCHMARK(BM_fan_mpmc_batch)->Apply(fan_counts);
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+#include <list.hpp>
+#include <map.hpp>
+#include <memory>
+#include <node_pool_allocator.hpp>
+
+/*
+ * Insert/erase churn on node containers holding a steady working set of
+ * state.range(0) elements: every step frees one node and allocates one.
+ * The list works as a FIFO; the map inserts a new key and erases the
+ * oldest, so nodes are freed in an order unrelated to their addresses.
+ *
+ * The _mt cases run the same churn in several threads, each on its own
+ * container; with the pool all of them share one sharded node_pool.
+ */
+static void sizes(benchmark::internal::Benchmark *b) {
+	b->RangeMultiplier(10)->Range(1000, 100000);
+}
+
+template <typename List> static void list_churn(List &lst, int n,
+                                                benchmark::State &state) {
+	for (int i = 0; i < n; ++i)
+		lst.push_back(i);
+	int next = n;
+	for (auto _ : state) {
+		lst.pop_front();
+		lst.push_back(next++);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Map> static void map_churn(Map &mp, int n,
+                                              benchmark::State &state) {
+	// keys spread out so the tree shape does not follow insertion order
+	auto key = [](unsigned i) { return int(i * 2654435761u); };
+	for (int i = 0; i < n; ++i)
+		mp.insert({key(i), i});
+	unsigned oldest = 0;
+	unsigned next   = n;
+	for (auto _ : state) {
+		mp.erase(mp.find(key(oldest++)));
+		mp.insert({key(next), int(next)});
+		++next;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+using pool_value = tp::pair<const int, int>;
+using pool_map =
+    tp::map<int, int, tp::less<int>, tp::node_pool_allocator<pool_value>>;
+
+static void BM_list_churn_default(benchmark::State &state) {
+	list<int> lst;
+	list_churn(lst, state.range(0), state);
+}
+BENCHMARK(BM_list_churn_default)->Apply(sizes);
+
+static void BM_list_churn_pool(benchmark::State &state) {
+	list<int, tp::node_pool_allocator<int>> lst;
+	list_churn(lst, state.range(0), state);
+}
+BENCHMARK(BM_list_churn_pool)->Apply(sizes);
+
+static void BM_map_churn_default(benchmark::State &state) {
+	tp::map<int, int> mp;
+	map_churn(mp, state.range(0), state);
+}
+BENCHMARK(BM_map_churn_default)->Apply(sizes);
+
+static void BM_map_churn_pool(benchmark::State &state) {
+	pool_map mp;
+	map_churn(mp, state.range(0), state);
+}
+BENCHMARK(BM_map_churn_pool)->Apply(sizes);
+
+static std::shared_ptr<tp::node_pool> shared_pool =
+    std::make_shared<tp::node_pool>(8);
+
+static void BM_list_churn_default_mt(benchmark::State &state) {
+	list<int> lst;
+	list_churn(lst, 10000, state);
+}
+BENCHMARK(BM_list_churn_default_mt)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_list_churn_pool_mt(benchmark::State &state) {
+	list<int, tp::node_pool_allocator<int>> lst{
+	    tp::node_pool_allocator<int>(shared_pool)};
+	list_churn(lst, 10000, state);
+}
+BENCHMARK(BM_list_churn_pool_mt)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_map_churn_default_mt(benchmark::State &state) {
+	tp::map<int, int> mp;
+	map_churn(mp, 10000, state);
+}
+BENCHMARK(BM_map_churn_default_mt)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_map_churn_pool_mt(benchmark::State &state) {
+	pool_map mp{tp::node_pool_allocator<pool_value>(shared_pool)};
+	map_churn(mp, 10000, state);
+}
+BENCHMARK(BM_map_churn_pool_mt)->ThreadRange(1, 4)->UseRealTime();
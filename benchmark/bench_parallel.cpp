@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <deque.hpp>
+#include <parallel.hpp>
+#include <random>
+#include <thread>
+#include <vector.hpp>
+
+static constexpr int sort_size = 1 << 22;
+
+// 1, 2, 4, ... up to hardware_concurrency
+static void thread_counts(benchmark::internal::Benchmark *b) {
+	int hw = std::max(1u, std::thread::hardware_concurrency());
+	for (int t = 1; t < hw; t *= 2)
+		b->Arg(t);
+	b->Arg(hw);
+	b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+template <typename Container> static Container random_data(int n) {
+	std::mt19937 rng(1);
+	Container c;
+	for (int i = 0; i < n; ++i)
+		c.push_back(rng());
+	return c;
+}
+
+static void BM_std_sort(benchmark::State &state) {
+	auto data = random_data<vector<unsigned>>(sort_size);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto vec = data;
+		state.ResumeTiming();
+		std::sort(vec.begin(), vec.end());
+		benchmark::DoNotOptimize(vec.data());
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_std_sort)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+template <typename Container>
+static void BM_parallel_sort(benchmark::State &state) {
+	tp::thread_pool pool(state.range(0));
+	auto data = random_data<Container>(sort_size);
+	for (auto _ : state) {
+		state.PauseTiming();
+		Container c(data);
+		state.ResumeTiming();
+		tp::parallel_sort(c.begin(), c.end(), std::less<>(), pool);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_parallel_sort<vector<unsigned>>)->Apply(thread_counts);
+BENCHMARK(BM_parallel_sort<deque<unsigned>>)->Apply(thread_counts);
+
+template <typename Container>
+static void BM_parallel_transform(benchmark::State &state) {
+	tp::thread_pool pool(state.range(0));
+	auto c = random_data<Container>(sort_size);
+	for (auto _ : state) {
+		tp::parallel_transform(
+		    c.begin(), c.end(), c.begin(),
+		    [](unsigned x) { return unsigned(std::sqrt(float(x))) ^ x; },
+		    pool);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_parallel_transform<vector<unsigned>>)->Apply(thread_counts);
+BENCHMARK(BM_parallel_transform<deque<unsigned>>)->Apply(thread_counts);
+
+// block-wise deque walk against element-wise deque_iterator
+static void BM_deque_for_each(benchmark::State &state) {
+	tp::thread_pool pool(1);
+	auto dq = random_data<deque<unsigned>>(sort_size);
+	for (auto _ : state) {
+		if (state.range(0))
+			tp::parallel_for_each(dq.begin(), dq.end(),
+			                      [](unsigned &x) { x += 1; }, pool);
+		else
+			std::for_each(dq.begin(), dq.end(), [](unsigned &x) { x += 1; });
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_deque_for_each)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// fork-join overhead: one parallel_invoke per call down to the leaves
+static long fib(long n, tp::work_stealing_pool &pool) {
+	if (n < 2)
+		return n;
+	long a, b;
+	tp::parallel_invoke([&] { a = fib(n - 1, pool); },
+	                    [&] { b = fib(n - 2, pool); }, pool);
+	return a + b;
+}
+
+static void BM_ws_fib(benchmark::State &state) {
+	tp::work_stealing_pool pool(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(fib(25, pool));
+}
+BENCHMARK(BM_ws_fib)->Apply(thread_counts);
+
+// nested parallelism: both halves of every partition are forked
+template <typename It>
+static void quicksort(It first, It last, tp::work_stealing_pool &pool) {
+	if (last - first <= 4096) {
+		std::sort(first, last);
+		return;
+	}
+	auto pivot = *(first + (last - first) / 2);
+	It mid1    = std::partition(first, last, [&](auto x) { return x < pivot; });
+	It mid2 = std::partition(mid1, last, [&](auto x) { return !(pivot < x); });
+	tp::parallel_invoke([&] { quicksort(first, mid1, pool); },
+	                    [&] { quicksort(mid2, last, pool); }, pool);
+}
+
+static void BM_ws_quicksort(benchmark::State &state) {
+	tp::work_stealing_pool pool(state.range(0));
+	auto data = random_data<vector<unsigned>>(sort_size);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto vec = data;
+		state.ResumeTiming();
+		quicksort(vec.begin(), vec.end(), pool);
+		benchmark::DoNotOptimize(vec.data());
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_ws_quicksort)->Apply(thread_counts);
+
+static void BM_ws_parallel_for(benchmark::State &state) {
+	tp::work_stealing_pool pool(state.range(0));
+	auto vec = random_data<vector<unsigned>>(sort_size);
+	unsigned *data = vec.data();
+	for (auto _ : state) {
+		tp::parallel_for(0, sort_size, [&](int i) { data[i] = data[i] * 3 + 1; },
+		                 0, pool);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * sort_size);
+}
+BENCHMARK(BM_ws_parallel_for)->Apply(thread_counts);
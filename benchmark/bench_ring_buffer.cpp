@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+#include <deque.hpp>
+#include <deque>
+#include <ring_buffer.hpp>
+
+// Telemetry-style bounded queue: keep state.range(0) samples, push one and
+// drop the oldest per step, and read one sample by index.
+struct sample {
+	long time;
+	double value;
+};
+
+template <typename Queue>
+static void telemetry(benchmark::State &state, Queue &q) {
+	const int depth = state.range(0);
+	for (int i = 0; i < depth; ++i)
+		q.push_back(sample{i, 0.5 * i});
+	long t   = depth;
+	double s = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < 1024; ++i, ++t) {
+			q.pop_front();
+			q.push_back(sample{t, 0.5 * t});
+			s += q[t & 511].value;
+		}
+	}
+	benchmark::DoNotOptimize(s);
+	state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+static void BM_telemetry_std_deque(benchmark::State &state) {
+	std::deque<sample> q;
+	telemetry(state, q);
+}
+BENCHMARK(BM_telemetry_std_deque)->Arg(1000)->Arg(100000);
+
+static void BM_telemetry_tp_deque(benchmark::State &state) {
+	deque<sample> q;
+	telemetry(state, q);
+}
+BENCHMARK(BM_telemetry_tp_deque)->Arg(1000)->Arg(100000);
+
+static void BM_telemetry_ring_buffer(benchmark::State &state) {
+	tp::ring_buffer<sample> q(state.range(0));
+	telemetry(state, q);
+}
+BENCHMARK(BM_telemetry_ring_buffer)->Arg(1000)->Arg(100000);
+
+// overwrite mode: the push itself drops the oldest sample
+static void BM_telemetry_ring_overwrite(benchmark::State &state) {
+	using ring = tp::ring_buffer<sample>;
+	ring q(state.range(0), ring::overflow::overwrite);
+	const int depth = q.capacity();
+	long t          = 0;
+	for (; t < depth; ++t)
+		q.push_back(sample{t, 0.5 * t});
+	double s = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < 1024; ++i, ++t) {
+			q.push_back(sample{t, 0.5 * t});
+			s += q[t & 511].value;
+		}
+	}
+	benchmark::DoNotOptimize(s);
+	state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_telemetry_ring_overwrite)->Arg(1024)->Arg(131072);
+
+// batches of 64 samples in and out
+static void BM_batch_std_deque(benchmark::State &state) {
+	std::deque<sample> q;
+	sample in[64] = {}, out[64];
+	for (auto _ : state) {
+		q.insert(q.end(), in, in + 64);
+		std::copy(q.begin(), q.begin() + 64, out);
+		q.erase(q.begin(), q.begin() + 64);
+		benchmark::DoNotOptimize(out);
+	}
+	state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_batch_std_deque);
+
+static void BM_batch_ring_buffer(benchmark::State &state) {
+	tp::ring_buffer<sample> q(1000);
+	sample in[64] = {}, out[64];
+	for (auto _ : state) {
+		q.push_back_n(in, 64);
+		q.pop_front_n(out, 64);
+		benchmark::DoNotOptimize(out);
+	}
+	state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_batch_ring_buffer);
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <small_vector.hpp>
+#include <vector.hpp>
+
+static std::size_t allocations = 0;
+
+template <typename T> struct counting_allocator : std::allocator<T> {
+	template <typename U> struct rebind {
+		using other = counting_allocator<U>;
+	};
+
+	counting_allocator() = default;
+	template <typename U> counting_allocator(const counting_allocator<U> &) {}
+
+	T *allocate(std::size_t n) {
+		++allocations;
+		return std::allocator<T>::allocate(n);
+	}
+};
+
+static constexpr std::size_t num_vectors = 1 << 16;
+
+// fill num_vectors short vectors of 1..8 ints, report heap allocations
+template <typename Vec>
+static void BM_short_vectors_build(benchmark::State &state) {
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<int> len(1, 8);
+	std::size_t total = 0;
+	allocations       = 0;
+	for (auto _ : state) {
+		vector<Vec> vecs;
+		vecs.reserve(num_vectors);
+		for (std::size_t i = 0; i < num_vectors; ++i) {
+			vecs.emplace_back();
+			for (int j = len(gen); j > 0; --j)
+				vecs.back().push_back(j);
+		}
+		benchmark::DoNotOptimize(vecs.data());
+		total += num_vectors;
+	}
+	state.counters["allocs_per_vector"] =
+	    benchmark::Counter(double(allocations) / total);
+}
+BENCHMARK(BM_short_vectors_build<vector<int, counting_allocator<int>>>);
+BENCHMARK(
+    BM_short_vectors_build<tp::small_vector<int, 8, counting_allocator<int>>>);
+
+// random element lookups across num_vectors short vectors
+template <typename Vec>
+static void BM_short_vectors_lookup(benchmark::State &state) {
+	std::mt19937 gen(42);
+	vector<Vec> vecs;
+	vecs.reserve(num_vectors);
+	for (std::size_t i = 0; i < num_vectors; ++i) {
+		vecs.emplace_back();
+		for (int j = 0; j < 8; ++j)
+			vecs.back().push_back(j);
+	}
+
+	std::uniform_int_distribution<std::size_t> pick(0, num_vectors - 1);
+	long sum = 0;
+	for (auto _ : state) {
+		const Vec &vec = vecs[pick(gen)];
+		sum += vec[vec.size() - 1];
+	}
+	benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_short_vectors_lookup<vector<int>>);
+BENCHMARK(BM_short_vectors_lookup<tp::small_vector<int, 8>>);
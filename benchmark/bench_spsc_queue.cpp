@@ -0,0 +1,135 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <deque.hpp>
+#include <mutex>
+#include <spsc_queue.hpp>
+#include <thread>
+
+/*
+ * Two-thread pipeline stage: a producer thread pushes `items` longs, the
+ * benchmark thread pops them. Spinning sides yield, so the numbers stay
+ * meaningful on machines with fewer cores than threads.
+ */
+static constexpr long items = 1 << 20;
+
+// the baseline the SPSC queue replaces: tp::deque behind a mutex
+struct locked_deque {
+	std::mutex mtx;
+	deque<long> dq;
+
+	void push(long v) {
+		std::lock_guard lock(mtx);
+		dq.push_back(v);
+	}
+
+	bool try_pop(long &v) {
+		std::lock_guard lock(mtx);
+		if (dq.empty())
+			return false;
+		v = dq.front();
+		dq.pop_front();
+		return true;
+	}
+};
+
+template <typename Queue> static void pipeline(benchmark::State &state) {
+	for (auto _ : state) {
+		Queue q;
+		std::thread producer([&] {
+			for (long i = 0; i < items; ++i)
+				q.push(i);
+		});
+		long v, sum = 0;
+		for (long got = 0; got < items;) {
+			if (q.try_pop(v))
+				sum += v, ++got;
+			else
+				std::this_thread::yield();
+		}
+		producer.join();
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * items);
+}
+
+static void BM_pipeline_locked_deque(benchmark::State &state) {
+	pipeline<locked_deque>(state);
+}
+BENCHMARK(BM_pipeline_locked_deque)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_pipeline_spsc(benchmark::State &state) {
+	pipeline<tp::spsc_queue<long>>(state);
+}
+BENCHMARK(BM_pipeline_spsc)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// batches of 64 through try_push_n/try_pop_n
+static void BM_pipeline_spsc_batch(benchmark::State &state) {
+	for (auto _ : state) {
+		tp::spsc_queue<long> q;
+		std::thread producer([&] {
+			long batch[64];
+			for (long i = 0; i < items; i += 64) {
+				for (int k = 0; k < 64; ++k)
+					batch[k] = i + k;
+				q.try_push_n(batch, 64);
+			}
+		});
+		long buf[64], sum = 0;
+		for (long got = 0; got < items;) {
+			long n = q.try_pop_n(buf, 64);
+			if (n == 0)
+				std::this_thread::yield();
+			for (long k = 0; k < n; ++k)
+				sum += buf[k];
+			got += n;
+		}
+		producer.join();
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * items);
+}
+BENCHMARK(BM_pipeline_spsc_batch)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/*
+ * Latency: ping-pong of one message through a pair of queues. The reported
+ * time per iteration is one round trip, i.e. two hand-offs.
+ */
+template <typename Queue> static void ping_pong(benchmark::State &state) {
+	Queue ping, pong;
+	std::atomic<bool> done{false};
+	std::thread echo([&] {
+		long v;
+		while (!done.load(std::memory_order_relaxed)) {
+			if (ping.try_pop(v))
+				pong.push(v);
+			else
+				std::this_thread::yield();
+		}
+	});
+	long v = 0;
+	for (auto _ : state) {
+		ping.push(v);
+		while (!pong.try_pop(v))
+			std::this_thread::yield();
+		++v;
+	}
+	done = true;
+	echo.join();
+}
+
+static void BM_round_trip_locked_deque(benchmark::State &state) {
+	ping_pong<locked_deque>(state);
+}
+BENCHMARK(BM_round_trip_locked_deque)->UseRealTime();
+
+static void BM_round_trip_spsc(benchmark::State &state) {
+	ping_pong<tp::spsc_queue<long>>(state);
+}
+BENCHMARK(BM_round_trip_spsc)->UseRealTime();
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <stable_vector.hpp>
+#include <vector.hpp>
+
+template <typename Container> static void BM_push_back(benchmark::State &state) {
+	for (auto _ : state) {
+		Container c;
+		for (int i = 0; i < state.range(0); ++i)
+			c.push_back(i);
+		benchmark::DoNotOptimize(&c[0]);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_push_back<vector<int>>)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_push_back<tp::stable_vector<int>>)->Range(1 << 10, 1 << 22);
+
+// the workaround stable_vector replaces: reserve for the worst case
+static void BM_push_back_reserved(benchmark::State &state) {
+	for (auto _ : state) {
+		vector<int> c;
+		c.reserve(1 << 22);
+		for (int i = 0; i < state.range(0); ++i)
+			c.push_back(i);
+		benchmark::DoNotOptimize(&c[0]);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_push_back_reserved)->Range(1 << 10, 1 << 22);
+
+template <typename Container> static void BM_index(benchmark::State &state) {
+	Container c;
+	for (int i = 0; i < state.range(0); ++i)
+		c.push_back(i);
+	for (auto _ : state) {
+		long sum = 0;
+		for (std::size_t i = 0; i < c.size(); ++i)
+			sum += c[i];
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_index<vector<int>>)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_index<tp::stable_vector<int>>)->Range(1 << 10, 1 << 22);
+
+template <typename Container> static void BM_iterate(benchmark::State &state) {
+	Container c;
+	for (int i = 0; i < state.range(0); ++i)
+		c.push_back(i);
+	for (auto _ : state) {
+		long sum = 0;
+		for (int x : c)
+			sum += x;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_iterate<vector<int>>)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_iterate<tp::stable_vector<int>>)->Range(1 << 10, 1 << 22);
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <deque.hpp>
+#include <random>
+#include <tiered_deque.hpp>
+
+/*
+ * Order-book churn: a queue of state.range(0) entries takes an insert and
+ * an erase at random positions per item, so its size stays put. deque
+ * shifts toward the nearer end (insert_aux), tiered_deque within a block.
+ */
+template <typename Deque> static void churn(benchmark::State &state) {
+	long n = state.range(0);
+	Deque dq;
+	for (long i = 0; i < n; ++i)
+		dq.push_back(i);
+	std::mt19937 rng(1);
+	for (auto _ : state) {
+		dq.insert(dq.begin() + rng() % n, 42);
+		dq.erase(dq.begin() + rng() % n);
+	}
+	benchmark::DoNotOptimize(dq.size());
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_churn_deque(benchmark::State &state) {
+	churn<deque<long>>(state);
+}
+BENCHMARK(BM_churn_deque)->Arg(1 << 14)->Arg(1 << 20);
+
+static void BM_churn_tiered_deque(benchmark::State &state) {
+	churn<tp::tiered_deque<long>>(state);
+}
+BENCHMARK(BM_churn_tiered_deque)->Arg(1 << 14)->Arg(1 << 20);
+
+// what the block index costs: operator[] at random positions
+template <typename Deque> static void random_reads(benchmark::State &state) {
+	long n = state.range(0);
+	Deque dq;
+	for (long i = 0; i < n; ++i)
+		dq.push_back(i);
+	std::mt19937 rng(1);
+	long sum = 0;
+	for (auto _ : state)
+		sum += dq[rng() % n];
+	benchmark::DoNotOptimize(sum);
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_random_read_deque(benchmark::State &state) {
+	random_reads<deque<long>>(state);
+}
+BENCHMARK(BM_random_read_deque)->Arg(1 << 20);
+
+static void BM_random_read_tiered_deque(benchmark::State &state) {
+	random_reads<tp::tiered_deque<long>>(state);
+}
+BENCHMARK(BM_random_read_tiered_deque)->Arg(1 << 20);
+
+// sequential walk with ++
+template <typename Deque> static void scan(benchmark::State &state) {
+	long n = state.range(0);
+	Deque dq;
+	for (long i = 0; i < n; ++i)
+		dq.push_back(i);
+	for (auto _ : state) {
+		long sum = 0;
+		for (long x : dq)
+			sum += x;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_scan_deque(benchmark::State &state) { scan<deque<long>>(state); }
+BENCHMARK(BM_scan_deque)->Arg(1 << 20);
+
+static void BM_scan_tiered_deque(benchmark::State &state) {
+	scan<tp::tiered_deque<long>>(state);
+}
+BENCHMARK(BM_scan_tiered_deque)->Arg(1 << 20);
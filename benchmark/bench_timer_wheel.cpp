@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <timer_wheel.hpp>
+#include <vector>
+
+/*
+ * tp::timer_wheel against an indexed binary heap, the usual O(log n)
+ * timer queue, with state.range(0) timers pending at all times.
+ *
+ * Every iteration reschedules 1M random timers to now + [1, 65536) ticks,
+ * then advances the clock by 16 ticks; fired timers are rescheduled from
+ * the callback. items_per_second counts reschedules and expiries. The
+ * timers and the random stream are set up outside the timing.
+ */
+static constexpr std::uint64_t max_delay = 1 << 16;
+static constexpr int per_iter            = 1 << 20;
+static constexpr int ticks_per_iter      = 16;
+
+static void sizes(benchmark::internal::Benchmark *b) {
+	b->Arg(1000000)->Arg(10000000)->Iterations(20)->Unit(
+	    benchmark::kMillisecond);
+}
+
+struct resched {
+	unsigned id;
+	unsigned delay;
+};
+
+static std::vector<resched> random_steps(unsigned n) {
+	std::mt19937 rng(7);
+	std::vector<resched> steps(per_iter);
+	for (resched &r : steps)
+		r = {unsigned(rng() % n), unsigned(1 + rng() % (max_delay - 1))};
+	return steps;
+}
+
+struct bench_timer {
+	tp::timer_hook timer;
+};
+
+static void BM_timers_wheel(benchmark::State &state) {
+	unsigned n = state.range(0);
+	using wheel_type = tp::timer_wheel<bench_timer, &bench_timer::timer>;
+	std::vector<bench_timer> timers(n);
+	auto wheel = std::make_unique<wheel_type>();
+	std::vector<resched> steps = random_steps(n);
+	std::mt19937 rng(1);
+	for (bench_timer &t : timers)
+		wheel->schedule(t, 1 + rng() % max_delay);
+
+	std::size_t fired = 0;
+	unsigned k        = 0;
+	auto on_expire    = [&](bench_timer &t) {
+		wheel->schedule(t, wheel->now() + steps[k++ % per_iter].delay);
+	};
+	for (auto _ : state) {
+		std::uint64_t now = wheel->now();
+		for (const resched &r : steps)
+			wheel->schedule(timers[r.id], now + r.delay);
+		fired += wheel->advance(now + ticks_per_iter, on_expire);
+	}
+	state.SetItemsProcessed(state.iterations() * per_iter + fired);
+	state.counters["fired"] = double(fired) / state.iterations();
+}
+BENCHMARK(BM_timers_wheel)->Apply(sizes);
+
+// min-heap of timer ids by expiry, with each timer's position for O(log n)
+// rescheduling
+class timer_heap {
+public:
+	explicit timer_heap(unsigned n) : expires(n), pos(n) {
+		heap.reserve(n);
+	}
+
+	std::uint64_t now() const { return cur; }
+
+	void schedule(unsigned id, std::uint64_t at) {
+		if (at <= cur)
+			at = cur + 1;
+		std::uint64_t old = expires[id];
+		expires[id]       = at;
+		if (old == 0) {
+			heap.push_back(id);
+			up(heap.size() - 1);
+		} else if (at < old) {
+			up(pos[id]);
+		} else {
+			down(pos[id]);
+		}
+	}
+
+	template <typename F> std::size_t advance(std::uint64_t to, F &&on_expire) {
+		std::size_t fired = 0;
+		while (!heap.empty() && expires[heap[0]] <= to) {
+			unsigned id = heap[0];
+			cur         = expires[id];
+			expires[id] = 0;
+			heap[0]     = heap.back();
+			heap.pop_back();
+			if (!heap.empty())
+				down(0);
+			++fired;
+			on_expire(id);
+		}
+		cur = to;
+		return fired;
+	}
+
+private:
+	void set(std::size_t i, unsigned id) {
+		heap[i] = id;
+		pos[id] = i;
+	}
+
+	void up(std::size_t i) {
+		unsigned id = heap[i];
+		while (i > 0) {
+			std::size_t parent = (i - 1) / 2;
+			if (expires[heap[parent]] <= expires[id])
+				break;
+			set(i, heap[parent]);
+			i = parent;
+		}
+		set(i, id);
+	}
+
+	void down(std::size_t i) {
+		unsigned id = heap[i];
+		std::size_t n = heap.size();
+		for (;;) {
+			std::size_t child = 2 * i + 1;
+			if (child >= n)
+				break;
+			if (child + 1 < n &&
+			    expires[heap[child + 1]] < expires[heap[child]])
+				++child;
+			if (expires[id] <= expires[heap[child]])
+				break;
+			set(i, heap[child]);
+			i = child;
+		}
+		set(i, id);
+	}
+
+	std::vector<unsigned> heap;
+	std::vector<std::uint64_t> expires; // 0: not pending
+	std::vector<unsigned> pos;
+	std::uint64_t cur = 0;
+};
+
+static void BM_timers_heap(benchmark::State &state) {
+	unsigned n = state.range(0);
+	timer_heap timers(n);
+	std::vector<resched> steps = random_steps(n);
+	std::mt19937 rng(1);
+	for (unsigned id = 0; id < n; ++id)
+		timers.schedule(id, 1 + rng() % max_delay);
+
+	std::size_t fired = 0;
+	unsigned k        = 0;
+	auto on_expire    = [&](unsigned id) {
+		timers.schedule(id, timers.now() + steps[k++ % per_iter].delay);
+	};
+	for (auto _ : state) {
+		std::uint64_t now = timers.now();
+		for (const resched &r : steps)
+			timers.schedule(r.id, now + r.delay);
+		fired += timers.advance(now + ticks_per_iter, on_expire);
+	}
+	state.SetItemsProcessed(state.iterations() * per_iter + fired);
+	state.counters["fired"] = double(fired) / state.iterations();
+}
+BENCHMARK(BM_timers_heap)->Apply(sizes);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <list.hpp>
+#include <unrolled_list.hpp>
+
+/*
+ * tp::list against tp::unrolled_list (default 256-byte nodes, 58 ints).
+ *
+ * scan: sum n ints, bytes_per_second is the element bandwidth.
+ * push_back: build a list of n ints from empty.
+ * insert_walk: walk a list of n ints and insert a new element before
+ * every one of them, doubling it; for the unrolled list this splits every
+ * node on the way. Building and freeing the list is not timed.
+ *
+ * tp::list nodes come from malloc in order here, which is the best case
+ * for its scans: in a long-lived list they are scattered.
+ */
+static void sizes(benchmark::internal::Benchmark *b) {
+	b->RangeMultiplier(10)->Range(1000, 1000000);
+}
+
+template <typename List> static void scan(benchmark::State &state) {
+	int n = state.range(0);
+	List lt;
+	for (int i = 0; i < n; ++i)
+		lt.push_back(i);
+	for (auto _ : state) {
+		long sum = 0;
+		for (int x : lt)
+			sum += x;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * n * sizeof(int));
+}
+
+template <typename List> static void push_back(benchmark::State &state) {
+	int n = state.range(0);
+	for (auto _ : state) {
+		List lt;
+		for (int i = 0; i < n; ++i)
+			lt.push_back(i);
+		benchmark::DoNotOptimize(lt);
+		state.PauseTiming();
+		lt.clear();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename List> static void insert_walk(benchmark::State &state) {
+	int n = state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		List lt;
+		for (int i = 0; i < n; ++i)
+			lt.push_back(i);
+		state.ResumeTiming();
+		for (auto it = lt.begin(); it != lt.end(); ++it) {
+			it = lt.insert(it, -1);
+			++it;
+		}
+		benchmark::DoNotOptimize(lt);
+		state.PauseTiming();
+		lt.clear();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_scan_list(benchmark::State &state) { scan<list<int>>(state); }
+BENCHMARK(BM_scan_list)->Apply(sizes);
+
+static void BM_scan_unrolled_list(benchmark::State &state) {
+	scan<tp::unrolled_list<int>>(state);
+}
+BENCHMARK(BM_scan_unrolled_list)->Apply(sizes);
+
+static void BM_push_back_list(benchmark::State &state) {
+	push_back<list<int>>(state);
+}
+BENCHMARK(BM_push_back_list)->Apply(sizes);
+
+static void BM_push_back_unrolled_list(benchmark::State &state) {
+	push_back<tp::unrolled_list<int>>(state);
+}
+BENCHMARK(BM_push_back_unrolled_list)->Apply(sizes);
+
+static void BM_insert_walk_list(benchmark::State &state) {
+	insert_walk<list<int>>(state);
+}
+BENCHMARK(BM_insert_walk_list)->Apply(sizes);
+
+static void BM_insert_walk_unrolled_list(benchmark::State &state) {
+	insert_walk<tp::unrolled_list<int>>(state);
+}
+BENCHMARK(BM_insert_walk_unrolled_list)->Apply(sizes);
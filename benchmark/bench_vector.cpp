@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <hugepage_allocator.hpp>
+#include <mmap_allocator.hpp>
+#include <vector.hpp>
+#include <vector>
+
+struct record {
+	long key;
+	double value[3];
+};
+
+// push_back growth curve: every reallocate relocates the whole buffer
+template <typename Vec> static void BM_push_back(benchmark::State &state) {
+	const std::size_t n = state.range(0);
+	for (auto _ : state) {
+		Vec vec;
+		for (std::size_t i = 0; i < n; ++i)
+			vec.push_back(record{long(i), {}});
+		benchmark::DoNotOptimize(vec.data());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetBytesProcessed(state.iterations() * n * sizeof(record));
+}
+BENCHMARK(BM_push_back<vector<record>>)
+    ->RangeMultiplier(8)->Range(1 << 6, 1 << 24);
+BENCHMARK(BM_push_back<std::vector<record>>)
+    ->RangeMultiplier(8)->Range(1 << 6, 1 << 24);
+
+// repeated insert(end(), first, last) batches, amortized by the growth policy
+template <typename Vec>
+static void BM_insert_batches(benchmark::State &state) {
+	const std::size_t batches = state.range(0);
+	record batch[16]{};
+	for (auto _ : state) {
+		Vec vec;
+		for (std::size_t i = 0; i < batches; ++i)
+			vec.insert(vec.end(), batch, batch + 16);
+		benchmark::DoNotOptimize(vec.data());
+	}
+	state.SetItemsProcessed(state.iterations() * batches * 16);
+}
+BENCHMARK(BM_insert_batches<vector<record, std::allocator<record>,
+                                   tp::exact_growth>>)
+    ->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK(BM_insert_batches<vector<record, std::allocator<record>,
+                                   tp::doubling_growth>>)
+    ->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK(BM_insert_batches<vector<record, std::allocator<record>,
+                                   tp::golden_growth>>)
+    ->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK(BM_insert_batches<vector<record, std::allocator<record>,
+                                   tp::jemalloc_growth>>)
+    ->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK(BM_insert_batches<std::vector<record>>)
+    ->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+
+// a producer filling freshly grown capacity: zero-fill + overwrite vs
+// writing straight into uninitialized storage
+static void BM_fill_resize(benchmark::State &state) {
+	const std::size_t n = state.range(0);
+	for (auto _ : state) {
+		vector<char> buf;
+		buf.resize(n);
+		std::memset(buf.data(), 'x', n);
+		benchmark::DoNotOptimize(buf.data());
+	}
+	state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_fill_resize)->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+
+static void BM_fill_resize_for_overwrite(benchmark::State &state) {
+	const std::size_t n = state.range(0);
+	for (auto _ : state) {
+		vector<char> buf;
+		buf.resize_for_overwrite(n);
+		std::memset(buf.data(), 'x', n);
+		benchmark::DoNotOptimize(buf.data());
+	}
+	state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_fill_resize_for_overwrite)
+    ->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+
+static void BM_fill_append_uninitialized(benchmark::State &state) {
+	const std::size_t n = state.range(0);
+	for (auto _ : state) {
+		vector<char> buf;
+		buf.append_uninitialized(n, [](char *first, std::size_t count) {
+			std::memset(first, 'x', count);
+		});
+		benchmark::DoNotOptimize(buf.data());
+	}
+	state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_fill_append_uninitialized)
+    ->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+
+// growth of a large vector: copy into a new buffer vs mremap
+template <typename Alloc>
+static void BM_large_growth(benchmark::State &state) {
+	const std::size_t n = state.range(0);
+	for (auto _ : state) {
+		vector<long, Alloc> vec;
+		for (std::size_t i = 0; i < n; ++i)
+			vec.push_back(i);
+		benchmark::DoNotOptimize(vec.data());
+	}
+	state.SetBytesProcessed(state.iterations() * n * sizeof(long));
+}
+BENCHMARK(BM_large_growth<std::allocator<long>>)
+    ->RangeMultiplier(8)->Range(1 << 18, 1 << 27)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_large_growth<tp::mmap_allocator<long>>)
+    ->RangeMultiplier(8)->Range(1 << 18, 1 << 27)->Unit(benchmark::kMillisecond);
+
+// random reads over a 1 GB vector, TLB bound without huge pages
+template <typename Alloc>
+static void BM_random_access_1g(benchmark::State &state) {
+	const std::size_t n = (std::size_t(1) << 30) / sizeof(long);
+	vector<long, Alloc> vec;
+	vec.append_uninitialized(n, [](long *first, std::size_t count) {
+		for (std::size_t i = 0; i < count; ++i)
+			first[i] = i;
+	});
+
+	std::uint64_t x = 88172645463325252ull;
+	long sum        = 0;
+	for (auto _ : state) {
+		// xorshift keeps index generation cheap next to the cache miss
+		x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+		sum += vec[x & (n - 1)];
+	}
+	benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_random_access_1g<std::allocator<long>>);
+BENCHMARK(BM_random_access_1g<tp::hugepage_allocator<long>>);
@@ -0,0 +1,591 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TP_ALGO_X86 1
+#define TP_TARGET_SSE2 __attribute__((target("sse2")))
+#define TP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#include <iterator.hpp>
+
+/*
+ * Search kernels for contiguous ranges of arithmetic types.
+ *
+ * find, count, min_element, max_element and equal accept any iterator. When
+ * the iterators are raw pointers or tp::normal_iterator<T *, ...> (vector,
+ * small_vector, array) over an integer, float or double element they run an
+ * SSE2 or AVX2 kernel picked at runtime from CPUID, otherwise they fall back
+ * to the std algorithm.
+ *
+ * min_element/max_element assume the range holds no NaN.
+ */
+namespace tp::algo {
+
+enum class isa { scalar, sse2, avx2 };
+
+namespace detail {
+
+inline isa detect_isa() {
+#ifdef TP_ALGO_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return isa::avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return isa::sse2;
+#endif
+	return isa::scalar;
+}
+
+inline isa &active_isa() {
+	static isa level = detect_isa();
+	return level;
+}
+
+} // namespace detail
+
+// the instruction set the kernels currently dispatch to
+inline isa current_isa() { return detail::active_isa(); }
+
+// restrict dispatch to `level` or below (for testing / benchmarking);
+// never raises it above what the CPU supports
+inline void set_isa(isa level) {
+	detail::active_isa() = std::min(level, detail::detect_isa());
+}
+
+namespace detail {
+
+// pointer access for the contiguous iterators of tp containers
+template <typename It> struct contiguous {
+	static constexpr bool value = false;
+};
+
+template <typename T> struct contiguous<T *> {
+	static constexpr bool value = true;
+	using element_type          = std::remove_cv_t<T>;
+
+	static T *to_pointer(T *it) { return it; }
+};
+
+template <typename T, typename Container>
+struct contiguous<tp::normal_iterator<T *, Container>> {
+	static constexpr bool value = true;
+	using element_type          = std::remove_cv_t<T>;
+	using iterator              = tp::normal_iterator<T *, Container>;
+
+	static T *to_pointer(const iterator &it) { return it.base(); }
+};
+
+template <typename T>
+inline constexpr bool simd_element =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template <typename It>
+concept simd_iterator = contiguous<It>::value &&
+                        simd_element<typename contiguous<It>::element_type>;
+
+template <typename T>
+using bits_type = std::conditional_t<
+    sizeof(T) == 1, std::int8_t,
+    std::conditional_t<sizeof(T) == 2, std::int16_t,
+                       std::conditional_t<sizeof(T) == 4, std::int32_t,
+                                          std::int64_t>>>;
+
+/* ---------------------------- scalar kernels ---------------------------- */
+
+template <typename T>
+const T *find_scalar(const T *first, const T *last, T value) {
+	for (; first != last; ++first)
+		if (*first == value)
+			return first;
+	return last;
+}
+
+template <typename T>
+std::size_t count_scalar(const T *first, const T *last, T value) {
+	std::size_t ret = 0;
+	for (; first != last; ++first)
+		ret += *first == value;
+	return ret;
+}
+
+template <typename T>
+bool equal_scalar(const T *first1, const T *last1, const T *first2) {
+	for (; first1 != last1; ++first1, ++first2)
+		if (!(*first1 == *first2))
+			return false;
+	return true;
+}
+
+// minimum (Max = false) or maximum (Max = true) of a non-empty range
+template <bool Max, typename T>
+T extreme_scalar(const T *first, const T *last, T acc) {
+	for (; first != last; ++first)
+		if (Max ? acc < *first : *first < acc)
+			acc = *first;
+	return acc;
+}
+
+#ifdef TP_ALGO_X86
+
+/* ----------------------------- SSE2 kernels ----------------------------- */
+
+template <typename T> TP_TARGET_SSE2 inline __m128i splat128(T value) {
+	auto bits = std::bit_cast<bits_type<T>>(value);
+	if constexpr (sizeof(T) == 1)
+		return _mm_set1_epi8(bits);
+	else if constexpr (sizeof(T) == 2)
+		return _mm_set1_epi16(bits);
+	else if constexpr (sizeof(T) == 4)
+		return _mm_set1_epi32(bits);
+	else
+		return _mm_set1_epi64x(bits);
+}
+
+// all-ones lanes where a == b
+template <typename T>
+TP_TARGET_SSE2 inline __m128i eq128(__m128i a, __m128i b) {
+	if constexpr (std::is_same_v<T, float>) {
+		return _mm_castps_si128(
+		    _mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+	} else if constexpr (std::is_same_v<T, double>) {
+		return _mm_castpd_si128(
+		    _mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+	} else if constexpr (sizeof(T) == 1) {
+		return _mm_cmpeq_epi8(a, b);
+	} else if constexpr (sizeof(T) == 2) {
+		return _mm_cmpeq_epi16(a, b);
+	} else if constexpr (sizeof(T) == 4) {
+		return _mm_cmpeq_epi32(a, b);
+	} else {
+		// no cmpeq_epi64 before SSE4.1: both 32-bit halves must match
+		__m128i eq = _mm_cmpeq_epi32(a, b);
+		__m128i swapped = _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_and_si128(eq, swapped);
+	}
+}
+
+template <typename T>
+TP_TARGET_SSE2 const T *find_sse2(const T *first, const T *last, T value) {
+	constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+	const __m128i needle           = splat128(value);
+
+	for (; last - first >= lanes; first += lanes) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		unsigned mask = _mm_movemask_epi8(eq128<T>(v, needle));
+		if (mask)
+			return first + std::countr_zero(mask) / sizeof(T);
+	}
+	return find_scalar(first, last, value);
+}
+
+template <typename T>
+TP_TARGET_SSE2 std::size_t count_sse2(const T *first, const T *last,
+                                      T value) {
+	constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+	const __m128i needle           = splat128(value);
+	std::size_t matched_bytes      = 0;
+
+	for (; last - first >= lanes; first += lanes) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		unsigned mask = _mm_movemask_epi8(eq128<T>(v, needle));
+		matched_bytes += std::popcount(mask);
+	}
+	return matched_bytes / sizeof(T) + count_scalar(first, last, value);
+}
+
+template <typename T>
+TP_TARGET_SSE2 bool equal_sse2(const T *first1, const T *last1,
+                               const T *first2) {
+	constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+
+	for (; last1 - first1 >= lanes; first1 += lanes, first2 += lanes) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first1));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first2));
+		if (_mm_movemask_epi8(eq128<T>(a, b)) != 0xffff)
+			return false;
+	}
+	return equal_scalar(first1, last1, first2);
+}
+
+// lane-wise min / max; integer lanes go through a (biased) signed compare
+template <bool Max, typename T>
+TP_TARGET_SSE2 inline __m128i pick128(__m128i a, __m128i b) {
+	if constexpr (std::is_same_v<T, float>) {
+		__m128 x = _mm_castsi128_ps(a), y = _mm_castsi128_ps(b);
+		return _mm_castps_si128(Max ? _mm_max_ps(x, y) : _mm_min_ps(x, y));
+	} else if constexpr (std::is_same_v<T, double>) {
+		__m128d x = _mm_castsi128_pd(a), y = _mm_castsi128_pd(b);
+		return _mm_castpd_si128(Max ? _mm_max_pd(x, y) : _mm_min_pd(x, y));
+	} else {
+		__m128i x = a, y = b;
+		if constexpr (std::is_unsigned_v<T>) {
+			const __m128i bias = splat128(T(T(1) << (sizeof(T) * 8 - 1)));
+			x = _mm_xor_si128(x, bias);
+			y = _mm_xor_si128(y, bias);
+		}
+		__m128i gt;
+		if constexpr (sizeof(T) == 1)
+			gt = _mm_cmpgt_epi8(x, y);
+		else if constexpr (sizeof(T) == 2)
+			gt = _mm_cmpgt_epi16(x, y);
+		else
+			gt = _mm_cmpgt_epi32(x, y);
+		// Max: take a where a > b; Min: take b where a > b
+		return Max ? _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b))
+		           : _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+	}
+}
+
+template <bool Max, typename T>
+TP_TARGET_SSE2 T extreme_sse2(const T *first, const T *last) {
+	// no 64-bit integer compare in SSE2
+	if constexpr (std::is_integral_v<T> && sizeof(T) == 8) {
+		return extreme_scalar<Max>(first + 1, last, *first);
+	} else {
+		constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+		if (last - first < lanes)
+			return extreme_scalar<Max>(first + 1, last, *first);
+
+		__m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		for (first += lanes; last - first >= lanes; first += lanes) {
+			__m128i v =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+			acc = pick128<Max, T>(acc, v);
+		}
+
+		alignas(16) T buf[lanes];
+		_mm_store_si128(reinterpret_cast<__m128i *>(buf), acc);
+		T ret = extreme_scalar<Max>(buf + 1, buf + lanes, buf[0]);
+		return extreme_scalar<Max>(first, last, ret);
+	}
+}
+
+/* ----------------------------- AVX2 kernels ----------------------------- */
+
+template <typename T> TP_TARGET_AVX2 inline __m256i splat256(T value) {
+	auto bits = std::bit_cast<bits_type<T>>(value);
+	if constexpr (sizeof(T) == 1)
+		return _mm256_set1_epi8(bits);
+	else if constexpr (sizeof(T) == 2)
+		return _mm256_set1_epi16(bits);
+	else if constexpr (sizeof(T) == 4)
+		return _mm256_set1_epi32(bits);
+	else
+		return _mm256_set1_epi64x(bits);
+}
+
+template <typename T>
+TP_TARGET_AVX2 inline __m256i eq256(__m256i a, __m256i b) {
+	if constexpr (std::is_same_v<T, float>) {
+		return _mm256_castps_si256(_mm256_cmp_ps(
+		    _mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+	} else if constexpr (std::is_same_v<T, double>) {
+		return _mm256_castpd_si256(_mm256_cmp_pd(
+		    _mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+	} else if constexpr (sizeof(T) == 1) {
+		return _mm256_cmpeq_epi8(a, b);
+	} else if constexpr (sizeof(T) == 2) {
+		return _mm256_cmpeq_epi16(a, b);
+	} else if constexpr (sizeof(T) == 4) {
+		return _mm256_cmpeq_epi32(a, b);
+	} else {
+		return _mm256_cmpeq_epi64(a, b);
+	}
+}
+
+template <typename T>
+TP_TARGET_AVX2 const T *find_avx2(const T *first, const T *last, T value) {
+	constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+	const __m256i needle           = splat256(value);
+
+	// two registers per iteration to keep both load ports busy
+	for (; last - first >= 2 * lanes; first += 2 * lanes) {
+		__m256i v0 =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		__m256i v1 =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + lanes));
+		__m256i e0 = eq256<T>(v0, needle), e1 = eq256<T>(v1, needle);
+		if (!_mm256_testz_si256(_mm256_or_si256(e0, e1),
+		                        _mm256_or_si256(e0, e1))) {
+			unsigned mask = _mm256_movemask_epi8(e0);
+			if (mask)
+				return first + std::countr_zero(mask) / sizeof(T);
+			mask = _mm256_movemask_epi8(e1);
+			return first + lanes + std::countr_zero(mask) / sizeof(T);
+		}
+	}
+	for (; last - first >= lanes; first += lanes) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		unsigned mask = _mm256_movemask_epi8(eq256<T>(v, needle));
+		if (mask)
+			return first + std::countr_zero(mask) / sizeof(T);
+	}
+	return find_scalar(first, last, value);
+}
+
+template <typename T>
+TP_TARGET_AVX2 std::size_t count_avx2(const T *first, const T *last,
+                                      T value) {
+	constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+	const __m256i needle           = splat256(value);
+	std::size_t matched_bytes      = 0;
+
+	for (; last - first >= lanes; first += lanes) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		unsigned mask = _mm256_movemask_epi8(eq256<T>(v, needle));
+		matched_bytes += std::popcount(mask);
+	}
+	return matched_bytes / sizeof(T) + count_scalar(first, last, value);
+}
+
+template <typename T>
+TP_TARGET_AVX2 bool equal_avx2(const T *first1, const T *last1,
+                               const T *first2) {
+	constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+
+	for (; last1 - first1 >= lanes; first1 += lanes, first2 += lanes) {
+		__m256i a =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first1));
+		__m256i b =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first2));
+		if (unsigned(_mm256_movemask_epi8(eq256<T>(a, b))) != 0xffffffffu)
+			return false;
+	}
+	return equal_scalar(first1, last1, first2);
+}
+
+template <bool Max, typename T>
+TP_TARGET_AVX2 inline __m256i pick256(__m256i a, __m256i b) {
+	if constexpr (std::is_same_v<T, float>) {
+		__m256 x = _mm256_castsi256_ps(a), y = _mm256_castsi256_ps(b);
+		return _mm256_castps_si256(Max ? _mm256_max_ps(x, y)
+		                               : _mm256_min_ps(x, y));
+	} else if constexpr (std::is_same_v<T, double>) {
+		__m256d x = _mm256_castsi256_pd(a), y = _mm256_castsi256_pd(b);
+		return _mm256_castpd_si256(Max ? _mm256_max_pd(x, y)
+		                               : _mm256_min_pd(x, y));
+	} else if constexpr (sizeof(T) == 1) {
+		if constexpr (std::is_signed_v<T>)
+			return Max ? _mm256_max_epi8(a, b) : _mm256_min_epi8(a, b);
+		else
+			return Max ? _mm256_max_epu8(a, b) : _mm256_min_epu8(a, b);
+	} else if constexpr (sizeof(T) == 2) {
+		if constexpr (std::is_signed_v<T>)
+			return Max ? _mm256_max_epi16(a, b) : _mm256_min_epi16(a, b);
+		else
+			return Max ? _mm256_max_epu16(a, b) : _mm256_min_epu16(a, b);
+	} else if constexpr (sizeof(T) == 4) {
+		if constexpr (std::is_signed_v<T>)
+			return Max ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+		else
+			return Max ? _mm256_max_epu32(a, b) : _mm256_min_epu32(a, b);
+	} else {
+		__m256i x = a, y = b;
+		if constexpr (std::is_unsigned_v<T>) {
+			const __m256i bias = splat256(T(T(1) << 63));
+			x = _mm256_xor_si256(x, bias);
+			y = _mm256_xor_si256(y, bias);
+		}
+		__m256i gt = _mm256_cmpgt_epi64(x, y);
+		return Max ? _mm256_blendv_epi8(b, a, gt) : _mm256_blendv_epi8(a, b, gt);
+	}
+}
+
+template <bool Max, typename T>
+TP_TARGET_AVX2 T extreme_avx2(const T *first, const T *last) {
+	constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+
+	if (last - first < lanes)
+		return extreme_scalar<Max>(first + 1, last, *first);
+
+	__m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+	for (first += lanes; last - first >= lanes; first += lanes) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		acc       = pick256<Max, T>(acc, v);
+	}
+
+	alignas(32) T buf[lanes];
+	_mm256_store_si256(reinterpret_cast<__m256i *>(buf), acc);
+	T ret = extreme_scalar<Max>(buf + 1, buf + lanes, buf[0]);
+	return extreme_scalar<Max>(first, last, ret);
+}
+
+#endif // TP_ALGO_X86
+
+/* ------------------------------ dispatch ------------------------------ */
+
+template <typename T>
+const T *find_dispatch(const T *first, const T *last, T value) {
+	switch (current_isa()) {
+#ifdef TP_ALGO_X86
+	case isa::avx2:
+		return find_avx2(first, last, value);
+	case isa::sse2:
+		return find_sse2(first, last, value);
+#endif
+	default:
+		return find_scalar(first, last, value);
+	}
+}
+
+template <typename T>
+std::size_t count_dispatch(const T *first, const T *last, T value) {
+	switch (current_isa()) {
+#ifdef TP_ALGO_X86
+	case isa::avx2:
+		return count_avx2(first, last, value);
+	case isa::sse2:
+		return count_sse2(first, last, value);
+#endif
+	default:
+		return count_scalar(first, last, value);
+	}
+}
+
+template <typename T>
+bool equal_dispatch(const T *first1, const T *last1, const T *first2) {
+	switch (current_isa()) {
+#ifdef TP_ALGO_X86
+	case isa::avx2:
+		return equal_avx2(first1, last1, first2);
+	case isa::sse2:
+		return equal_sse2(first1, last1, first2);
+#endif
+	default:
+		return equal_scalar(first1, last1, first2);
+	}
+}
+
+template <bool Max, typename T>
+T extreme_dispatch(const T *first, const T *last) {
+	switch (current_isa()) {
+#ifdef TP_ALGO_X86
+	case isa::avx2:
+		return extreme_avx2<Max>(first, last);
+	case isa::sse2:
+		return extreme_sse2<Max>(first, last);
+#endif
+	default:
+		return extreme_scalar<Max>(first + 1, last, *first);
+	}
+}
+
+/*
+ * Convert a search value to the element type. Returns false when no element
+ * can compare equal to it (out of range, fractional, NaN), mirroring what
+ * `*it == value` would give.
+ */
+template <typename T, typename U> bool to_needle(const U &value, T &needle) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+	needle = static_cast<T>(value);
+	return needle == value;
+#pragma GCC diagnostic pop
+}
+
+// integer elements searched with a floating value go through std::find
+template <typename It, typename U>
+concept simd_search = simd_iterator<It> && std::is_arithmetic_v<U> &&
+                      !std::is_same_v<U, bool> &&
+                      (std::is_floating_point_v<
+                           typename contiguous<It>::element_type> ||
+                       std::is_integral_v<U>);
+
+template <typename It1, typename It2>
+concept simd_compare =
+    simd_iterator<It1> && simd_iterator<It2> &&
+    std::is_same_v<typename contiguous<It1>::element_type,
+                   typename contiguous<It2>::element_type>;
+
+} // namespace detail
+
+template <typename It, typename U>
+It find(It first, It last, const U &value) {
+	if constexpr (detail::simd_search<It, U>) {
+		using access = detail::contiguous<It>;
+		typename access::element_type needle;
+		if (!detail::to_needle(value, needle))
+			return last;
+		auto *p = access::to_pointer(first);
+		auto *q = access::to_pointer(last);
+		return first + (detail::find_dispatch<typename access::element_type>(
+		                    p, q, needle) -
+		                p);
+	} else {
+		return std::find(first, last, value);
+	}
+}
+
+template <typename It, typename U>
+std::ptrdiff_t count(It first, It last, const U &value) {
+	if constexpr (detail::simd_search<It, U>) {
+		using access = detail::contiguous<It>;
+		typename access::element_type needle;
+		if (!detail::to_needle(value, needle))
+			return 0;
+		return detail::count_dispatch<typename access::element_type>(
+		    access::to_pointer(first), access::to_pointer(last), needle);
+	} else {
+		return std::count(first, last, value);
+	}
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2) {
+	if constexpr (detail::simd_compare<It1, It2>) {
+		using element = typename detail::contiguous<It1>::element_type;
+		return detail::equal_dispatch<element>(
+		    detail::contiguous<It1>::to_pointer(first1),
+		    detail::contiguous<It1>::to_pointer(last1),
+		    detail::contiguous<It2>::to_pointer(first2));
+	} else {
+		return std::equal(first1, last1, first2);
+	}
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2, It2 last2) {
+	if (std::distance(first1, last1) != std::distance(first2, last2))
+		return false;
+	return algo::equal(first1, last1, first2);
+}
+
+// first smallest element, last if the range is empty
+template <typename It> It min_element(It first, It last) {
+	if constexpr (detail::simd_iterator<It>) {
+		if (first == last)
+			return last;
+		using access = detail::contiguous<It>;
+		using element = typename access::element_type;
+		element value = detail::extreme_dispatch<false, element>(
+		    access::to_pointer(first), access::to_pointer(last));
+		return algo::find(first, last, value);
+	} else {
+		return std::min_element(first, last);
+	}
+}
+
+// first largest element, last if the range is empty
+template <typename It> It max_element(It first, It last) {
+	if constexpr (detail::simd_iterator<It>) {
+		if (first == last)
+			return last;
+		using access = detail::contiguous<It>;
+		using element = typename access::element_type;
+		element value = detail::extreme_dispatch<true, element>(
+		    access::to_pointer(first), access::to_pointer(last));
+		return algo::find(first, last, value);
+	} else {
+		return std::max_element(first, last);
+	}
+}
+
+} // namespace tp::algo
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace tp {
+
+/*
+ * Chase-Lev work-stealing deque (Chase & Lev 2005, with the C11 memory
+ * orders of Le et al. 2013).
+ *
+ * The owner thread pushes and pops at the bottom, LIFO; any other thread
+ * steals from the top, FIFO. Only the last element is contended: push never
+ * synchronizes with thieves beyond a release store, pop needs one seq_cst
+ * fence, and owner and thief race on a CAS of top only when one element is
+ * left.
+ *
+ * The array grows by doubling when full. Thieves may still be reading the
+ * old array, so old arrays are kept until the deque is destroyed (their
+ * total size is less than the current one).
+ *
+ * T has to be trivially copyable and lock-free as std::atomic<T>; in
+ * practice it is a task pointer.
+ */
+template <typename T> class chase_lev_deque {
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	struct array {
+		explicit array(std::int64_t cap)
+		    : mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+		std::int64_t capacity() const { return mask + 1; }
+
+		T get(std::int64_t i) const {
+			return slots[i & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(std::int64_t i, T x) {
+			slots[i & mask].store(x, std::memory_order_relaxed);
+		}
+
+		std::int64_t mask;
+		std::unique_ptr<std::atomic<T>[]> slots;
+	};
+
+public:
+	// capacity is rounded up to a power of two
+	explicit chase_lev_deque(std::size_t capacity = 256) {
+		std::int64_t cap = 1;
+		while (cap < std::int64_t(capacity))
+			cap *= 2;
+		arrays.push_back(std::make_unique<array>(cap));
+		arr.store(arrays.back().get(), std::memory_order_relaxed);
+	}
+
+	chase_lev_deque(const chase_lev_deque &)            = delete;
+	chase_lev_deque &operator=(const chase_lev_deque &) = delete;
+
+	/* owner only */
+
+	void push(T x) {
+		std::int64_t b = bottom.load(std::memory_order_relaxed);
+		std::int64_t t = top.load(std::memory_order_acquire);
+		array *a       = arr.load(std::memory_order_relaxed);
+		if (b - t > a->capacity() - 1)
+			a = grow(a, t, b);
+		a->put(b, x);
+		// the paper's release fence plus relaxed store; a release store
+		// orders the same and is visible to ThreadSanitizer
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	// take the newest element; false if the deque is empty
+	bool pop(T &out) {
+		std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		array *a       = arr.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		out = a->get(b);
+		if (t == b) {
+			// the last one: whoever moves top first gets it
+			bool won = top.compare_exchange_strong(
+			    t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	/* any thread */
+
+	// take the oldest element; false if empty or another thief won the race
+	bool steal(T &out) {
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+		array *a = arr.load(std::memory_order_acquire);
+		T x      = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+		                                 std::memory_order_relaxed))
+			return false;
+		out = x;
+		return true;
+	}
+
+	// a snapshot; exact only when no other thread is touching the deque
+	std::size_t size() const {
+		std::int64_t b = bottom.load(std::memory_order_relaxed);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+		return b > t ? std::size_t(b - t) : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	std::size_t capacity() const {
+		return arr.load(std::memory_order_relaxed)->capacity();
+	}
+
+private:
+	array *grow(array *old, std::int64_t t, std::int64_t b) {
+		auto bigger = std::make_unique<array>(old->capacity() * 2);
+		for (std::int64_t i = t; i < b; ++i)
+			bigger->put(i, old->get(i));
+		arrays.push_back(std::move(bigger));
+		array *a = arrays.back().get();
+		arr.store(a, std::memory_order_release);
+		return a;
+	}
+
+	alignas(64) std::atomic<std::int64_t> top{0};
+	alignas(64) std::atomic<std::int64_t> bottom{0};
+	std::atomic<array *> arr;
+	std::vector<std::unique_ptr<array>> arrays; // owner only
+};
+
+} // namespace tp
@@ -1,14 +1,23 @@
 #pragma once
 
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iterator.hpp>
 #include <memory>
+#include <ranges>
+#include <segmented.hpp>
 
 static constexpr size_t DEQUE_BUF_SIZE = 512;
 
-inline size_t deque_buf_size(size_t size) {
-	return size < DEQUE_BUF_SIZE ? size_t(DEQUE_BUF_SIZE / size) : size_t(1);
+// emptied blocks a deque keeps for reuse unless told otherwise
+static constexpr size_t DEQUE_SPARE_BLOCKS = 2;
+
+// elements per block for blocks of block_bytes; at least one
+constexpr size_t deque_buf_size(size_t size,
+                                size_t block_bytes = DEQUE_BUF_SIZE) {
+	return size < block_bytes ? size_t(block_bytes / size) : size_t(1);
 }
 
 /**
@@ -21,13 +30,19 @@ inline size_t deque_buf_size(size_t size) {
  *  operator overloading in this class.
  *
  *  All the functions are op overloads except for _M_set_node.
+ *
+ *  BlockBytes is the block size of the owning deque; the elements per
+ *  block are a compile-time constant, so the index math below folds into
+ *  shifts and masks for power-of-two sizes.
  */
-template <typename T, typename Ref, typename Ptr> class deque_iterator {
+template <typename T, typename Ref, typename Ptr,
+          size_t BlockBytes = DEQUE_BUF_SIZE>
+class deque_iterator {
 private:
 	template <typename _Ptr, typename _T>
 	using ptr_rebind = typename std::pointer_traits<_Ptr>::template rebind<_T>;
 	template <typename CvTp>
-	using iter = deque_iterator<T, CvTp &, ptr_rebind<Ptr, CvTp>>;
+	using iter = deque_iterator<T, CvTp &, ptr_rebind<Ptr, CvTp>, BlockBytes>;
 	/* template <typename CvTp>
 	 * using iter = deque_iterator<T, Ref, ptr_rebind<Ptr, T>>; */
 
@@ -37,7 +52,9 @@ public:
 	using elem_pointer   = ptr_rebind<Ptr, T>;
 	using map_pointer    = ptr_rebind<Ptr, elem_pointer>;
 
-	static size_t buffer_size() { return deque_buf_size(sizeof(T)); }
+	static constexpr size_t buffer_size() {
+		return deque_buf_size(sizeof(T), BlockBytes);
+	}
 
 	using iterator_category = std::random_access_iterator_tag;
 	using value_type        = T;
@@ -137,8 +154,9 @@ public:
 	}
 
 	template <typename RefR, typename PtrR>
-	friend bool operator==(const deque_iterator &lhs,
-	                       const deque_iterator<T, RefR, PtrR> &rhs) {
+	friend bool
+	operator==(const deque_iterator &lhs,
+	           const deque_iterator<T, RefR, PtrR, BlockBytes> &rhs) {
 		return lhs.cur == rhs.cur;
 	}
 
@@ -157,8 +175,9 @@ public:
 	}
 
 	template <typename RefR, typename PtrR>
-	friend bool operator-(const deque_iterator &lhs,
-	                      const deque_iterator<T, RefR, PtrR> &rhs) {
+	friend bool
+	operator-(const deque_iterator &lhs,
+	          const deque_iterator<T, RefR, PtrR, BlockBytes> &rhs) {
 		return buffer_size() * (lhs.node - rhs.node) + (lhs.cur - lhs.first) -
 		       (rhs.cur - rhs.first);
 	}
@@ -193,7 +212,8 @@ public:
  *  (Deque handles that itself.)  Only/All memory management is performed
  *  here.
  */
-template <typename T, typename Alloc> class deque_base {
+template <typename T, typename Alloc, size_t BlockBytes = DEQUE_BUF_SIZE>
+class deque_base {
 protected:
 	using T_alloc_type = std::allocator_traits<Alloc>::template rebind_alloc<T>;
 	using T_alloc_traits =
@@ -213,8 +233,17 @@ protected:
 		return allocator_type(get_T_allocator());
 	}
 
-	using iterator       = deque_iterator<T, T &, Ptr>::iterator;
-	using const_iterator = deque_iterator<T, const T &, CPtr>::iterator;
+	using iterator = deque_iterator<T, T &, Ptr, BlockBytes>::iterator;
+	using const_iterator =
+	    deque_iterator<T, const T &, CPtr, BlockBytes>::iterator;
+
+	static constexpr size_t buffer_size() { return iterator::buffer_size(); }
+
+	// spares are linked through their first bytes, so a block has to hold
+	// a pointer
+	static constexpr bool keeps_spares =
+	    std::is_trivially_copyable_v<Ptr> &&
+	    buffer_size() * sizeof(T) >= sizeof(Ptr);
 
 	deque_base() : impl() { init_map(0); }
 
@@ -256,8 +285,15 @@ protected:
 		size_t map_size;
 		iterator start;
 		iterator finish;
+		// emptied blocks kept for reuse, linked through their first bytes;
+		// the limit travels with them on swap and move
+		Ptr spare;
+		size_t spare_cnt;
+		size_t spare_limit;
 
-		deque_impl_data() : map(), map_size(0), start(), finish() {}
+		deque_impl_data()
+		    : map(), map_size(0), start(), finish(), spare(), spare_cnt(0),
+		      spare_limit(DEQUE_SPARE_BLOCKS) {}
 
 		deque_impl_data(const deque_impl_data &)            = default;
 		deque_impl_data &operator=(const deque_impl_data &) = default;
@@ -290,14 +326,45 @@ protected:
 		return map_alloc_type(get_T_allocator());
 	}
 
+	// take a spare block if there is one
 	Ptr allocate_node() {
+		if (impl.spare_cnt) {
+			Ptr p = impl.spare;
+			std::memcpy(&impl.spare, std::to_address(p), sizeof(Ptr));
+			--impl.spare_cnt;
+			return p;
+		}
 		// using traits_type = std::allocator_traits<T_alloc_type>;
-		return T_alloc_traits::allocate(impl, deque_buf_size(sizeof(T)));
+		return T_alloc_traits::allocate(impl, buffer_size());
 	}
 
+	// keep the block as a spare while there is room, free it otherwise
 	void deallocate_node(Ptr p) {
+		if constexpr (keeps_spares) {
+			if (impl.spare_cnt < impl.spare_limit) {
+				std::memcpy(static_cast<void *>(std::to_address(p)),
+				            &impl.spare, sizeof(Ptr));
+				impl.spare = p;
+				++impl.spare_cnt;
+				return;
+			}
+		}
+		free_node(p);
+	}
+
+	void free_node(Ptr p) {
 		// using traits_type = std::allocator_traits<T_alloc_type>;
-		T_alloc_traits::deallocate(impl, p, deque_buf_size(sizeof(T)));
+		T_alloc_traits::deallocate(impl, p, buffer_size());
+	}
+
+	// free spare blocks until at most `keep` are left
+	void release_spare_nodes(size_t keep = 0) {
+		while (impl.spare_cnt > keep) {
+			Ptr p = impl.spare;
+			std::memcpy(&impl.spare, std::to_address(p), sizeof(Ptr));
+			--impl.spare_cnt;
+			free_node(p);
+		}
 	}
 
 	map_pointer allocate_map(size_t n) {
@@ -318,9 +385,9 @@ protected:
 };
 
 // num_elems: T's count to allocate
-template <typename T, typename Alloc>
-void deque_base<T, Alloc>::init_map(size_t num_elems) {
-	const size_t num_nodes = num_elems / deque_buf_size(sizeof(T)) + 1;
+template <typename T, typename Alloc, size_t BlockBytes>
+void deque_base<T, Alloc, BlockBytes>::init_map(size_t num_elems) {
+	const size_t num_nodes = num_elems / buffer_size() + 1;
 	impl.map_size          = num_nodes + 2;
 	impl.map               = allocate_map(impl.map_size);
 
@@ -334,26 +401,32 @@ void deque_base<T, Alloc>::init_map(size_t num_elems) {
 	impl.start.set_node(_start);
 	impl.finish.set_node(_finish - 1);
 	impl.start.cur = impl.start.first;
-	impl.finish.cur =
-	    impl.finish.first + (num_elems % deque_buf_size(sizeof(T)));
+	impl.finish.cur = impl.finish.first + (num_elems % buffer_size());
 }
 
-template <typename T, typename Alloc>
-void deque_base<T, Alloc>::create_nodes(map_pointer start, map_pointer finish) {
+template <typename T, typename Alloc, size_t BlockBytes>
+void deque_base<T, Alloc, BlockBytes>::create_nodes(map_pointer start,
+                                                    map_pointer finish) {
 	for (map_pointer cur = start; cur < finish; ++cur)
 		*cur = allocate_node();
 }
 
-template <typename T, typename Alloc>
-void deque_base<T, Alloc>::destroy_nodes(map_pointer start,
-                                         map_pointer finish) {
+template <typename T, typename Alloc, size_t BlockBytes>
+void deque_base<T, Alloc, BlockBytes>::destroy_nodes(map_pointer start,
+                                                     map_pointer finish) {
 	for (map_pointer cur = start; cur < finish; ++cur)
 		deallocate_node(*cur);
 }
 
-template <typename T, typename Alloc = std::allocator<T>>
-class deque : protected deque_base<T, Alloc> {
-	using base           = deque_base<T, Alloc>;
+/*
+ * BlockBytes is the size of one block in bytes (DEQUE_BUF_SIZE by default);
+ * a block always holds at least one element. Larger blocks suit large
+ * elements and long queues, cache-line sized ones small hot queues.
+ */
+template <typename T, typename Alloc = std::allocator<T>,
+          size_t BlockBytes = DEQUE_BUF_SIZE>
+class deque : protected deque_base<T, Alloc, BlockBytes> {
+	using base           = deque_base<T, Alloc, BlockBytes>;
 	using T_alloc_type   = base::T_alloc_type;
 	using T_alloc_traits = base::T_alloc_traits;
 	using map_pointer    = base::map_pointer;
@@ -373,15 +446,17 @@ public:
 	using allocator_type         = Alloc;
 
 private:
-	static size_type buffer_size() { return deque_buf_size(sizeof(T)); }
 	using base::allocate_map;
 	using base::allocate_node;
+	using base::buffer_size;
 	using base::create_nodes;
 	using base::deallocate_map;
 	using base::deallocate_node;
 	using base::destroy_nodes;
+	using base::free_node;
 	using base::get_T_allocator;
 	using base::init_map;
+	using base::release_spare_nodes;
 
 	using base::impl;
 
@@ -402,12 +477,7 @@ public:
 	requires tp::is_iterator<InputIt> deque(InputIt first, InputIt last,
 	                                        const Alloc &alloc = Alloc())
 	    : base(alloc, last - first) {
-		InputIt src  = first;
-		iterator dst = begin();
-		while (src != last) {
-			T_alloc_traits::construct(impl, dst.operator->(), *src);
-			++src, ++dst;
-		}
+		initialize_copy(first, last, begin());
 	}
 
 	// copy ctor
@@ -415,21 +485,11 @@ public:
 	    : base(
 	          T_alloc_traits::select_on_container_copy_construction(other.impl),
 	          other.size()) {
-		iterator src = other.begin();
-		iterator dst = begin();
-		while (src != other.end()) {
-			T_alloc_traits::construct(impl, dst.operator->(), *src);
-			++src, ++dst;
-		}
+		initialize_copy(other.begin(), other.end(), begin());
 	}
 
 	deque(const deque &other, const Alloc &alloc) : base(alloc, other.size()) {
-		iterator src = other.begin();
-		iterator dst = begin();
-		while (src != other.end()) {
-			T_alloc_traits::construct(impl, dst.cur, *src);
-			++src, ++dst;
-		}
+		initialize_copy(other.begin(), other.end(), begin());
 	}
 
 	deque(deque &&other) : base(std::move(other)) {}
@@ -438,12 +498,7 @@ public:
 
 	deque(std::initializer_list<T> init, const Alloc &alloc = Alloc())
 	    : base(alloc, init.size()) {
-		auto src     = init.begin();
-		iterator dst = begin();
-		while (src != init.end()) {
-			T_alloc_traits::construct(impl, dst.operator->(), *src);
-			++src, ++dst;
-		}
+		initialize_copy(init.begin(), init.end(), begin());
 	}
 
 	deque &operator=(const deque &other) {
@@ -451,7 +506,8 @@ public:
 		if (std::addressof(other) != this) {
 			if (pocca::value) {
 				clear();
-				deallocate_node(impl.start.first);
+				free_node(impl.start.first);
+				release_spare_nodes();
 
 				get_T_allocator() = other.get_T_allocator();
 
@@ -464,10 +520,10 @@ public:
 			get_T_allocator() = other.get_T_allocator();
 			size_type len     = size();
 			if (len > other.size()) {
-				erase_at_end(std::copy(other.begin(), other.end(), begin()));
+				erase_at_end(tp::copy(other.begin(), other.end(), begin()));
 			} else {
 				auto mid = other.begin() + len;
-				std::copy(other.begin(), mid, begin());
+				tp::copy(other.begin(), mid, begin());
 				insert_aux(end(), mid, other.end());
 			}
 		}
@@ -481,10 +537,10 @@ public:
 				size_type len = size();
 				if (len > other.size()) {
 					erase_at_end(
-					    std::move(other.begin(), other.end(), begin()));
+					    tp::move(other.begin(), other.end(), begin()));
 				} else {
 					auto mid = other.begin() + len;
-					std::move(other.begin(), mid, begin());
+					tp::move(other.begin(), mid, begin());
 
 					reserve_elems_at_back(other.size() - len);
 					initialize_move(mid, other.end(), end());
@@ -501,10 +557,10 @@ public:
 	deque &operator=(std::initializer_list<T> ilist) {
 		size_type len = size();
 		if (len > ilist.size()) {
-			erase_at_end(std::copy(ilist.begin(), ilist.end(), begin()));
+			erase_at_end(tp::copy(ilist.begin(), ilist.end(), begin()));
 		} else {
 			auto mid = ilist.begin() + len;
-			std::copy(ilist.begin(), mid, begin());
+			tp::copy(ilist.begin(), mid, begin());
 			insert_aux(end(), mid, ilist.end());
 		}
 		return *this;
@@ -528,10 +584,10 @@ public:
 		size_type len   = size();
 		size_type count = last - first;
 		if (len > count) {
-			erase_at_end(std::copy(first, last, begin()));
+			erase_at_end(tp::copy(first, last, begin()));
 		} else {
 			auto mid = first + len;
-			std::copy(first, mid, begin());
+			tp::copy(first, mid, begin());
 			insert_aux(end(), mid, last);
 		}
 	}
@@ -539,10 +595,10 @@ public:
 	void assign(std::initializer_list<T> ilist) {
 		size_type len = size();
 		if (len > ilist.size()) {
-			erase_at_end(std::copy(ilist.begin(), ilist.end(), begin()));
+			erase_at_end(tp::copy(ilist.begin(), ilist.end(), begin()));
 		} else {
 			auto mid = ilist.begin() + len;
-			std::copy(ilist.begin(), mid, begin());
+			tp::copy(ilist.begin(), mid, begin());
 			insert_aux(end(), mid, ilist.end());
 		}
 	}
@@ -551,7 +607,8 @@ public:
 
 	~deque() {
 		clear();
-		deallocate_node(impl.start.first);
+		free_node(impl.start.first);
+		release_spare_nodes();
 		deallocate_map(impl.map, impl.map_size);
 	}
 
@@ -607,10 +664,39 @@ public:
 
 	size_type size() const { return end() - begin(); }
 
+	// free the spare blocks and cut the map down to the blocks in use
 	void shrink_to_fit() {
-		// do nothing
+		release_spare_nodes();
+		size_type num_nodes    = impl.finish.node - impl.start.node + 1;
+		size_type new_map_size = num_nodes + 2;
+		if (new_map_size >= impl.map_size)
+			return;
+
+		map_pointer new_map = allocate_map(new_map_size);
+		std::copy(impl.start.node, impl.finish.node + 1, new_map + 1);
+		deallocate_map(impl.map, impl.map_size);
+		impl.map      = new_map;
+		impl.map_size = new_map_size;
+		move_nodes(new_map + 1);
 	}
 
+	/*
+	 * Blocks emptied by pop_front/pop_back/erase are kept, up to this many,
+	 * and handed out again when either end needs a new block, so a queue
+	 * hovering around a block boundary stops calling the allocator.
+	 */
+	size_type spare_block_limit() const { return impl.spare_limit; }
+
+	void set_spare_block_limit(size_type n) {
+		impl.spare_limit = n;
+		release_spare_nodes(n);
+	}
+
+	size_type spare_blocks() const { return impl.spare_cnt; }
+
+	// give every spare block back to the allocator
+	void trim_spare_blocks() { release_spare_nodes(); }
+
 	void clear() { erase_at_end(begin()); }
 
 	iterator insert(const_iterator pos, const T &value) {
@@ -817,6 +903,70 @@ public:
 		return *(impl.start.cur);
 	}
 
+	/*
+	 * Append the elements of rg. Sized ranges reserve every block they need
+	 * up front and are then written a block at a time; a contiguous range
+	 * of trivially copyable T is copied with one memcpy per block. Other
+	 * input ranges (e.g. a std::istream_iterator view) are appended one by
+	 * one.
+	 */
+	template <std::ranges::input_range Range>
+	requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	void append_range(Range &&rg) {
+		if constexpr (std::ranges::sized_range<Range>) {
+			size_type count = std::ranges::size(rg);
+			if (count == 0)
+				return;
+			reserve_elems_at_back(count);
+			map_pointer last_node = (impl.finish + count).node;
+			auto src              = std::ranges::begin(rg);
+			try {
+				tp::for_each_segment(impl.finish, impl.finish + count,
+				                     [&](T *b, T *e) {
+					                     src = construct_block(b, e, src);
+					                     impl.finish += e - b;
+				                     });
+			} catch (...) {
+				destroy_nodes(impl.finish.node + 1, last_node + 1);
+				throw;
+			}
+		} else {
+			for (auto &&elem : rg)
+				emplace_back(std::forward<decltype(elem)>(elem));
+		}
+	}
+
+	// insert the elements of rg at the front, in order; see append_range
+	template <std::ranges::input_range Range>
+	requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	void prepend_range(Range &&rg) {
+		if constexpr (std::ranges::sized_range<Range>) {
+			size_type count = std::ranges::size(rg);
+			if (count == 0)
+				return;
+			reserve_elems_at_front(count);
+			iterator new_start = impl.start - count;
+			iterator done      = new_start;
+			auto src           = std::ranges::begin(rg);
+			try {
+				tp::for_each_segment(new_start, impl.start, [&](T *b, T *e) {
+					src = construct_block(b, e, src);
+					done += e - b;
+				});
+			} catch (...) {
+				destroy_elems(new_start, done);
+				destroy_nodes(new_start.node, impl.start.node);
+				throw;
+			}
+			impl.start = new_start;
+		} else {
+			size_type count = 0;
+			for (auto &&elem : rg)
+				emplace_front(std::forward<decltype(elem)>(elem)), ++count;
+			std::reverse(begin(), begin() + count);
+		}
+	}
+
 	void resize(size_type count) {
 		size_type length = size();
 		if (count == length)
@@ -852,48 +1002,70 @@ public:
 
 private:
 	void fill(const T &value) {
-		for (iterator it = impl.start; it != impl.finish; ++it)
-			T_alloc_traits::construct(impl, it.operator->(), value);
+		tp::for_each_segment(impl.start, impl.finish, [&](T *b, T *e) {
+			for (; b != e; ++b)
+				T_alloc_traits::construct(impl, b, value);
+		});
 	}
 
 	void fill(const_iterator first, const_iterator last, const T &value) {
-		auto it = first;
-		while (it != last) {
-			*it = value;
-			++it;
-		}
+		tp::fill(first, last, value);
 	}
 
 	void destroy_elem(iterator pos) {
 		T_alloc_traits::destroy(impl, pos.cur);
 	}
 
+	// block by block, so the loop drops out for trivially destructible T
 	void destroy_elems(iterator first, iterator last) {
-		for (auto it = first; it != last; ++it)
-			destroy_elem(it);
+		tp::for_each_segment(first, last, [&](T *b, T *e) {
+			for (; b != e; ++b)
+				T_alloc_traits::destroy(impl, b);
+		});
 	}
 
+	/*
+	 * Make room for cnt more nodes at one end. While the map is more than
+	 * half empty the nodes are recentered in place, so a queue drifting
+	 * towards one end does not keep doubling the map.
+	 */
 	void reallocate_map(size_type cnt, bool add_at_front) {
 		size_type old_num_nodes = impl.finish.node - impl.start.node + 1;
 		size_type new_num_nodes = old_num_nodes + cnt;
 
-		size_type new_map_size =
-		    impl.map_size + std::max(impl.map_size, cnt) + 2;
-		map_pointer new_map   = allocate_map(new_map_size);
-		map_pointer new_start = new_map + (new_map_size - new_num_nodes) / 2 +
-		                        (add_at_front ? cnt : 0);
+		map_pointer new_start;
+		if (impl.map_size > 2 * new_num_nodes) {
+			new_start = impl.map + (impl.map_size - new_num_nodes) / 2 +
+			            (add_at_front ? cnt : 0);
+			if (new_start < impl.start.node)
+				std::copy(impl.start.node, impl.finish.node + 1, new_start);
+			else
+				std::copy_backward(impl.start.node, impl.finish.node + 1,
+				                   new_start + old_num_nodes);
+		} else {
+			size_type new_map_size =
+			    impl.map_size + std::max(impl.map_size, cnt) + 2;
+			map_pointer new_map = allocate_map(new_map_size);
+			new_start = new_map + (new_map_size - new_num_nodes) / 2 +
+			            (add_at_front ? cnt : 0);
 
-		std::copy(impl.start.node, impl.finish.node + 1, new_start);
+			std::copy(impl.start.node, impl.finish.node + 1, new_start);
 
-		deallocate_map(impl.map, impl.map_size);
+			deallocate_map(impl.map, impl.map_size);
 
-		impl.map      = new_map;
-		impl.map_size = new_map_size;
+			impl.map      = new_map;
+			impl.map_size = new_map_size;
+		}
+		move_nodes(new_start);
+	}
 
+	// point start and finish at the node pointers copied to new_start
+	void move_nodes(map_pointer new_start) {
+		size_type num_nodes     = impl.finish.node - impl.start.node + 1;
 		size_type start_offset  = impl.start.cur - impl.start.first;
 		size_type finish_offset = impl.finish.cur - impl.finish.first;
 		impl.start.set_node(new_start);
-		impl.finish.set_node(new_start + old_num_nodes - 1);
+		impl.finish.set_node(new_start + num_nodes - 1);
 		impl.start.cur  = impl.start.first + start_offset;
 		impl.finish.cur = impl.finish.first + finish_offset;
 	}
@@ -1086,11 +1258,7 @@ private:
 	}
 
 	void transform(iterator src_first, iterator src_last, iterator dest_first) {
-		auto it = src_first;
-		while (it != src_last) {
-			*dest_first = std::move(*it);
-			++it, ++dest_first;
-		}
+		tp::move(src_first, src_last, dest_first);
 	}
 
 	void transform_backward(iterator src_first, iterator src_last,
@@ -1107,11 +1275,32 @@ private:
 	template <typename InputIt, typename... Args>
 	requires tp::is_iterator<InputIt>
 	void initialize(InputIt first, InputIt last, Args &&...args) {
-		auto it = first;
-		while (it != last) {
-			T_alloc_traits::construct(impl, it.cur,
-			                          std::forward<Args>(args)...);
-			++it;
+		tp::for_each_segment(first, last, [&](T *b, T *e) {
+			for (; b != e; ++b)
+				T_alloc_traits::construct(impl, b, args...);
+		});
+	}
+
+	// construct the block piece [first, last) from src on; returns the
+	// source position after it
+	template <typename It> It construct_block(T *first, T *last, It src) {
+		if constexpr (std::contiguous_iterator<It> &&
+		              std::is_same_v<std::iter_value_t<It>, T> &&
+		              std::is_trivially_copyable_v<T>) {
+			std::memcpy(static_cast<void *>(first), std::to_address(src),
+			            (last - first) * sizeof(T));
+			return src + (last - first);
+		} else {
+			T *cur = first;
+			try {
+				for (; cur != last; ++cur, ++src)
+					T_alloc_traits::construct(impl, cur, *src);
+			} catch (...) {
+				while (cur != first)
+					T_alloc_traits::destroy(impl, --cur);
+				throw;
+			}
+			return src;
 		}
 	}
 
@@ -1119,11 +1308,16 @@ private:
 	requires tp::is_iterator<InputItL> && tp::is_iterator<InputItR>
 	void initialize_copy(InputItL src_first, InputItL src_last,
 	                     InputItR dest_first) {
-		auto it = src_first;
-		while (it != src_last) {
-			T_alloc_traits::construct(impl, dest_first.cur, *it);
-			++it, ++dest_first;
-		}
+		// walk both sides a block at a time: contiguous pieces of a
+		// trivially copyable T are memcpy'd into the raw storage
+		tp::for_each_segment(src_first, src_last, [&](auto b, auto e) {
+			InputItR next = dest_first + (e - b);
+			tp::for_each_segment(dest_first, next, [&](auto db, auto de) {
+				b = construct_block(std::to_address(db), std::to_address(de),
+				                    b);
+			});
+			dest_first = next;
+		});
 	}
 
 	template <typename InputItL, typename InputItR>
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+
+namespace tp {
+
+/*
+ * Growth policies decide the capacity a container reallocates to once it
+ * runs out of room. Each policy provides
+ *
+ *     static std::size_t next_capacity(std::size_t cap, std::size_t required,
+ *                                      std::size_t elem_size);
+ *
+ * which returns a capacity >= required. `cap` is the current capacity and
+ * `elem_size` is sizeof(value_type), for policies that round in bytes.
+ */
+
+// allocate exactly what is required, repeated growth is quadratic
+struct exact_growth {
+	static std::size_t next_capacity(std::size_t, std::size_t required,
+	                                 std::size_t) {
+		return required;
+	}
+};
+
+// factor 2, the classic amortized O(1) growth
+struct doubling_growth {
+	static std::size_t next_capacity(std::size_t cap, std::size_t required,
+	                                 std::size_t) {
+		std::size_t new_cap = cap ? 2 * cap : 1;
+		return new_cap < required ? required : new_cap;
+	}
+};
+
+// factor 1.5, lets the allocator reuse previously freed blocks
+struct golden_growth {
+	static std::size_t next_capacity(std::size_t cap, std::size_t required,
+	                                 std::size_t) {
+		std::size_t new_cap = cap + cap / 2;
+		if (new_cap <= cap)
+			new_cap = cap + 1;
+		return new_cap < required ? required : new_cap;
+	}
+};
+
+/*
+ * Grow by 1.5x, then round the byte size up to the next jemalloc size class
+ * so the slack the allocator hands out anyway becomes usable capacity.
+ * Size classes are spaced four per doubling: 16, 20, 24, 28, 32, 40, 48, ...
+ * (scaled to bytes: ..., 64, 80, 96, 112, 128, 160, ...).
+ */
+struct jemalloc_growth {
+	static std::size_t size_class(std::size_t bytes) {
+		if (bytes <= 16)
+			return 16;
+		// spacing is a quarter of the power of two below bytes
+		int lg = std::bit_width(bytes - 1) - 1;
+		std::size_t delta = std::size_t(1) << (lg - 2);
+		return (bytes + delta - 1) & ~(delta - 1);
+	}
+
+	static std::size_t next_capacity(std::size_t cap, std::size_t required,
+	                                 std::size_t elem_size) {
+		std::size_t new_cap = golden_growth::next_capacity(cap, required, 0);
+		return size_class(new_cap * elem_size) / elem_size;
+	}
+};
+
+} // namespace tp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace tp {
+
+/*
+ * Allocator that backs large requests with 2 MB huge pages to cut TLB misses
+ * on big vectors, deque maps/blocks and list node pools.
+ *
+ * Requests of at least huge_page_size bytes are rounded up to a multiple of
+ * 2 MB and mapped 2 MB-aligned. Explicit hugetlbfs pages (MAP_HUGETLB) are
+ * tried first; without a reserved pool the mapping is made with normal pages
+ * and marked MADV_HUGEPAGE so transparent huge pages can back it. If THP is
+ * disabled it simply stays on normal pages. Smaller requests go to
+ * std::allocator.
+ *
+ * Stateless, so it rebinds freely inside deque_base and list_base.
+ */
+template <typename T> struct hugepage_allocator {
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using is_always_equal = std::true_type;
+
+	static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+	hugepage_allocator() = default;
+
+	template <typename U> hugepage_allocator(const hugepage_allocator<U> &) {}
+
+	T *allocate(size_type n) {
+		if (!is_huge(n))
+			return std::allocator<T>().allocate(n);
+
+		std::size_t len = map_length(n);
+		void *p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+		                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p == MAP_FAILED)
+			p = map_aligned(len);
+		return static_cast<T *>(p);
+	}
+
+	void deallocate(T *p, size_type n) {
+		if (!p)
+			return;
+		if (is_huge(n))
+			::munmap(p, map_length(n));
+		else
+			std::allocator<T>().deallocate(p, n);
+	}
+
+	static bool is_huge(size_type n) {
+		return n * sizeof(T) >= huge_page_size;
+	}
+
+	friend bool operator==(const hugepage_allocator &,
+	                       const hugepage_allocator &) {
+		return true;
+	}
+
+private:
+	static std::size_t map_length(size_type n) {
+		return (n * sizeof(T) + huge_page_size - 1) & ~(huge_page_size - 1);
+	}
+
+	// map len bytes at a 2 MB boundary and ask for transparent huge pages
+	static void *map_aligned(std::size_t len) {
+		std::size_t over = len + huge_page_size;
+		void *raw = ::mmap(nullptr, over, PROT_READ | PROT_WRITE,
+		                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED)
+			throw std::bad_alloc();
+
+		// trim the unaligned head and the tail
+		auto addr    = reinterpret_cast<std::uintptr_t>(raw);
+		auto aligned = (addr + huge_page_size - 1) & ~(huge_page_size - 1);
+		std::size_t head = aligned - addr;
+		if (head)
+			::munmap(raw, head);
+		if (over - head > len)
+			::munmap(reinterpret_cast<void *>(aligned + len),
+			         over - head - len);
+
+		void *p = reinterpret_cast<void *>(aligned);
+		::madvise(p, len, MADV_HUGEPAGE);
+		return p;
+	}
+};
+
+} // namespace tp
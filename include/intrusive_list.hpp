@@ -0,0 +1,400 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <iterator.hpp>
+#include <list.hpp>
+
+namespace tp {
+
+/*
+ * A list_node_base that knows whether it is linked and unlinks itself when
+ * its object dies. Copies start out unlinked: copying an object does not
+ * put the copy into any list.
+ */
+struct auto_unlink_hook : list_node_base {
+	auto_unlink_hook() { _next = _prev = this; }
+
+	auto_unlink_hook(const auto_unlink_hook &) : auto_unlink_hook() {}
+
+	auto_unlink_hook &operator=(const auto_unlink_hook &) { return *this; }
+
+	~auto_unlink_hook() { unlink(); }
+
+	bool is_linked() const { return _next != this; }
+
+	// take the object out of whatever list holds it; no-op if unlinked
+	void unlink() {
+		unhook();
+		_next = _prev = this;
+	}
+};
+
+namespace detail {
+
+template <typename> struct hook_traits;
+
+template <typename T, typename H> struct hook_traits<H T::*> {
+	using value_type = T;
+	using hook_type  = H;
+};
+
+// offsetof for a pointer to member; T is never constructed
+template <auto Hook> std::ptrdiff_t hook_offset() {
+	using T = typename hook_traits<decltype(Hook)>::value_type;
+	union probe {
+		probe() {}
+		~probe() {}
+		T obj;
+	} p;
+	return reinterpret_cast<char *>(&(p.obj.*Hook)) -
+	       reinterpret_cast<char *>(&p.obj);
+}
+
+} // namespace detail
+
+template <auto Hook, bool Const> class intrusive_list_iterator {
+	using traits    = detail::hook_traits<decltype(Hook)>;
+	using hook_type = typename traits::hook_type;
+
+public:
+	using value_type        = typename traits::value_type;
+	using difference_type   = std::ptrdiff_t;
+	using pointer =
+	    std::conditional_t<Const, const value_type *, value_type *>;
+	using reference =
+	    std::conditional_t<Const, const value_type &, value_type &>;
+	using iterator_category = std::bidirectional_iterator_tag;
+
+	intrusive_list_iterator() = default;
+
+	explicit intrusive_list_iterator(list_node_base *nd) : node(nd) {}
+
+	operator intrusive_list_iterator<Hook, true>() const requires(!Const) {
+		return intrusive_list_iterator<Hook, true>(node);
+	}
+
+	reference operator*() const { return *owner(node); }
+
+	pointer operator->() const { return owner(node); }
+
+	intrusive_list_iterator &operator++() {
+		node = node->_next;
+		return *this;
+	}
+
+	intrusive_list_iterator operator++(int) {
+		intrusive_list_iterator tmp = *this;
+		node                        = node->_next;
+		return tmp;
+	}
+
+	intrusive_list_iterator &operator--() {
+		node = node->_prev;
+		return *this;
+	}
+
+	intrusive_list_iterator operator--(int) {
+		intrusive_list_iterator tmp = *this;
+		node                        = node->_prev;
+		return tmp;
+	}
+
+	friend bool operator==(const intrusive_list_iterator &lhs,
+	                       const intrusive_list_iterator &rhs) {
+		return lhs.node == rhs.node;
+	}
+
+	static value_type *owner(list_node_base *nd) {
+		char *hook = reinterpret_cast<char *>(static_cast<hook_type *>(nd));
+		return reinterpret_cast<value_type *>(hook -
+		                                      detail::hook_offset<Hook>());
+	}
+
+	list_node_base *node = nullptr;
+};
+
+/*
+ * Doubly linked list threaded through a list_node_base member of the
+ * elements: intrusive_list<conn, &conn::hook>. The list never allocates,
+ * copies or destroys an element, it only links the hooks, so an object can
+ * be found, unlinked or moved to another list in O(1) from a plain
+ * reference. The caller keeps the objects alive while they are linked and
+ * an object sits in at most one list per hook.
+ *
+ * With a plain list_node_base hook the list counts its elements, and an
+ * element has to leave through the list (erase, pop, clear) before it is
+ * destroyed. With an auto_unlink_hook an element can also be dropped with
+ * hook.unlink() or by its destructor, without the list knowing: size() then
+ * walks the list, and splicing a range is O(1).
+ */
+template <typename T, auto Hook> class intrusive_list {
+	using traits    = detail::hook_traits<decltype(Hook)>;
+	using hook_type = typename traits::hook_type;
+
+	static_assert(std::is_same_v<typename traits::value_type, T>);
+	static_assert(std::is_base_of_v<list_node_base, hook_type>);
+
+public:
+	static constexpr bool auto_unlink =
+	    std::is_base_of_v<auto_unlink_hook, hook_type>;
+
+	using value_type             = T;
+	using size_type              = std::size_t;
+	using difference_type        = std::ptrdiff_t;
+	using reference              = T &;
+	using const_reference        = const T &;
+	using pointer                = T *;
+	using const_pointer          = const T *;
+	using iterator               = intrusive_list_iterator<Hook, false>;
+	using const_iterator         = intrusive_list_iterator<Hook, true>;
+	using reverse_iterator       = tp::reverse_iterator<iterator>;
+	using const_reverse_iterator = tp::reverse_iterator<const_iterator>;
+
+	intrusive_list() { init(); }
+
+	intrusive_list(const intrusive_list &)            = delete;
+	intrusive_list &operator=(const intrusive_list &) = delete;
+
+	intrusive_list(intrusive_list &&other) {
+		init();
+		take_nodes(other);
+	}
+
+	intrusive_list &operator=(intrusive_list &&other) {
+		if (this != &other) {
+			clear();
+			take_nodes(other);
+		}
+		return *this;
+	}
+
+	// the elements are unlinked, not destroyed
+	~intrusive_list() { clear(); }
+
+	iterator begin() { return iterator(header._next); }
+
+	const_iterator begin() const { return const_iterator(header._next); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(&header); }
+
+	const_iterator end() const { return const_iterator(head()); }
+
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(--end()); }
+
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(--end());
+	}
+
+	reverse_iterator rend() { return reverse_iterator(end()); }
+
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(end());
+	}
+
+	bool empty() const { return header._next == &header; }
+
+	// O(1), or O(n) with auto-unlink hooks
+	size_type size() const {
+		if constexpr (auto_unlink)
+			return base_distance(header._next, head());
+		else
+			return count;
+	}
+
+	reference front() { return *begin(); }
+
+	const_reference front() const { return *begin(); }
+
+	reference back() { return *--end(); }
+
+	const_reference back() const { return *--end(); }
+
+	// the iterator of an element known to be in this list, O(1)
+	iterator iterator_to(T &value) { return iterator(node_of(value)); }
+
+	const_iterator iterator_to(const T &value) const {
+		return const_iterator(node_of(const_cast<T &>(value)));
+	}
+
+	void push_back(T &value) { insert(end(), value); }
+
+	void push_front(T &value) { insert(begin(), value); }
+
+	void pop_back() { erase(--end()); }
+
+	void pop_front() { erase(begin()); }
+
+	iterator insert(const_iterator pos, T &value) {
+		list_node_base *nd = node_of(value);
+		nd->hook(pos.node);
+		inc_size(1);
+		return iterator(nd);
+	}
+
+	// unlink pos; the element itself is untouched
+	iterator erase(const_iterator pos) {
+		list_node_base *next = pos.node->_next;
+		unlink_node(pos.node);
+		dec_size(1);
+		return iterator(next);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		while (first != last)
+			first = erase(first);
+		return iterator(last.node);
+	}
+
+	// unlink an element known to be in this list, O(1)
+	void erase(T &value) { erase(iterator_to(value)); }
+
+	// erase and hand each element to dispose, e.g. to delete it
+	template <typename Disposer>
+	iterator erase_and_dispose(const_iterator pos, Disposer dispose) {
+		T *value      = iterator::owner(pos.node);
+		iterator next = erase(pos);
+		dispose(value);
+		return next;
+	}
+
+	void clear() {
+		clear_and_dispose([](T *) {});
+	}
+
+	template <typename Disposer> void clear_and_dispose(Disposer dispose) {
+		list_node_base *nd = header._next;
+		while (nd != &header) {
+			list_node_base *next = nd->_next;
+			nd->_next = nd->_prev = nd;
+			dispose(iterator::owner(nd));
+			nd = next;
+		}
+		init();
+	}
+
+	template <typename Pred> size_type remove_if(Pred pred) {
+		size_type removed = 0;
+		for (iterator it = begin(); it != end();) {
+			if (pred(*it)) {
+				it = erase(it);
+				++removed;
+			} else {
+				++it;
+			}
+		}
+		return removed;
+	}
+
+	/*
+	 * Splices relink hooks and never touch the elements. Moving a range of
+	 * a counted list has to count it: O(range), O(1) otherwise.
+	 */
+
+	void splice(const_iterator pos, intrusive_list &other) {
+		if (other.empty() || &other == this)
+			return;
+		pos.node->transfer(other.header._next, &other.header);
+		inc_size(other.count);
+		other.count = 0;
+	}
+
+	void splice(const_iterator pos, intrusive_list &&other) {
+		splice(pos, other);
+	}
+
+	void splice(const_iterator pos, intrusive_list &other, const_iterator it) {
+		if (pos == it || pos.node == it.node->_next)
+			return;
+		pos.node->transfer(it.node, it.node->_next);
+		inc_size(1);
+		other.dec_size(1);
+	}
+
+	void splice(const_iterator pos, intrusive_list &&other, const_iterator it) {
+		splice(pos, other, it);
+	}
+
+	void splice(const_iterator pos, intrusive_list &other, const_iterator first,
+	            const_iterator last) {
+		if (first == last)
+			return;
+		if constexpr (!auto_unlink) {
+			if (&other != this) {
+				size_type n = base_distance(first.node, last.node);
+				inc_size(n);
+				other.dec_size(n);
+			}
+		}
+		pos.node->transfer(first.node, last.node);
+	}
+
+	void splice(const_iterator pos, intrusive_list &&other, const_iterator first,
+	            const_iterator last) {
+		splice(pos, other, first, last);
+	}
+
+	void reverse() { header.reverse(); }
+
+	void swap(intrusive_list &other) {
+		intrusive_list tmp(std::move(other));
+		other.take_nodes(*this);
+		take_nodes(tmp);
+	}
+
+private:
+	static list_node_base *node_of(T &value) { return &(value.*Hook); }
+
+	static size_type base_distance(const list_node_base *first,
+	                               const list_node_base *last) {
+		size_type n = 0;
+		for (; first != last; first = first->_next)
+			++n;
+		return n;
+	}
+
+	list_node_base *head() const { return const_cast<list_node_base *>(&header); }
+
+	void init() {
+		header._next = header._prev = &header;
+		count                       = 0;
+	}
+
+	void inc_size(size_type n) {
+		if constexpr (!auto_unlink)
+			count += n;
+	}
+
+	void dec_size(size_type n) {
+		if constexpr (!auto_unlink)
+			count -= n;
+	}
+
+	// unlinked hooks point at themselves, so an auto hook sees it is free
+	static void unlink_node(list_node_base *nd) {
+		nd->unhook();
+		nd->_next = nd->_prev = nd;
+	}
+
+	// append all elements of other
+	void take_nodes(intrusive_list &other) {
+		if (other.empty())
+			return;
+		header.transfer(other.header._next, &other.header);
+		inc_size(other.count);
+		other.count = 0;
+	}
+
+	list_node_base header;
+	size_type count = 0; // unused with auto-unlink hooks
+};
+
+} // namespace tp
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <functional>
 #include <iterator.hpp>
 #include <memory>
 
@@ -107,6 +110,8 @@ template <typename T> class list_node : public list_node_base {
 public:
 	T *ptr() { return &val; }
 
+	const T *ptr() const { return &val; }
+
 	const T *cptr() { return &val; }
 
 private:
@@ -118,6 +123,7 @@ template <typename T> struct list_iterator {
 	using value_type        = T;
 	using pointer           = T *;
 	using reference         = T &;
+	using difference_type   = std::ptrdiff_t;
 	using iterator_category = std::bidirectional_iterator_tag;
 
 	list_iterator() : node() {}
@@ -163,17 +169,22 @@ template <typename T> struct list_const_iterator {
 	using value_type        = T;
 	using pointer           = const T *;
 	using reference         = const T &;
+	using difference_type   = std::ptrdiff_t;
 	using iterator_category = std::bidirectional_iterator_tag;
 
 	list_const_iterator() : node() {}
 
-	list_const_iterator(list_node_base *nd) : node(nd) {}
+	list_const_iterator(const list_node_base *nd) : node(nd) {}
 
 	list_const_iterator(const iterator &other) : node(other.node) {}
 
-	reference operator*() { return *(static_cast<Node *>(node)->ptr()); }
+	reference operator*() const {
+		return *(static_cast<const Node *>(node)->ptr());
+	}
 
-	pointer operator->() { return static_cast<Node *>(node)->ptr(); }
+	pointer operator->() const {
+		return static_cast<const Node *>(node)->ptr();
+	}
 
 	list_const_iterator &operator++() {
 		node = node->_next;
@@ -255,7 +266,7 @@ protected:
 
 	void inc_size(std::size_t n) { impl.header._size += n; }
 
-	void dec_size(std::size_t n) { --impl.header._size -= n; }
+	void dec_size(std::size_t n) { impl.header._size -= n; }
 
 	std::size_t node_count() const { return get_size(); }
 
@@ -614,23 +625,233 @@ public:
 		}
 	}
 
-	void merge(list& other) {
+	/*
+	 * Merge the sorted list other into this sorted one by relinking its
+	 * nodes; stable, elements of this list go first among equals.
+	 */
+	void merge(list &other) { merge(other, std::less<>()); }
+
+	void merge(list &&other) { merge(other, std::less<>()); }
+
+	template <typename Compare> void merge(list &other, Compare comp) {
+		if (&other == this)
+			return;
+		list_node_base *pos  = impl.header._next;
+		list_node_base *from = other.impl.header._next;
+		list_node_base *end2 = &other.impl.header;
+		while (pos != &impl.header && from != end2) {
+			if (comp(node_value(from), node_value(pos))) {
+				// move the whole run of other that goes before pos
+				list_node_base *run_end = from->_next;
+				while (run_end != end2 &&
+				       comp(node_value(run_end), node_value(pos)))
+					run_end = run_end->_next;
+				pos->transfer(from, run_end);
+				from = run_end;
+			}
+			pos = pos->_next;
+		}
+		if (from != end2)
+			impl.header.transfer(from, end2);
+		base::inc_size(other.size());
+		other.set_size(0);
 	}
 
-	void merge(list&& other) {
+	template <typename Compare> void merge(list &&other, Compare comp) {
+		merge(other, comp);
 	}
 
-	template <typename Compare>
-		void merge(list& other, Compare comp) {
+	/*
+	 * Move nodes of other before pos, no copies and no allocation. The whole
+	 * list and a single element are O(1); a range from another list is
+	 * O(distance) for the size bookkeeping.
+	 */
+	void splice(const_iterator pos, list &other) {
+		if (&other == this || other.empty())
+			return;
+		pos.remove_const().node->transfer(other.impl.header._next,
+		                                  &other.impl.header);
+		base::inc_size(other.size());
+		other.set_size(0);
+	}
+
+	void splice(const_iterator pos, list &&other) { splice(pos, other); }
 
+	void splice(const_iterator pos, list &other, const_iterator it) {
+		list_node_base *node = it.remove_const().node;
+		list_node_base *at   = pos.remove_const().node;
+		if (at == node || at == node->_next)
+			return;
+		at->transfer(node, node->_next);
+		if (&other != this) {
+			base::inc_size(1);
+			other.dec_size(1);
 		}
+	}
 
-	template <typename Compare>
-		void merge(list&& other, Compare comp) {
+	void splice(const_iterator pos, list &&other, const_iterator it) {
+		splice(pos, other, it);
+	}
+
+	void splice(const_iterator pos, list &other, const_iterator first,
+	            const_iterator last) {
+		list_node_base *f = first.remove_const().node;
+		list_node_base *l = last.remove_const().node;
+		if (f == l)
+			return;
+		if (&other != this) {
+			size_type n = base::distance(f, l);
+			base::inc_size(n);
+			other.dec_size(n);
+		}
+		pos.remove_const().node->transfer(f, l);
+	}
+
+	void splice(const_iterator pos, list &&other, const_iterator first,
+	            const_iterator last) {
+		splice(pos, other, first, last);
+	}
+
+	// erase the elements equal to value / for which pred holds; the count
+	size_type remove(const T &value) {
+		// value may live in one of the nodes; that one goes last
+		list_node_base *self = nullptr;
+		size_type removed    = 0;
+		list_node_base *node = impl.header._next;
+		while (node != &impl.header) {
+			list_node_base *next = node->_next;
+			if (node_value(node) == value) {
+				if (&node_value(node) == &value)
+					self = node;
+				else
+					erase_aux(iterator(node));
+				++removed;
+			}
+			node = next;
+		}
+		if (self)
+			erase_aux(iterator(self));
+		return removed;
+	}
+
+	template <typename Pred> size_type remove_if(Pred pred) {
+		size_type removed    = 0;
+		list_node_base *node = impl.header._next;
+		while (node != &impl.header) {
+			list_node_base *next = node->_next;
+			if (pred(node_value(node))) {
+				erase_aux(iterator(node));
+				++removed;
+			}
+			node = next;
+		}
+		return removed;
+	}
+
+	// erase all but the first of every run of equal elements; the count
+	size_type unique() { return unique(std::equal_to<>()); }
+
+	template <typename BinaryPred> size_type unique(BinaryPred pred) {
+		size_type removed = 0;
+		if (empty())
+			return removed;
+		list_node_base *kept = impl.header._next;
+		list_node_base *node = kept->_next;
+		while (node != &impl.header) {
+			list_node_base *next = node->_next;
+			if (pred(node_value(kept), node_value(node))) {
+				erase_aux(iterator(node));
+				++removed;
+			} else {
+				kept = node;
+			}
+			node = next;
+		}
+		return removed;
+	}
 
+	void reverse() { impl.header.reverse(); }
+
+	/*
+	 * Stable bottom-up merge sort that only relinks nodes and allocates
+	 * nothing.
+	 *
+	 * The list is cut open into null-terminated runs. Nodes are taken one
+	 * by one and carried into bins[i], which holds a sorted run of 2^i
+	 * nodes or nothing, like a binary counter. A merge fixes _prev of every
+	 * node it links while that node is in cache, so only the two ends need
+	 * patching afterwards. 64 bins cover any list that fits in memory.
+	 */
+	void sort() { sort(std::less<>()); }
+
+	template <typename Compare> void sort(Compare comp) {
+		if (size() < 2)
+			return;
+		sort_run bins[64] = {};
+		std::size_t used  = 0;
+
+		impl.header._prev->_next = nullptr;
+		list_node_base *node     = impl.header._next;
+		while (node) {
+			sort_run run{node, node};
+			node            = node->_next;
+			run.head->_next = nullptr;
+
+			std::size_t i = 0;
+			for (; bins[i].head; ++i) {
+				run     = merge_runs(bins[i], run, comp);
+				bins[i] = {};
+			}
+			bins[i] = run;
+			used    = std::max(used, i + 1);
 		}
 
+		// lower bins hold later elements
+		sort_run run{};
+		for (std::size_t i = 0; i < used; ++i)
+			if (bins[i].head)
+				run = run.head ? merge_runs(bins[i], run, comp) : bins[i];
+
+		impl.header._next = run.head;
+		run.head->_prev   = &impl.header;
+		impl.header._prev = run.tail;
+		run.tail->_next   = &impl.header;
+	}
+
 private:
+	static T &node_value(list_node_base *node) {
+		return *static_cast<Node *>(node)->ptr();
+	}
+
+	// a null-terminated chain of nodes during sort
+	struct sort_run {
+		list_node_base *head, *tail;
+	};
+
+	// stable merge, a before b; _prev is set for every node linked here
+	template <typename Compare>
+	static sort_run merge_runs(sort_run a, sort_run b, Compare &comp) {
+		list_node_base head;
+		list_node_base *tail = &head;
+		list_node_base *x = a.head, *y = b.head;
+		while (x && y) {
+			if (comp(node_value(y), node_value(x))) {
+				tail->_next = y;
+				y->_prev    = tail;
+				y           = y->_next;
+			} else {
+				tail->_next = x;
+				x->_prev    = tail;
+				x           = x->_next;
+			}
+			tail = tail->_next;
+		}
+		list_node_base *rest = x ? x : y;
+		tail->_next          = rest;
+		rest->_prev          = tail;
+		return {head._next, x ? a.tail : b.tail};
+	}
+
 	void insert_at_begin(Node *node) {
 		Node *first = static_cast<Node*>(impl.header._next);
 		node->_prev = &(impl.header);
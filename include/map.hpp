@@ -3,6 +3,7 @@
 
 #include <cstdio>
 #include <initializer_list>
+#include <memory>
 #include <rbtree_impl.hpp>
 #include <utility>
 
@@ -52,7 +53,9 @@ template <typename T1, typename T2> pair<T1, T2> make_pair(T1 t, T2 u) {
 	return pair<T1, T2>(t, u);
 }
 
-template <typename Key, typename T, typename Comp = less<Key>> class map {
+template <typename Key, typename T, typename Comp = less<Key>,
+          typename Alloc = std::allocator<pair<const Key, T>>>
+class map {
 private:
 	struct node;
 	struct iterator;
@@ -73,11 +76,16 @@ public:
 	using const_reverse_iterator = const_reverse_iterator;
 	// TODO: node_type should change to shared_ptr, otherwise it will leak memory
 	using node_type              = node;
+	using allocator_type         = Alloc;
 
 	map() = default;
-	map(std::initializer_list<value_type> init, const Comp &_comp = Comp());
+	explicit map(const Alloc &_alloc) : alloc(_alloc) {}
+	map(std::initializer_list<value_type> init, const Comp &_comp = Comp(),
+	    const Alloc &_alloc = Alloc());
 	~map();
 
+	allocator_type get_allocator() const { return allocator_type(alloc); }
+
 	mapped_type &at(const key_type &key);
 	const mapped_type &at(const key_type &key) const;
 
@@ -361,67 +369,75 @@ private:
 		const_iterator it;
 	};
 
+	using node_alloc_type =
+	    typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+	using node_alloc_traits = std::allocator_traits<node_alloc_type>;
+
 	rbroot rbr{};
 	size_type _size{0};
 	Comp comp{};
+	[[no_unique_address]] node_alloc_type alloc{};
 };
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::map(std::initializer_list<value_type> init,
-                       const Comp &_comp)
-    : comp(_comp) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::map(std::initializer_list<value_type> init,
+                              const Comp &_comp, const Alloc &_alloc)
+    : comp(_comp), alloc(_alloc) {
 	for (auto it = init.begin(); it != init.end(); ++it) {
 		insert_value(*it);
 	}
 }
 
-template <typename Key, typename T, typename Comp> map<Key, T, Comp>::~map() {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::~map() {
 	clear();
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::mapped_type &map<Key, T, Comp>::at(const key_type &key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::mapped_type &
+map<Key, T, Comp, Alloc>::at(const key_type &key) {
 	node_type *nd = find_node(key);
 	return nd->value.second;
 }
 
-template <typename Key, typename T, typename Comp>
-const map<Key, T, Comp>::mapped_type &
-map<Key, T, Comp>::at(const key_type &key) const {
+template <typename Key, typename T, typename Comp, typename Alloc>
+const map<Key, T, Comp, Alloc>::mapped_type &
+map<Key, T, Comp, Alloc>::at(const key_type &key) const {
 	node_type *nd = find_node(key);
 	return nd->value.second;
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::mapped_type &
-map<Key, T, Comp>::operator[](const key_type &key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::mapped_type &
+map<Key, T, Comp, Alloc>::operator[](const key_type &key) {
 	node_type *nd = insert_value({key, mapped_type{}});
 	return nd->mapped();
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::mapped_type &map<Key, T, Comp>::operator[](key_type &&key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::mapped_type &
+map<Key, T, Comp, Alloc>::operator[](key_type &&key) {
 	node_type *nd = insert_value({key, mapped_type{}});
 	return nd->mapped();
 }
 
-template <typename Key, typename T, typename Comp>
-void map<Key, T, Comp>::clear() {
+template <typename Key, typename T, typename Comp, typename Alloc>
+void map<Key, T, Comp, Alloc>::clear() {
 	node_type *nd{nullptr};
 	rbnode *rbp = rb_first_postorder(rbr.node);
 	while (rbp) {
 		nd  = rb_entry(rbp, node_type, rbn);
 		rbp = rb_next_postorder(rbp);
-		delete nd;
+		destroy_node(nd);
 		nd = nullptr;
 	}
 	_size    = 0;
 	rbr.node = nullptr;
 }
 
-template <typename Key, typename T, typename Comp>
-pair<typename map<Key, T, Comp>::iterator, bool>
-map<Key, T, Comp>::insert(const value_type &value) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+pair<typename map<Key, T, Comp, Alloc>::iterator, bool>
+map<Key, T, Comp, Alloc>::insert(const value_type &value) {
 	node_type *nd{nullptr};
 	node_type *tmp{nullptr};
 	rbnode *parent = rbr.node;
@@ -462,9 +478,9 @@ map<Key, T, Comp>::insert(const value_type &value) {
 	return {iterator(nd), true};
 }
 
-template <typename Key, typename T, typename Comp>
-pair<typename map<Key, T, Comp>::iterator, bool>
-map<Key, T, Comp>::insert(value_type &&value) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+pair<typename map<Key, T, Comp, Alloc>::iterator, bool>
+map<Key, T, Comp, Alloc>::insert(value_type &&value) {
 	node_type *nd{nullptr};
 	node_type *tmp{nullptr};
 	rbnode *parent = rbr.node;
@@ -505,16 +521,17 @@ map<Key, T, Comp>::insert(value_type &&value) {
 	return {iterator(nd), true};
 }
 
-template <typename Key, typename T, typename Comp>
+template <typename Key, typename T, typename Comp, typename Alloc>
 template <typename... Args>
-pair<typename map<Key, T, Comp>::iterator, bool>
-map<Key, T, Comp>::emplace(Args &&...args) {
+pair<typename map<Key, T, Comp, Alloc>::iterator, bool>
+map<Key, T, Comp, Alloc>::emplace(Args &&...args) {
 	value_type val = make_pair(std::forward<Args>(args)...);
 	return insert(val);
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::iterator map<Key, T, Comp>::erase(iterator pos) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::iterator
+map<Key, T, Comp, Alloc>::erase(iterator pos) {
 	node_type *nd  = pos.nd;
 	node_type *nxt = rb_entry_safe(rb_next(&(nd->rbn)), node_type, rbn);
 	iterator ret(nxt);
@@ -522,26 +539,28 @@ map<Key, T, Comp>::iterator map<Key, T, Comp>::erase(iterator pos) {
 	rbnode *reblance = rb_erase_node(&(nd->rbn), &rbr);
 	if (reblance)
 		rb_erase_reblance(reblance, &rbr);
+	destroy_node(nd);
 
 	--_size;
 	return ret;
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::size_type
-map<Key, T, Comp>::count(const key_type &key) const {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::size_type
+map<Key, T, Comp, Alloc>::count(const key_type &key) const {
 	return find_node(key) != nullptr;
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::iterator map<Key, T, Comp>::find(const key_type &key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::iterator
+map<Key, T, Comp, Alloc>::find(const key_type &key) {
 	node_type *nd = find_node(key);
 	return iterator(nd);
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::iterator
-map<Key, T, Comp>::lower_bound(const key_type &key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::iterator
+map<Key, T, Comp, Alloc>::lower_bound(const key_type &key) {
 	rbnode *rbp = rbr.node;
 	node_type *nd{nullptr};
 	iterator ret(nullptr);
@@ -557,9 +576,9 @@ map<Key, T, Comp>::lower_bound(const key_type &key) {
 	}
 	return ret;
 }
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::const_iterator
-map<Key, T, Comp>::lower_bound(const key_type &key) const {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::const_iterator
+map<Key, T, Comp, Alloc>::lower_bound(const key_type &key) const {
 	rbnode *rbp = rbr.node;
 	node_type *nd{nullptr};
 	const_iterator ret(nullptr);
@@ -576,9 +595,9 @@ map<Key, T, Comp>::lower_bound(const key_type &key) const {
 	return ret;
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::iterator
-map<Key, T, Comp>::upper_bound(const key_type &key) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::iterator
+map<Key, T, Comp, Alloc>::upper_bound(const key_type &key) {
 	rbnode *rbp = rbr.node;
 	node_type *nd{nullptr};
 	iterator ret(nullptr);
@@ -599,9 +618,9 @@ map<Key, T, Comp>::upper_bound(const key_type &key) {
 	return ret;
 }
 
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::const_iterator
-map<Key, T, Comp>::upper_bound(const key_type &key) const {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::const_iterator
+map<Key, T, Comp, Alloc>::upper_bound(const key_type &key) const {
 
 	rbnode *rbp = rbr.node;
 	node_type *nd{nullptr};
@@ -623,20 +642,27 @@ map<Key, T, Comp>::upper_bound(const key_type &key) const {
 	return ret;
 }
 
-template <typename Key, typename T, typename Comp>
-inline map<Key, T, Comp>::node_type *
-map<Key, T, Comp>::create_node(const value_type &value) {
-	node_type *nd = new node_type(value);
+template <typename Key, typename T, typename Comp, typename Alloc>
+inline map<Key, T, Comp, Alloc>::node_type *
+map<Key, T, Comp, Alloc>::create_node(const value_type &value) {
+	node_type *nd = node_alloc_traits::allocate(alloc, 1);
+	try {
+		node_alloc_traits::construct(alloc, nd, value);
+	} catch (...) {
+		node_alloc_traits::deallocate(alloc, nd, 1);
+		throw;
+	}
 	return nd;
 }
-template <typename Key, typename T, typename Comp>
-inline void map<Key, T, Comp>::destroy_node(node_type *nd) {
-	delete nd;
+template <typename Key, typename T, typename Comp, typename Alloc>
+inline void map<Key, T, Comp, Alloc>::destroy_node(node_type *nd) {
+	node_alloc_traits::destroy(alloc, nd);
+	node_alloc_traits::deallocate(alloc, nd, 1);
 }
 
-template <typename Key, typename T, typename Comp>
-inline map<Key, T, Comp>::node_type *
-map<Key, T, Comp>::find_node(const key_type &key) const {
+template <typename Key, typename T, typename Comp, typename Alloc>
+inline map<Key, T, Comp, Alloc>::node_type *
+map<Key, T, Comp, Alloc>::find_node(const key_type &key) const {
 	rbnode *rbp = rbr.node;
 	node_type *nd{nullptr};
 
@@ -653,8 +679,8 @@ map<Key, T, Comp>::find_node(const key_type &key) const {
 	return nd;
 }
 
-template <typename Key, typename T, typename Comp>
-void map<Key, T, Comp>::insert_node(node_type *nd) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+void map<Key, T, Comp, Alloc>::insert_node(node_type *nd) {
 	node_type *tmp{nullptr};
 	// insert operation
 	rbnode *parent = rbr.node;
@@ -683,9 +709,9 @@ void map<Key, T, Comp>::insert_node(node_type *nd) {
 	rb_insert_reblance(&(nd->rbn), &rbr);
 	++_size;
 }
-template <typename Key, typename T, typename Comp>
-map<Key, T, Comp>::node_type *
-map<Key, T, Comp>::insert_value(const value_type &value) {
+template <typename Key, typename T, typename Comp, typename Alloc>
+map<Key, T, Comp, Alloc>::node_type *
+map<Key, T, Comp, Alloc>::insert_value(const value_type &value) {
 	node_type *nd{nullptr};
 	node_type *tmp{nullptr};
 	rbnode *parent = rbr.node;
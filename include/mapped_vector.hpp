@@ -0,0 +1,403 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <growth_policy.hpp>
+#include <iterator.hpp>
+
+namespace tp {
+
+/*
+ * A vector of trivially copyable records that lives in a file.
+ *
+ * The file is a 64-byte header followed by the elements, mapped MAP_SHARED,
+ * so reopening it costs page faults on first touch rather than a parse.
+ * Growing extends the file with ftruncate and moves the mapping with
+ * mremap; capacity is whatever the file length holds, so a reopened file
+ * keeps its slack. The element count in the header is written by flush()
+ * and close(); flush() also msyncs the mapping to disk.
+ *
+ * A read_only mapping is PROT_READ: any mutating call throws
+ * std::logic_error. Records are stored in native layout and byte order.
+ */
+template <typename T, typename Growth = tp::doubling_growth>
+class mapped_vector {
+	static_assert(std::is_trivially_copyable_v<T>,
+	              "mapped_vector stores raw bytes");
+
+	static constexpr std::size_t data_offset = 64;
+	static_assert(alignof(T) <= data_offset);
+
+public:
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T &;
+	using const_reference = const T &;
+	using pointer         = T *;
+	using const_pointer   = const T *;
+	using growth_policy   = Growth;
+
+	using iterator       = tp::normal_iterator<pointer, mapped_vector>;
+	using const_iterator = tp::normal_iterator<const_pointer, mapped_vector>;
+
+	enum class open_mode { read_only, read_write };
+
+	mapped_vector() = default;
+
+	// read_write creates the file if it does not exist
+	explicit mapped_vector(const char *path,
+	                       open_mode mode = open_mode::read_write) {
+		open(path, mode);
+	}
+
+	mapped_vector(const mapped_vector &)            = delete;
+	mapped_vector &operator=(const mapped_vector &) = delete;
+
+	mapped_vector(mapped_vector &&other) { swap(other); }
+
+	mapped_vector &operator=(mapped_vector &&other) {
+		if (this != &other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	~mapped_vector() { close(); }
+
+	void open(const char *path, open_mode mode = open_mode::read_write);
+
+	// store the size, unmap and close; the pages reach disk in the
+	// background unless flush() was called
+	void close();
+
+	// store the size and msync the mapping
+	void flush();
+
+	bool is_open() const { return fd >= 0; }
+
+	bool read_only() const { return ro; }
+
+	reference at(size_type pos) {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return _data[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return _data[pos];
+	}
+
+	reference operator[](size_type pos) { return _data[pos]; }
+
+	const_reference operator[](size_type pos) const { return _data[pos]; }
+
+	reference front() { return *_data; }
+
+	const_reference front() const { return *_data; }
+
+	reference back() { return *(_data + sz - 1); }
+
+	const_reference back() const { return *(_data + sz - 1); }
+
+	T *data() { return _data; }
+
+	const T *data() const { return _data; }
+
+	iterator begin() { return iterator(_data); }
+
+	const_iterator begin() const { return const_iterator(_data); }
+
+	const_iterator cbegin() const { return const_iterator(_data); }
+
+	iterator end() { return iterator(_data + sz); }
+
+	const_iterator end() const { return const_iterator(_data + sz); }
+
+	const_iterator cend() const { return const_iterator(_data + sz); }
+
+	bool empty() const { return sz == 0; }
+
+	size_type size() const { return sz; }
+
+	size_type capacity() const { return cap; }
+
+	void reserve(size_type new_cap) {
+		writable();
+		if (new_cap > cap)
+			remap(new_cap);
+	}
+
+	// cut the file down to the elements in use (rounded up to a page)
+	void shrink_to_fit() {
+		writable();
+		remap(sz);
+	}
+
+	void clear() {
+		writable();
+		sz = 0;
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		writable();
+		if (sz == cap) {
+			// args may refer to an element, which grow() moves
+			T tmp(std::forward<Args>(args)...);
+			grow(sz + 1);
+			::new (static_cast<void *>(_data + sz)) T(tmp);
+		} else {
+			::new (static_cast<void *>(_data + sz))
+			    T(std::forward<Args>(args)...);
+		}
+		return _data[sz++];
+	}
+
+	void pop_back() {
+		writable();
+		--sz;
+	}
+
+	// new elements are value-initialized (zero for plain records)
+	void resize(size_type count) {
+		if (count > cap)
+			grow(count);
+		writable();
+		for (; sz < count; ++sz)
+			::new (static_cast<void *>(_data + sz)) T();
+		sz = count;
+	}
+
+	template <std::ranges::input_range Range>
+	requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	void append_range(Range &&rg) {
+		if constexpr (std::ranges::contiguous_range<Range> &&
+		              std::ranges::sized_range<Range> &&
+		              std::is_same_v<std::ranges::range_value_t<Range>, T>) {
+			size_type count = std::ranges::size(rg);
+			const T *src    = std::ranges::data(rg);
+			if (sz + count > cap) {
+				// a source inside this vector moves with the mapping
+				std::less<const T *> before;
+				if (!before(src, _data) && before(src, _data + sz)) {
+					size_type off = src - _data;
+					grow(sz + count);
+					src = _data + off;
+				} else {
+					grow(sz + count);
+				}
+			}
+			writable();
+			if (count)
+				std::memcpy(static_cast<void *>(_data + sz), src,
+				            count * sizeof(T));
+			sz += count;
+		} else if constexpr (std::ranges::sized_range<Range>) {
+			size_type count = std::ranges::size(rg);
+			if (sz + count > cap) {
+				// the range may read from this vector: copy it out before
+				// grow() moves the mapping
+				std::vector<T> tmp;
+				tmp.reserve(count);
+				for (auto &&elem : rg)
+					tmp.push_back(std::forward<decltype(elem)>(elem));
+				append_range(tmp);
+				return;
+			}
+			writable();
+			for (auto &&elem : rg)
+				_data[sz++] = std::forward<decltype(elem)>(elem);
+		} else {
+			for (auto &&elem : rg)
+				push_back(std::forward<decltype(elem)>(elem));
+		}
+	}
+
+	void swap(mapped_vector &other) {
+		std::swap(fd, other.fd);
+		std::swap(ro, other.ro);
+		std::swap(base, other.base);
+		std::swap(map_len, other.map_len);
+		std::swap(_data, other._data);
+		std::swap(sz, other.sz);
+		std::swap(cap, other.cap);
+	}
+
+private:
+	struct file_header {
+		char magic[8];
+		std::uint64_t elem_size;
+		std::uint64_t size;
+	};
+
+	static constexpr char file_magic[8] = {'t', 'p', 'm', 'v', 'e', 'c', '0',
+	                                       '1'};
+
+	static std::size_t page_size() {
+		static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+		return page;
+	}
+
+	// file length holding n elements, whole pages
+	static std::size_t file_length(size_type n) {
+		std::size_t page = page_size();
+		return (data_offset + n * sizeof(T) + page - 1) & ~(page - 1);
+	}
+
+	[[noreturn]] static void fail(const char *what) {
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	file_header *header() const { return static_cast<file_header *>(base); }
+
+	void writable() const {
+		if (ro)
+			throw std::logic_error("mapped_vector: opened read-only");
+	}
+
+	void grow(size_type required) {
+		writable();
+		remap(Growth::next_capacity(cap, required, sizeof(T)));
+	}
+
+	void remap(size_type new_cap);
+
+	int fd              = -1;
+	bool ro             = false;
+	void *base          = nullptr;
+	std::size_t map_len = 0;
+	T *_data            = nullptr;
+	size_type sz        = 0;
+	size_type cap       = 0;
+};
+
+template <typename T, typename Growth>
+void mapped_vector<T, Growth>::open(const char *path, open_mode mode) {
+	close();
+	ro = mode == open_mode::read_only;
+
+	fd = ro ? ::open(path, O_RDONLY | O_CLOEXEC)
+	        : ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0)
+		fail("mapped_vector: open");
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0) {
+		int err = errno;
+		::close(fd), fd = -1;
+		errno = err;
+		fail("mapped_vector: fstat");
+	}
+
+	std::size_t len = st.st_size;
+	bool fresh      = len == 0 && !ro;
+	if (fresh) {
+		len = file_length(0);
+		if (::ftruncate(fd, len) < 0) {
+			int err = errno;
+			::close(fd), fd = -1;
+			errno = err;
+			fail("mapped_vector: ftruncate");
+		}
+	}
+	if (len < data_offset) {
+		::close(fd), fd = -1;
+		throw std::runtime_error("mapped_vector: file too short");
+	}
+
+	int prot = ro ? PROT_READ : PROT_READ | PROT_WRITE;
+	base     = ::mmap(nullptr, len, prot, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		int err = errno;
+		base    = nullptr;
+		::close(fd), fd = -1;
+		errno = err;
+		fail("mapped_vector: mmap");
+	}
+	map_len = len;
+
+	file_header *hdr = header();
+	if (fresh) {
+		std::memcpy(hdr->magic, file_magic, sizeof(file_magic));
+		hdr->elem_size = sizeof(T);
+		hdr->size      = 0;
+	}
+	cap = (map_len - data_offset) / sizeof(T);
+	if (std::memcmp(hdr->magic, file_magic, sizeof(file_magic)) != 0 ||
+	    hdr->elem_size != sizeof(T) || hdr->size > cap) {
+		close();
+		throw std::runtime_error("mapped_vector: bad file header");
+	}
+	sz    = hdr->size;
+	_data = reinterpret_cast<T *>(static_cast<char *>(base) + data_offset);
+}
+
+template <typename T, typename Growth>
+void mapped_vector<T, Growth>::close() {
+	if (fd < 0)
+		return;
+	if (!ro && base)
+		header()->size = sz;
+	if (base)
+		::munmap(base, map_len);
+	::close(fd);
+	fd = -1, base = nullptr, map_len = 0;
+	_data = nullptr, sz = 0, cap = 0;
+}
+
+template <typename T, typename Growth>
+void mapped_vector<T, Growth>::flush() {
+	if (fd < 0 || ro)
+		return;
+	header()->size = sz;
+	if (::msync(base, map_len, MS_SYNC) < 0)
+		fail("mapped_vector: msync");
+}
+
+template <typename T, typename Growth>
+void mapped_vector<T, Growth>::remap(size_type new_cap) {
+	std::size_t len = file_length(new_cap);
+	if (len == map_len)
+		return;
+
+	// shrink the mapping before the file, grow the file before the mapping,
+	// so no page of the mapping is ever past the end of the file
+	if (len > map_len && ::ftruncate(fd, len) < 0)
+		fail("mapped_vector: ftruncate");
+	void *p = ::mremap(base, map_len, len, MREMAP_MAYMOVE);
+	if (p == MAP_FAILED)
+		fail("mapped_vector: mremap");
+	bool shrunk = len < map_len;
+
+	base    = p;
+	map_len = len;
+	_data   = reinterpret_cast<T *>(static_cast<char *>(base) + data_offset);
+	cap     = (map_len - data_offset) / sizeof(T);
+
+	// a file longer than the mapping is harmless: the slack is capacity
+	// again on the next open, so a failed truncate is not an error
+	if (shrunk && ::ftruncate(fd, len) < 0)
+		errno = 0;
+}
+
+} // namespace tp
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <memory>
+
+#include <type_traits.hpp>
+
+namespace tp {
+
+/*
+ * Move [first, last) to the uninitialized storage starting at dest and end
+ * the lifetime of the source objects. The ranges may overlap, which is how
+ * containers shift a tail in place. Trivially relocatable types are moved
+ * with a single memmove.
+ */
+template <typename Alloc, typename T>
+void relocate(Alloc &alloc, T *first, T *last, T *dest) {
+	using traits = std::allocator_traits<Alloc>;
+
+	if (first == last || first == dest)
+		return;
+
+	if constexpr (tp::is_trivially_relocatable_v<T>) {
+		std::memmove(static_cast<void *>(dest), static_cast<const void *>(first),
+		             (last - first) * sizeof(T));
+	} else if (dest < first) {
+		while (first != last) {
+			traits::construct(alloc, dest, std::move(*first));
+			traits::destroy(alloc, first);
+			++first, ++dest;
+		}
+	} else {
+		dest += last - first;
+		while (last != first) {
+			--last, --dest;
+			traits::construct(alloc, dest, std::move(*last));
+			traits::destroy(alloc, last);
+		}
+	}
+}
+
+/*
+ * Optional allocator extensions for containers that own one contiguous
+ * buffer. An allocator may provide
+ *
+ *     bool try_expand(pointer p, size_type old_n, size_type new_n);
+ *         grow (or shrink) the allocation at p in place, false if it cannot;
+ *
+ *     pointer reallocate(pointer p, size_type old_n, size_type new_n);
+ *         move the allocation to a buffer of new_n elements, carrying the
+ *         bytes over (like realloc), and return it.
+ *
+ * Containers query them through allocator_ext_traits and only use
+ * reallocate for trivially relocatable elements.
+ */
+template <typename Alloc> struct allocator_ext_traits {
+	using pointer   = std::allocator_traits<Alloc>::pointer;
+	using size_type = std::allocator_traits<Alloc>::size_type;
+
+	static constexpr bool has_try_expand =
+	    requires(Alloc &a, pointer p, size_type n) {
+		    { a.try_expand(p, n, n) } -> std::convertible_to<bool>;
+	    };
+
+	static constexpr bool has_reallocate =
+	    requires(Alloc &a, pointer p, size_type n) {
+		    { a.reallocate(p, n, n) } -> std::convertible_to<pointer>;
+	    };
+
+	static bool try_expand(Alloc &a, pointer p, size_type old_n,
+	                       size_type new_n) {
+		if constexpr (has_try_expand)
+			return a.try_expand(p, old_n, new_n);
+		else
+			return false;
+	}
+
+	static pointer reallocate(Alloc &a, pointer p, size_type old_n,
+	                          size_type new_n)
+	requires has_reallocate
+	{
+		return a.reallocate(p, old_n, new_n);
+	}
+};
+
+} // namespace tp
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tp {
+
+/*
+ * Allocator for large, growing buffers of trivially relocatable elements.
+ *
+ * Requests of at least mmap_threshold bytes get their own anonymous mapping.
+ * Such a buffer can grow in place (try_expand) or be moved by remapping its
+ * pages with mremap(2) (reallocate), so a vector growing to several GB never
+ * holds the old and the new copy at the same time. Smaller requests go to
+ * std::allocator.
+ *
+ * Implements the allocator_ext_traits hooks from memory.hpp.
+ */
+template <typename T> struct mmap_allocator {
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using is_always_equal = std::true_type;
+
+	static constexpr std::size_t mmap_threshold = std::size_t(1) << 20;
+
+	mmap_allocator() = default;
+
+	template <typename U> mmap_allocator(const mmap_allocator<U> &) {}
+
+	T *allocate(size_type n) {
+		if (!is_mapped(n))
+			return std::allocator<T>().allocate(n);
+
+		void *p = ::mmap(nullptr, map_length(n), PROT_READ | PROT_WRITE,
+		                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			throw std::bad_alloc();
+		return static_cast<T *>(p);
+	}
+
+	void deallocate(T *p, size_type n) {
+		if (!p)
+			return;
+		if (is_mapped(n))
+			::munmap(p, map_length(n));
+		else
+			std::allocator<T>().deallocate(p, n);
+	}
+
+	bool try_expand(T *p, size_type old_n, size_type new_n) {
+		if (!is_mapped(old_n) || !is_mapped(new_n))
+			return false;
+
+		std::size_t old_len = map_length(old_n);
+		std::size_t new_len = map_length(new_n);
+		if (new_len < old_len)
+			return ::munmap(reinterpret_cast<char *>(p) + new_len,
+			                old_len - new_len) == 0;
+		if (new_len == old_len)
+			return true;
+		// no MREMAP_MAYMOVE: succeeds only if the pages after p are free
+		return ::mremap(p, old_len, new_len, 0) != MAP_FAILED;
+	}
+
+	T *reallocate(T *p, size_type old_n, size_type new_n) {
+		if (is_mapped(old_n) && is_mapped(new_n)) {
+			void *q = ::mremap(p, map_length(old_n), map_length(new_n),
+			                   MREMAP_MAYMOVE);
+			if (q == MAP_FAILED)
+				throw std::bad_alloc();
+			return static_cast<T *>(q);
+		}
+
+		// crossing the threshold, fall back to copying
+		T *q = allocate(new_n);
+		std::memcpy(static_cast<void *>(q), static_cast<const void *>(p),
+		            (old_n < new_n ? old_n : new_n) * sizeof(T));
+		deallocate(p, old_n);
+		return q;
+	}
+
+	static bool is_mapped(size_type n) {
+		return n * sizeof(T) >= mmap_threshold;
+	}
+
+	friend bool operator==(const mmap_allocator &, const mmap_allocator &) {
+		return true;
+	}
+
+private:
+	static std::size_t map_length(size_type n) {
+		static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+		return (n * sizeof(T) + page - 1) & ~(page - 1);
+	}
+};
+
+} // namespace tp
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <array.hpp>
+#include <vector.hpp>
+
+namespace tp {
+
+namespace detail {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+} // namespace detail
+
+/*
+ * Bounded multi-producer/multi-consumer queue (Vyukov).
+ *
+ * Every slot carries a sequence number telling which lap of which side may
+ * use it next: a slot is free for the push at position pos when its number
+ * is pos, and holds the element for the pop at pos when it is pos + 1; the
+ * pop sets it to pos + capacity. A producer or consumer claims a position
+ * with one CAS on its own counter and then only touches that slot, so
+ * threads on different slots never share a cache line: slots are padded to
+ * one line each.
+ *
+ * try_* calls never wait. push/pop take a position unconditionally and
+ * then wait for the slot: a short spin, then a futex wait on the sequence
+ * number. A waiter flags the slot first, so a publish pays for the notify
+ * only when someone sleeps on that very slot.
+ *
+ * With Capacity 0 the capacity is given at run time and the slots live in
+ * a tp::vector; otherwise they are a tp::array inside the queue. Either way
+ * the capacity is a power of two, at least 2.
+ *
+ * An element is moved in or out after its slot was claimed, so T has to be
+ * nothrow move constructible and assignable; emplace arguments that might
+ * throw are turned into a T first.
+ */
+template <typename T, std::size_t Capacity = 0> class mpmc_queue {
+	static_assert(std::is_nothrow_move_constructible_v<T> &&
+	              std::is_nothrow_move_assignable_v<T>);
+	static_assert(Capacity == 0 ||
+	              (Capacity >= 2 && (Capacity & (Capacity - 1)) == 0));
+
+	static constexpr std::size_t cache_line = 64;
+
+	struct alignas(cache_line) slot {
+		std::size_t seq      = 0;
+		std::uint32_t parked = 0; // someone waits for seq to change
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		T *elem() { return std::launder(reinterpret_cast<T *>(storage)); }
+	};
+
+	using slots_type = std::conditional_t<Capacity == 0, ::vector<slot>,
+	                                      tp::array<slot, Capacity>>;
+
+public:
+	using value_type = T;
+	using size_type  = std::size_t;
+
+	mpmc_queue() requires(Capacity != 0) { init(Capacity); }
+
+	// capacity is rounded up to a power of two
+	explicit mpmc_queue(size_type capacity) requires(Capacity == 0) {
+		size_type cap = 2;
+		while (cap < capacity)
+			cap *= 2;
+		slots.resize(cap);
+		init(cap);
+	}
+
+	mpmc_queue(const mpmc_queue &)            = delete;
+	mpmc_queue &operator=(const mpmc_queue &) = delete;
+
+	~mpmc_queue() {
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			size_type last = tail.load(std::memory_order_relaxed);
+			for (size_type pos = head.load(std::memory_order_relaxed);
+			     pos != last; ++pos) {
+				slot &s = slots[pos & mask];
+				if (s.seq == pos + 1)
+					s.elem()->~T();
+			}
+		}
+	}
+
+	size_type capacity() const { return mask + 1; }
+
+	// a snapshot; exact only while no push or pop is running
+	size_type size() const {
+		size_type t = tail.load(std::memory_order_relaxed);
+		size_type h = head.load(std::memory_order_relaxed);
+		std::ptrdiff_t n = std::ptrdiff_t(t - h);
+		return n < 0 ? 0 : std::min(size_type(n), capacity());
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/* non-blocking; false if the queue is full or empty */
+
+	bool try_push(const T &value) { return try_emplace(value); }
+
+	bool try_push(T &&value) { return try_emplace(std::move(value)); }
+
+	template <typename... Args> bool try_emplace(Args &&...args) {
+		if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+			return try_emplace(T(std::forward<Args>(args)...));
+		} else {
+			size_type pos = tail.load(std::memory_order_relaxed);
+			slot *s;
+			for (;;) {
+				s = &slots[pos & mask];
+				std::ptrdiff_t diff = std::ptrdiff_t(seq_of(*s) - pos);
+				if (diff == 0) {
+					if (tail.compare_exchange_weak(pos, pos + 1,
+					                               std::memory_order_relaxed))
+						break;
+				} else if (diff < 0) {
+					return false;
+				} else {
+					pos = tail.load(std::memory_order_relaxed);
+				}
+			}
+			::new (static_cast<void *>(s->storage))
+			    T(std::forward<Args>(args)...);
+			publish(*s, pos + 1);
+			return true;
+		}
+	}
+
+	bool try_pop(T &out) {
+		size_type pos = head.load(std::memory_order_relaxed);
+		slot *s;
+		for (;;) {
+			s = &slots[pos & mask];
+			std::ptrdiff_t diff = std::ptrdiff_t(seq_of(*s) - (pos + 1));
+			if (diff == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1,
+				                               std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+		take(*s, out);
+		publish(*s, pos + capacity());
+		return true;
+	}
+
+	/* blocking; wait for a free slot or an element */
+
+	void push(const T &value) { emplace(value); }
+
+	void push(T &&value) { emplace(std::move(value)); }
+
+	template <typename... Args> void emplace(Args &&...args) {
+		if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+			emplace(T(std::forward<Args>(args)...));
+		} else {
+			size_type pos = tail.fetch_add(1, std::memory_order_relaxed);
+			slot &s       = slots[pos & mask];
+			wait_for(s, pos);
+			::new (static_cast<void *>(s.storage))
+			    T(std::forward<Args>(args)...);
+			publish(s, pos + 1);
+		}
+	}
+
+	void pop(T &out) {
+		size_type pos = head.fetch_add(1, std::memory_order_relaxed);
+		slot &s       = slots[pos & mask];
+		wait_for(s, pos + 1);
+		take(s, out);
+		publish(s, pos + capacity());
+	}
+
+	/*
+	 * Batches: claim as many consecutive slots as are ready, up to n, with a
+	 * single CAS, then fill or drain them. Return how many were moved; 0
+	 * means full or empty.
+	 */
+
+	size_type try_push_n(const T *src, size_type n) {
+		if constexpr (!std::is_nothrow_copy_constructible_v<T>) {
+			size_type done = 0;
+			while (done < n && try_push(src[done]))
+				++done;
+			return done;
+		} else {
+			auto [pos, count] = claim(tail, n, 0);
+			for (size_type i = 0; i < count; ++i) {
+				slot &s = slots[(pos + i) & mask];
+				::new (static_cast<void *>(s.storage)) T(src[i]);
+				publish(s, pos + i + 1);
+			}
+			return count;
+		}
+	}
+
+	size_type try_pop_n(T *dst, size_type n) {
+		auto [pos, count] = claim(head, n, 1);
+		for (size_type i = 0; i < count; ++i) {
+			slot &s = slots[(pos + i) & mask];
+			take(s, dst[i]);
+			publish(s, pos + i + capacity());
+		}
+		return count;
+	}
+
+private:
+	void init(size_type cap) {
+		mask = cap - 1;
+		for (size_type i = 0; i < cap; ++i)
+			slots[i].seq = i;
+	}
+
+	static std::atomic_ref<size_type> seq_ref(slot &s) {
+		return std::atomic_ref<size_type>(s.seq);
+	}
+
+	static size_type seq_of(slot &s) {
+		return seq_ref(s).load(std::memory_order_acquire);
+	}
+
+	static void take(slot &s, T &out) {
+		T *elem = s.elem();
+		out     = std::move(*elem);
+		elem->~T();
+	}
+
+	/*
+	 * The stores of seq and parked and the loads of the other side are all
+	 * seq_cst: either the waiter's last look at the slot sees the new number,
+	 * or we see its flag. Only a slot someone parked on costs a notify.
+	 */
+	void publish(slot &s, size_type seq) {
+		seq_ref(s).store(seq, std::memory_order_seq_cst);
+		std::atomic_ref<std::uint32_t> parked(s.parked);
+		if (parked.load(std::memory_order_seq_cst) &&
+		    parked.exchange(0, std::memory_order_seq_cst))
+			seq_ref(s).notify_all();
+	}
+
+	void wait_for(slot &s, size_type want) {
+		auto seq = seq_ref(s);
+		for (int spin = 0; spin < 64; ++spin) {
+			if (seq.load(std::memory_order_acquire) == want)
+				return;
+			detail::cpu_relax();
+		}
+		// a publish clears the flag for everyone it wakes; set it again
+		// before every sleep
+		std::atomic_ref<std::uint32_t> parked(s.parked);
+		for (;;) {
+			parked.store(1, std::memory_order_seq_cst);
+			size_type cur = seq.load(std::memory_order_seq_cst);
+			if (cur == want)
+				return;
+			seq.wait(cur, std::memory_order_acquire);
+		}
+	}
+
+	// claim up to n consecutive positions whose slots read pos + ahead
+	std::pair<size_type, size_type> claim(std::atomic<size_type> &counter,
+	                                      size_type n, size_type ahead) {
+		n             = std::min(n, capacity());
+		size_type pos = counter.load(std::memory_order_relaxed);
+		for (;;) {
+			size_type count = 0;
+			while (count < n &&
+			       seq_of(slots[(pos + count) & mask]) == pos + count + ahead)
+				++count;
+			if (count == 0) {
+				std::ptrdiff_t diff = std::ptrdiff_t(
+				    seq_of(slots[pos & mask]) - (pos + ahead));
+				if (diff < 0 || n == 0)
+					return {pos, 0};
+				pos = counter.load(std::memory_order_relaxed);
+			} else if (counter.compare_exchange_weak(
+			               pos, pos + count, std::memory_order_relaxed)) {
+				return {pos, count};
+			}
+		}
+	}
+
+	alignas(cache_line) std::atomic<size_type> tail{0};
+	alignas(cache_line) std::atomic<size_type> head{0};
+	size_type mask = 0;
+	slots_type slots;
+};
+
+} // namespace tp
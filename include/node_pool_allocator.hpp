@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace tp {
+
+/*
+ * Slab pool for the fixed-size nodes of list, map and similar containers.
+ *
+ * Memory is taken from the heap in slabs of slab_bytes and carved into
+ * nodes by bumping a pointer; a freed node goes onto an intrusive free list
+ * of its size class (16-byte steps up to max_node_size) and is handed out
+ * again before the slab is touched. Slabs are only returned when the pool
+ * is destroyed, all at once.
+ *
+ * A pool made with shards == 0 does no locking and belongs to one thread at
+ * a time. With shards > 0 it is thread-safe: every thread keeps a cache of
+ * free nodes per size class and only goes to the pool to refill or drain
+ * it, batch nodes at a time. The pool itself is split into that many
+ * shards, each with its own free lists, slabs and mutex, and a thread
+ * always refills from and drains to the shard its id hashes to. A node
+ * freed by another thread simply joins that thread's cache.
+ *
+ * The caches hold a weak reference to the pool and give their nodes back
+ * when the thread exits, so a shared pool has to be owned by a shared_ptr;
+ * otherwise every call goes to the shard.
+ */
+class node_pool : public std::enable_shared_from_this<node_pool> {
+public:
+	static constexpr std::size_t max_node_size = 256;
+	static constexpr std::size_t node_align    = 16;
+
+	explicit node_pool(std::size_t shards     = 0,
+	                   std::size_t slab_bytes = std::size_t(64) << 10,
+	                   std::size_t batch      = 32)
+	    : nshards(shards ? shards : 1), locked(shards != 0),
+	      slab_bytes(std::max<std::size_t>(slab_bytes, 4096)),
+	      batch(std::max<std::size_t>(batch, 1)), id(next_id()),
+	      parts(new shard[nshards]) {}
+
+	node_pool(const node_pool &)            = delete;
+	node_pool &operator=(const node_pool &) = delete;
+
+	~node_pool() {
+		for (std::size_t i = 0; i < nshards; ++i) {
+			for (slab *s = parts[i].slabs; s;) {
+				slab *next = s->next;
+				::operator delete(s, std::align_val_t(node_align));
+				s = next;
+			}
+		}
+	}
+
+	// size <= max_node_size
+	void *allocate(std::size_t size) {
+		std::size_t cls = size_class(size);
+		if (!locked)
+			return parts[0].allocate(cls, slab_bytes);
+		cache *c = my_cache();
+		if (!c) {
+			shard &sh = my_shard();
+			std::lock_guard lock(sh.mtx);
+			return sh.allocate(cls, slab_bytes);
+		}
+		if (!c->free[cls])
+			refill(*c, cls);
+		--c->count[cls];
+		return pop(c->free[cls]);
+	}
+
+	void deallocate(void *p, std::size_t size) {
+		std::size_t cls = size_class(size);
+		if (!locked)
+			return push(parts[0].free[cls], p);
+		cache *c = my_cache();
+		if (!c) {
+			shard &sh = my_shard();
+			std::lock_guard lock(sh.mtx);
+			return push(sh.free[cls], p);
+		}
+		push(c->free[cls], p);
+		if (++c->count[cls] > 2 * batch)
+			drain(*c, cls, batch);
+	}
+
+	bool thread_safe() const { return locked; }
+
+	std::size_t slab_size() const { return slab_bytes; }
+
+	// bytes taken from the heap so far
+	std::size_t reserved() const {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < nshards; ++i) {
+			std::unique_lock lock(parts[i].mtx, std::defer_lock);
+			if (locked)
+				lock.lock();
+			total += parts[i].nslabs * slab_bytes;
+		}
+		return total;
+	}
+
+private:
+	static constexpr std::size_t classes = max_node_size / node_align;
+	static constexpr std::size_t ways    = 4; // pools cached per thread
+
+	struct free_node {
+		free_node *next;
+	};
+
+	struct slab {
+		slab *next;
+	};
+
+	static void push(free_node *&list, void *p) {
+		free_node *n = static_cast<free_node *>(p);
+		n->next      = list;
+		list         = n;
+	}
+
+	static void *pop(free_node *&list) {
+		free_node *n = list;
+		list         = n->next;
+		return n;
+	}
+
+	struct alignas(64) shard {
+		mutable std::mutex mtx;
+		free_node *free[classes] = {};
+		char *bump               = nullptr;
+		char *bump_end           = nullptr;
+		slab *slabs              = nullptr;
+		std::size_t nslabs       = 0;
+
+		void *allocate(std::size_t cls, std::size_t slab_bytes) {
+			if (free[cls])
+				return pop(free[cls]);
+			std::size_t size = (cls + 1) * node_align;
+			if (std::size_t(bump_end - bump) < size)
+				new_slab(slab_bytes);
+			void *p = bump;
+			bump += size;
+			return p;
+		}
+
+		// the tail of the old slab is dropped; it is at most one node
+		void new_slab(std::size_t bytes) {
+			void *raw = ::operator new(bytes, std::align_val_t(node_align));
+			slab *s   = static_cast<slab *>(raw);
+			s->next   = slabs;
+			slabs     = s;
+			++nslabs;
+			bump     = static_cast<char *>(raw) + node_align;
+			bump_end = static_cast<char *>(raw) + bytes;
+		}
+	};
+
+	// one thread's free nodes of one pool
+	struct cache {
+		std::uint64_t pool_id = 0;
+		std::weak_ptr<node_pool> owner;
+		free_node *free[classes]   = {};
+		std::size_t count[classes] = {};
+	};
+
+	struct thread_caches {
+		cache entries[ways];
+
+		~thread_caches() {
+			for (cache &c : entries)
+				release(c);
+		}
+	};
+
+	static std::uint64_t next_id() {
+		static std::atomic<std::uint64_t> last{0};
+		return last.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	static std::size_t size_class(std::size_t size) {
+		return (size + node_align - 1) / node_align - 1;
+	}
+
+	shard &my_shard() {
+		if (nshards == 1)
+			return parts[0];
+		thread_local std::size_t h =
+		    std::hash<std::thread::id>()(std::this_thread::get_id());
+		return parts[h % nshards];
+	}
+
+	/*
+	 * The calling thread's cache for this pool, found by id since a dead
+	 * pool's address may be reused. On a miss the least recently added way
+	 * gives its nodes back to its pool, if that is still alive.
+	 */
+	cache *my_cache() {
+		thread_local thread_caches tc;
+		for (cache &c : tc.entries)
+			if (c.pool_id == id)
+				return &c;
+
+		std::weak_ptr<node_pool> self = weak_from_this();
+		if (self.expired())
+			return nullptr;
+		release(tc.entries[ways - 1]);
+		for (std::size_t i = ways - 1; i > 0; --i)
+			tc.entries[i] = std::move(tc.entries[i - 1]);
+		tc.entries[0]         = cache{};
+		tc.entries[0].pool_id = id;
+		tc.entries[0].owner   = std::move(self);
+		return &tc.entries[0];
+	}
+
+	static void release(cache &c) {
+		if (std::shared_ptr<node_pool> pool = c.owner.lock())
+			for (std::size_t cls = 0; cls < classes; ++cls)
+				pool->drain(c, cls, c.count[cls]);
+		c = cache{};
+	}
+
+	void refill(cache &c, std::size_t cls) {
+		shard &sh = my_shard();
+		std::lock_guard lock(sh.mtx);
+		for (std::size_t i = 0; i < batch; ++i)
+			push(c.free[cls], sh.allocate(cls, slab_bytes));
+		c.count[cls] += batch;
+	}
+
+	void drain(cache &c, std::size_t cls, std::size_t n) {
+		if (n == 0)
+			return;
+		// unhook n nodes from the cache, then splice them in under the lock
+		free_node *first = c.free[cls];
+		free_node *last  = first;
+		for (std::size_t i = 1; i < n; ++i)
+			last = last->next;
+		c.free[cls] = last->next;
+		c.count[cls] -= n;
+
+		shard &sh = my_shard();
+		std::lock_guard lock(sh.mtx);
+		last->next   = sh.free[cls];
+		sh.free[cls] = first;
+	}
+
+	std::size_t nshards;
+	bool locked;
+	std::size_t slab_bytes;
+	std::size_t batch;
+	std::uint64_t id;
+	std::unique_ptr<shard[]> parts;
+};
+
+/*
+ * Allocator handing out single objects from a shared node_pool; anything
+ * else (arrays, over-aligned or large types) goes to std::allocator.
+ *
+ * A default-constructed allocator creates a private unlocked pool, so a
+ * container built with one owns its pool and releases every slab in one go
+ * when it is destroyed. Pass a pool explicitly to share it between
+ * containers or threads. Copies and rebinds share the pool; allocators
+ * compare equal when they do. A container copy is the exception: the copy
+ * of a container on an unlocked pool gets a private pool of its own, as
+ * the two may then be used from different threads.
+ */
+template <typename T> class node_pool_allocator {
+public:
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using is_always_equal = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap            = std::true_type;
+
+	node_pool_allocator() : pool(std::make_shared<node_pool>()) {}
+
+	explicit node_pool_allocator(std::shared_ptr<node_pool> pool)
+	    : pool(std::move(pool)) {}
+
+	// no move constructor: a moved-from container must still allocate
+	node_pool_allocator(const node_pool_allocator &) = default;
+
+	template <typename U>
+	node_pool_allocator(const node_pool_allocator<U> &other)
+	    : pool(other.pool) {}
+
+	node_pool_allocator &operator=(const node_pool_allocator &) = default;
+
+	T *allocate(size_type n) {
+		if (!pooled(n))
+			return std::allocator<T>().allocate(n);
+		return static_cast<T *>(pool->allocate(sizeof(T)));
+	}
+
+	void deallocate(T *p, size_type n) {
+		if (!pooled(n))
+			return std::allocator<T>().deallocate(p, n);
+		pool->deallocate(p, sizeof(T));
+	}
+
+	node_pool_allocator select_on_container_copy_construction() const {
+		if (pool->thread_safe())
+			return *this;
+		return node_pool_allocator(
+		    std::make_shared<node_pool>(0, pool->slab_size()));
+	}
+
+	const std::shared_ptr<node_pool> &resource() const { return pool; }
+
+	template <typename U>
+	friend bool operator==(const node_pool_allocator &a,
+	                       const node_pool_allocator<U> &b) {
+		return a.pool == b.resource();
+	}
+
+private:
+	template <typename> friend class node_pool_allocator;
+
+	static bool pooled(size_type n) {
+		return n == 1 && sizeof(T) <= node_pool::max_node_size &&
+		       alignof(T) <= node_pool::node_align;
+	}
+
+	std::shared_ptr<node_pool> pool;
+};
+
+} // namespace tp
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+#include <segmented.hpp>
+#include <thread_pool.hpp>
+#include <work_stealing_pool.hpp>
+
+/*
+ * Parallel algorithms over random access ranges.
+ *
+ * The range is cut into chunks that run on a tp::thread_pool (the shared
+ * thread_pool::instance() unless one is passed in). Inside a chunk,
+ * deque ranges are walked block by block over raw pointers
+ * (tp::for_each_segment), so the per-element node checks of
+ * deque_iterator::operator++ drop out of the inner loop.
+ */
+namespace tp {
+
+namespace detail {
+
+// chunks below this many elements are not worth a task
+inline constexpr std::ptrdiff_t parallel_grain = 4096;
+
+// how many chunks to cut n elements into
+inline std::size_t chunk_count(std::ptrdiff_t n, const thread_pool &pool) {
+	// a few chunks per thread so a slow one does not hold up the rest
+	std::size_t chunks = pool.concurrency() * 4;
+	std::size_t most   = std::max<std::ptrdiff_t>(n / parallel_grain, 1);
+	return std::min(chunks, most);
+}
+
+// run fn(chunk_first, chunk_last, offset) over about equal chunks
+template <typename It, typename Fn>
+void parallel_chunks(It first, It last, thread_pool &pool, Fn &&fn) {
+	const std::ptrdiff_t n = last - first;
+	if (n <= 0)
+		return;
+	const std::size_t chunks = chunk_count(n, pool);
+	pool.run(chunks, [&](std::size_t i) {
+		std::ptrdiff_t lo = n * i / chunks;
+		std::ptrdiff_t hi = n * (i + 1) / chunks;
+		fn(first + lo, first + hi, lo);
+	});
+}
+
+/*
+ * Split the stable merge of [a, a + na) and [b, b + nb) at output position
+ * k: returns i such that the first k merged elements are a[0, i) and
+ * b[0, k - i). Ties go to a.
+ */
+template <typename It1, typename It2, typename Compare>
+std::ptrdiff_t merge_split(It1 a, std::ptrdiff_t na, It2 b, std::ptrdiff_t nb,
+                           std::ptrdiff_t k, Compare &comp) {
+	std::ptrdiff_t lo = std::max<std::ptrdiff_t>(0, k - nb);
+	std::ptrdiff_t hi = std::min(k, na);
+	while (lo < hi) {
+		std::ptrdiff_t i = lo + (hi - lo) / 2;
+		std::ptrdiff_t j = k - i;
+		if (j > 0 && !comp(b[j - 1], a[i]))
+			lo = i + 1;
+		else
+			hi = i;
+	}
+	return lo;
+}
+
+/*
+ * std::merge through moves. std::move_iterator is not an option, the tp
+ * iterators only dereference as non-const.
+ */
+template <typename It1, typename It2, typename Out, typename Compare>
+Out move_merge(It1 a, It1 a_last, It2 b, It2 b_last, Out out,
+               Compare &comp) {
+	while (a != a_last && b != b_last) {
+		if (comp(*b, *a))
+			*out = std::move(*b), ++b;
+		else
+			*out = std::move(*a), ++a;
+		++out;
+	}
+	out = std::move(a, a_last, out);
+	return std::move(b, b_last, out);
+}
+
+/*
+ * One merge pass: sorted runs of length `run` in src are merged pairwise
+ * into dst. Every pair is cut into pieces by merge_split, so the last
+ * passes, with fewer pairs than threads, still use the whole pool. All
+ * split points are found before any element is moved from.
+ */
+template <typename Src, typename Dst, typename Compare>
+void merge_pass(Src src, Dst dst, std::ptrdiff_t n, std::ptrdiff_t run,
+                thread_pool &pool, Compare &comp) {
+	const std::size_t pairs = (n + 2 * run - 1) / (2 * run);
+	const std::size_t pieces =
+	    std::max<std::size_t>(chunk_count(n, pool) / pairs, 1);
+	const std::size_t tasks = pairs * pieces;
+
+	auto bounds = [&](std::size_t t, std::ptrdiff_t &lo, std::ptrdiff_t &mid,
+	                  std::ptrdiff_t &hi) {
+		lo  = 2 * run * std::ptrdiff_t(t / pieces);
+		mid = std::min(lo + run, n);
+		hi  = std::min(lo + 2 * run, n);
+	};
+
+	// splits[t] is where in the first run of its pair task t starts
+	std::unique_ptr<std::ptrdiff_t[]> splits(new std::ptrdiff_t[tasks]);
+	pool.run(tasks, [&](std::size_t t) {
+		std::ptrdiff_t lo, mid, hi;
+		bounds(t, lo, mid, hi);
+		std::ptrdiff_t k = (hi - lo) * std::ptrdiff_t(t % pieces) / pieces;
+		splits[t] = merge_split(src + lo, mid - lo, src + mid, hi - mid, k,
+		                        comp);
+	});
+
+	pool.run(tasks, [&](std::size_t t) {
+		std::ptrdiff_t lo, mid, hi;
+		bounds(t, lo, mid, hi);
+		std::size_t q     = t % pieces;
+		std::ptrdiff_t k0 = (hi - lo) * std::ptrdiff_t(q) / pieces;
+		std::ptrdiff_t k1 = (hi - lo) * std::ptrdiff_t(q + 1) / pieces;
+		std::ptrdiff_t i0 = splits[t];
+		std::ptrdiff_t i1 = q + 1 < pieces ? splits[t + 1] : mid - lo;
+		move_merge(src + lo + i0, src + lo + i1, src + mid + (k0 - i0),
+		           src + mid + (k1 - i1), dst + lo + k0, comp);
+	});
+}
+
+} // namespace detail
+
+// call f on every element of [first, last)
+template <typename RandomIt, typename UnaryFunc>
+void parallel_for_each(RandomIt first, RandomIt last, UnaryFunc f,
+                       thread_pool &pool = thread_pool::instance()) {
+	detail::parallel_chunks(first, last, pool,
+	                        [&](RandomIt lo, RandomIt hi, std::ptrdiff_t) {
+		                        tp::for_each_segment(
+		                            lo, hi, [&](auto seg_lo, auto seg_hi) {
+			                            std::for_each(seg_lo, seg_hi, f);
+		                            });
+	                        });
+}
+
+// d_first[i] = op(first[i]); the output may alias the input
+template <typename RandomIt, typename OutIt, typename UnaryOp>
+OutIt parallel_transform(RandomIt first, RandomIt last, OutIt d_first,
+                         UnaryOp op,
+                         thread_pool &pool = thread_pool::instance()) {
+	detail::parallel_chunks(
+	    first, last, pool, [&](RandomIt lo, RandomIt hi, std::ptrdiff_t off) {
+		    OutIt out = d_first + off;
+		    tp::for_each_segment(lo, hi, [&](auto seg_lo, auto seg_hi) {
+			    out = std::transform(seg_lo, seg_hi, out, op);
+		    });
+	    });
+	return d_first + (last - first);
+}
+
+/*
+ * Merge sort: chunks are sorted with std::sort in parallel, then merged in
+ * log2(chunks) passes, each split across the whole pool. Needs a buffer of
+ * last - first elements; not stable.
+ */
+template <typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp = Compare(),
+                   thread_pool &pool = thread_pool::instance()) {
+	using T = typename std::iterator_traits<RandomIt>::value_type;
+	const std::ptrdiff_t n   = last - first;
+	const std::size_t chunks = n > 0 ? detail::chunk_count(n, pool) : 1;
+	if (chunks == 1 || pool.concurrency() == 1) {
+		std::sort(first, last, comp);
+		return;
+	}
+
+	// runs of equal length (the last one shorter) so merge pairs line up
+	const std::ptrdiff_t run0 = (n + chunks - 1) / chunks;
+	pool.run((n + run0 - 1) / run0, [&](std::size_t i) {
+		std::ptrdiff_t lo = run0 * i;
+		std::sort(first + lo, first + std::min(lo + run0, n), comp);
+	});
+
+	std::allocator<T> alloc;
+	T *buf = alloc.allocate(n);
+	detail::parallel_chunks(first, last, pool,
+	                        [&](RandomIt lo, RandomIt hi, std::ptrdiff_t off) {
+		                        for (T *dst = buf + off; lo != hi; ++lo, ++dst)
+			                        std::construct_at(dst, std::move(*lo));
+	                        });
+
+	bool in_buf = true;
+	for (std::ptrdiff_t run = run0; run < n; run *= 2, in_buf = !in_buf) {
+		if (in_buf)
+			detail::merge_pass(buf, first, n, run, pool, comp);
+		else
+			detail::merge_pass(first, buf, n, run, pool, comp);
+	}
+
+	detail::parallel_chunks(first, last, pool,
+	                        [&](RandomIt lo, RandomIt hi, std::ptrdiff_t off) {
+		                        if (in_buf)
+			                        std::move(buf + off, buf + off + (hi - lo),
+			                                  lo);
+		                        std::destroy(buf + off, buf + off + (hi - lo));
+	                        });
+	alloc.deallocate(buf, n);
+}
+
+/*
+ * Nested fork-join on a work_stealing_pool: f and g may run in parallel,
+ * and may themselves call parallel_invoke/parallel_for.
+ */
+template <typename F, typename G>
+void parallel_invoke(F &&f, G &&g,
+                     work_stealing_pool &pool = work_stealing_pool::instance()) {
+	pool.invoke(std::forward<F>(f), std::forward<G>(g));
+}
+
+namespace detail {
+
+template <typename It, typename Fn>
+void parallel_for_split(It first, It last, Fn &fn, std::ptrdiff_t grain,
+                        work_stealing_pool &pool) {
+	std::ptrdiff_t n = last - first;
+	if (n <= grain) {
+		for (; first != last; ++first)
+			fn(first);
+		return;
+	}
+	It mid = first + n / 2;
+	pool.invoke([&] { parallel_for_split(first, mid, fn, grain, pool); },
+	            [&] { parallel_for_split(mid, last, fn, grain, pool); });
+}
+
+} // namespace detail
+
+/*
+ * fn(i) for every i in [first, last), integers or random access iterators.
+ * The range is halved recursively down to grain elements and the halves
+ * are forked, so idle workers steal big pieces first. grain 0 picks about
+ * eight pieces per thread.
+ */
+template <typename It, typename Fn>
+void parallel_for(It first, It last, Fn fn, std::ptrdiff_t grain = 0,
+                  work_stealing_pool &pool = work_stealing_pool::instance()) {
+	if (grain <= 0)
+		grain = std::max<std::ptrdiff_t>(
+		    (last - first) / std::ptrdiff_t(pool.concurrency() * 8), 1);
+	detail::parallel_for_split(first, last, fn, grain, pool);
+}
+
+} // namespace tp
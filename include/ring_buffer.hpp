@@ -0,0 +1,510 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <iterator.hpp>
+
+namespace tp {
+
+template <typename T, typename Alloc> class ring_buffer;
+
+/*
+ * Iterator over a ring_buffer. It holds an unwrapped position and masks it
+ * on every access, so begin() - 1 (rend) and end() are ordinary positions
+ * and no wrap check is needed on ++/--.
+ */
+template <typename T, bool Const> class ring_buffer_iterator {
+	template <typename, typename> friend class ring_buffer;
+	template <typename, bool> friend class ring_buffer_iterator;
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = T;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = std::conditional_t<Const, const T *, T *>;
+	using reference         = std::conditional_t<Const, const T &, T &>;
+
+	ring_buffer_iterator() : buf(), mask(0), pos(0) {}
+
+	// iterator -> const_iterator
+	template <bool C>
+	requires(Const && !C)
+	ring_buffer_iterator(const ring_buffer_iterator<T, C> &it)
+	    : buf(it.buf), mask(it.mask), pos(it.pos) {}
+
+	reference operator*() const { return buf[pos & mask]; }
+
+	pointer operator->() const { return buf + (pos & mask); }
+
+	reference operator[](difference_type n) const {
+		return buf[(pos + n) & mask];
+	}
+
+	ring_buffer_iterator &operator++() {
+		++pos;
+		return *this;
+	}
+
+	ring_buffer_iterator operator++(int) {
+		ring_buffer_iterator tmp = *this;
+		++pos;
+		return tmp;
+	}
+
+	ring_buffer_iterator &operator--() {
+		--pos;
+		return *this;
+	}
+
+	ring_buffer_iterator operator--(int) {
+		ring_buffer_iterator tmp = *this;
+		--pos;
+		return tmp;
+	}
+
+	ring_buffer_iterator &operator+=(difference_type n) {
+		pos += n;
+		return *this;
+	}
+
+	ring_buffer_iterator &operator-=(difference_type n) {
+		pos -= n;
+		return *this;
+	}
+
+	friend ring_buffer_iterator operator+(ring_buffer_iterator it,
+	                                      difference_type n) {
+		return it += n;
+	}
+
+	friend ring_buffer_iterator operator+(difference_type n,
+	                                      ring_buffer_iterator it) {
+		return it += n;
+	}
+
+	friend ring_buffer_iterator operator-(ring_buffer_iterator it,
+	                                      difference_type n) {
+		return it -= n;
+	}
+
+	// positions are unwrapped counters, compare them by their distance
+	friend difference_type operator-(const ring_buffer_iterator &lhs,
+	                                 const ring_buffer_iterator &rhs) {
+		return difference_type(lhs.pos - rhs.pos);
+	}
+
+	friend bool operator==(const ring_buffer_iterator &lhs,
+	                       const ring_buffer_iterator &rhs) {
+		return lhs.pos == rhs.pos;
+	}
+
+	friend std::strong_ordering operator<=>(const ring_buffer_iterator &lhs,
+	                                        const ring_buffer_iterator &rhs) {
+		return (lhs - rhs) <=> 0;
+	}
+
+private:
+	using elem_pointer = T *;
+
+	ring_buffer_iterator(elem_pointer b, std::size_t m, std::size_t p)
+	    : buf(b), mask(m), pos(p) {}
+
+	elem_pointer buf;
+	std::size_t mask;
+	std::size_t pos;
+};
+
+/*
+ * A bounded double-ended queue in one power-of-two array.
+ *
+ * Element i is at buf[(head + i) & mask], so there is no block map and no
+ * per-access division. The queue part of the deque interface is kept
+ * (push/pop/emplace at both ends, front, back, operator[], at, iterators,
+ * clear, resize, append_range) so a bounded queue can switch between the two
+ * with a typedef; there is no insert or erase in the middle.
+ *
+ * The capacity is fixed at construction, rounded up to a power of two. When
+ * the buffer is full a push throws std::length_error, unless the buffer was
+ * made with overflow::overwrite, in which case push_back drops the oldest
+ * element (front) and push_front the newest (back). try_push_back and
+ * try_push_front report a full buffer by returning false instead.
+ *
+ * push_back_n and pop_front_n move a batch in at most two pieces, with
+ * memcpy for trivially copyable T.
+ */
+template <typename T, typename Alloc = std::allocator<T>> class ring_buffer {
+	using alloc_traits = std::allocator_traits<Alloc>;
+
+public:
+	using value_type      = T;
+	using allocator_type  = Alloc;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T &;
+	using const_reference = const T &;
+	using pointer         = T *;
+	using const_pointer   = const T *;
+
+	using iterator               = ring_buffer_iterator<T, false>;
+	using const_iterator         = ring_buffer_iterator<T, true>;
+	using reverse_iterator       = tp::reverse_iterator<iterator>;
+	using const_reverse_iterator = tp::reverse_iterator<const_iterator>;
+
+	enum class overflow { reject, overwrite };
+
+	ring_buffer() : alloc{} {}
+
+	explicit ring_buffer(size_type capacity, overflow mode = overflow::reject,
+	                     const Alloc &_alloc = Alloc())
+	    : alloc(_alloc), overwrite(mode == overflow::overwrite) {
+		if (capacity) {
+			cap  = std::bit_ceil(capacity);
+			mask = cap - 1;
+			buf  = alloc_traits::allocate(alloc, cap);
+		}
+	}
+
+	ring_buffer(size_type capacity, std::initializer_list<T> init,
+	            overflow mode = overflow::reject)
+	    : ring_buffer(std::max(capacity, init.size()), mode) {
+		for (const T &elem : init)
+			emplace_back(elem);
+	}
+
+	// copy ctor
+	ring_buffer(const ring_buffer &other)
+	    : ring_buffer(other.cap, other.mode(),
+	                  alloc_traits::select_on_container_copy_construction(
+	                      other.alloc)) {
+		for (const T &elem : other)
+			emplace_back(elem);
+	}
+
+	// move ctor, steals the array
+	ring_buffer(ring_buffer &&other)
+	    : alloc(std::move(other.alloc)), buf(other.buf), cap(other.cap),
+	      mask(other.mask), head(other.head), sz(other.sz),
+	      overwrite(other.overwrite) {
+		other.buf = nullptr;
+		other.cap = other.mask = other.head = other.sz = 0;
+	}
+
+	~ring_buffer() {
+		clear();
+		if (buf)
+			alloc_traits::deallocate(alloc, buf, cap);
+	}
+
+	ring_buffer &operator=(const ring_buffer &other) {
+		if (this != &other) {
+			ring_buffer tmp(other);
+			swap(tmp);
+		}
+		return *this;
+	}
+
+	ring_buffer &operator=(ring_buffer &&other) {
+		if (this != &other) {
+			ring_buffer tmp(std::move(other));
+			swap(tmp);
+		}
+		return *this;
+	}
+
+	reference at(size_type pos) {
+		if (pos >= sz)
+			throw std::out_of_range("out of range");
+		return (*this)[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		if (pos >= sz)
+			throw std::out_of_range("out of range");
+		return (*this)[pos];
+	}
+
+	reference operator[](size_type pos) { return buf[(head + pos) & mask]; }
+
+	const_reference operator[](size_type pos) const {
+		return buf[(head + pos) & mask];
+	}
+
+	reference front() { return buf[head & mask]; }
+
+	const_reference front() const { return buf[head & mask]; }
+
+	reference back() { return buf[(head + sz - 1) & mask]; }
+
+	const_reference back() const { return buf[(head + sz - 1) & mask]; }
+
+	iterator begin() { return iterator(buf, mask, head); }
+
+	const_iterator begin() const { return const_iterator(buf, mask, head); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(buf, mask, head + sz); }
+
+	const_iterator end() const { return const_iterator(buf, mask, head + sz); }
+
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(end() - 1); }
+
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(end() - 1);
+	}
+
+	const_reverse_iterator crbegin() const { return rbegin(); }
+
+	reverse_iterator rend() { return reverse_iterator(begin() - 1); }
+
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(begin() - 1);
+	}
+
+	const_reverse_iterator crend() const { return rend(); }
+
+	bool empty() const { return sz == 0; }
+
+	bool full() const { return sz == cap; }
+
+	size_type size() const { return sz; }
+
+	size_type capacity() const { return cap; }
+
+	size_type max_size() const { return cap; }
+
+	overflow mode() const {
+		return overwrite ? overflow::overwrite : overflow::reject;
+	}
+
+	void set_mode(overflow m) { overwrite = m == overflow::overwrite; }
+
+	void clear() {
+		destroy_front(sz);
+		head = 0;
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		T *slot = buf + ((head + sz) & mask);
+		if (sz == cap) {
+			// the new back goes where the front was
+			check_overwrite();
+			replace(slot, std::forward<Args>(args)...);
+			++head;
+			return *slot;
+		}
+		alloc_traits::construct(alloc, slot, std::forward<Args>(args)...);
+		++sz;
+		return *slot;
+	}
+
+	void push_front(const T &value) { emplace_front(value); }
+
+	void push_front(T &&value) { emplace_front(std::move(value)); }
+
+	template <typename... Args> reference emplace_front(Args &&...args) {
+		T *slot = buf + ((head - 1) & mask);
+		if (sz == cap) {
+			// and the new front where the back was
+			check_overwrite();
+			replace(slot, std::forward<Args>(args)...);
+			--head;
+			return *slot;
+		}
+		alloc_traits::construct(alloc, slot, std::forward<Args>(args)...);
+		--head, ++sz;
+		return *slot;
+	}
+
+	// false if the buffer is full, whatever the overflow mode
+	template <typename U> bool try_push_back(U &&value) {
+		if (sz == cap)
+			return false;
+		emplace_back(std::forward<U>(value));
+		return true;
+	}
+
+	template <typename U> bool try_push_front(U &&value) {
+		if (sz == cap)
+			return false;
+		emplace_front(std::forward<U>(value));
+		return true;
+	}
+
+	void pop_front() {
+		alloc_traits::destroy(alloc, buf + (head & mask));
+		++head, --sz;
+	}
+
+	void pop_back() {
+		--sz;
+		alloc_traits::destroy(alloc, buf + ((head + sz) & mask));
+	}
+
+	void resize(size_type count) {
+		while (sz > count)
+			pop_back();
+		while (sz < count)
+			emplace_back();
+	}
+
+	void resize(size_type count, const T &value) {
+		while (sz > count)
+			pop_back();
+		while (sz < count)
+			emplace_back(value);
+	}
+
+	/*
+	 * Append src[0, n). Returns how many were appended: all n in overwrite
+	 * mode (only the last capacity() of them survive), otherwise as many as
+	 * there is room for.
+	 */
+	size_type push_back_n(const T *src, size_type n);
+
+	// move up to n elements from the front to dst; returns how many
+	size_type pop_front_n(T *dst, size_type n);
+
+	template <std::ranges::input_range Range>
+	requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	void append_range(Range &&rg) {
+		if constexpr (std::ranges::contiguous_range<Range> &&
+		              std::ranges::sized_range<Range> &&
+		              std::is_same_v<std::ranges::range_value_t<Range>, T>) {
+			size_type n = std::ranges::size(rg);
+			if (!overwrite && n > cap - sz)
+				throw_full();
+			push_back_n(std::ranges::data(rg), n);
+		} else {
+			for (auto &&elem : rg)
+				emplace_back(std::forward<decltype(elem)>(elem));
+		}
+	}
+
+	void swap(ring_buffer &other) {
+		using std::swap;
+		if constexpr (alloc_traits::propagate_on_container_swap::value)
+			swap(alloc, other.alloc);
+		swap(buf, other.buf);
+		swap(cap, other.cap);
+		swap(mask, other.mask);
+		swap(head, other.head);
+		swap(sz, other.sz);
+		swap(overwrite, other.overwrite);
+	}
+
+	allocator_type get_allocator() const { return alloc; }
+
+private:
+	[[noreturn, gnu::cold]] static void throw_full() {
+		throw std::length_error("ring_buffer: full");
+	}
+
+	void check_overwrite() const {
+		if (!overwrite || cap == 0)
+			throw_full();
+	}
+
+	// args may refer to the element in slot: build the new one first
+	template <typename... Args> void replace(T *slot, Args &&...args) {
+		T tmp(std::forward<Args>(args)...);
+		alloc_traits::destroy(alloc, slot);
+		alloc_traits::construct(alloc, slot, std::move(tmp));
+	}
+
+	void destroy_front(size_type n) {
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			for (size_type i = 0; i < n; ++i)
+				alloc_traits::destroy(alloc, buf + ((head + i) & mask));
+		}
+		head += n, sz -= n;
+	}
+
+	// length of the part of [first, first + n) before the array wraps
+	size_type first_run(size_type first, size_type n) const {
+		return std::min(n, cap - (first & mask));
+	}
+
+	Alloc alloc;
+	T *buf         = nullptr;
+	size_type cap  = 0;
+	size_type mask = 0;
+	size_type head = 0;
+	size_type sz   = 0;
+	bool overwrite = false;
+};
+
+template <typename T, typename Alloc>
+auto ring_buffer<T, Alloc>::push_back_n(const T *src, size_type n)
+    -> size_type {
+	if (cap == 0)
+		return 0;
+	const size_type total = n;
+	if (overwrite) {
+		// only the newest cap elements can survive
+		if (n > cap)
+			src += n - cap, n = cap;
+		if (n > cap - sz)
+			destroy_front(n - (cap - sz));
+	} else {
+		n = std::min(n, cap - sz);
+	}
+	if (n == 0)
+		return overwrite ? total : 0;
+
+	size_type tail = head + sz;
+	size_type len  = first_run(tail, n);
+	T *dst         = buf + (tail & mask);
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		std::memcpy(static_cast<void *>(dst), src, len * sizeof(T));
+		std::memcpy(static_cast<void *>(buf), src + len,
+		            (n - len) * sizeof(T));
+		sz += n;
+	} else {
+		for (size_type i = 0; i < len; ++i, ++sz)
+			alloc_traits::construct(alloc, dst + i, src[i]);
+		for (size_type i = len; i < n; ++i, ++sz)
+			alloc_traits::construct(alloc, buf + (i - len), src[i]);
+	}
+	return overwrite ? total : n;
+}
+
+template <typename T, typename Alloc>
+auto ring_buffer<T, Alloc>::pop_front_n(T *dst, size_type n) -> size_type {
+	n = std::min(n, sz);
+	if (n == 0)
+		return 0;
+	size_type len  = first_run(head, n);
+	const T *first = buf + (head & mask);
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		std::memcpy(static_cast<void *>(dst), first, len * sizeof(T));
+		std::memcpy(static_cast<void *>(dst + len), buf,
+		            (n - len) * sizeof(T));
+		destroy_front(n);
+	} else {
+		for (size_type i = 0; i < n; ++i) {
+			dst[i] = std::move(front());
+			pop_front();
+		}
+	}
+	return n;
+}
+
+} // namespace tp
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <utility>
+
+#include <algo.hpp>
+
+template <typename T, typename Ref, typename Ptr, std::size_t BlockBytes>
+class deque_iterator;
+
+/*
+ * Algorithms over segmented iterators.
+ *
+ * A segmented iterator walks a sequence of contiguous blocks, like
+ * deque_iterator. Its operator++ has to check for the end of the block on
+ * every element, which keeps loops over it from vectorizing. The overloads
+ * here run the std algorithm on one block at a time over raw pointers
+ * instead: copy of trivial types becomes one memmove per block, fill a
+ * memset, find a SIMD scan (tp::algo::find). Plain iterators go straight to
+ * the std algorithm.
+ */
+namespace tp {
+
+/*
+ * segment_traits<It> describes a segmented iterator:
+ *
+ *     segment_iterator             walks the blocks
+ *     local_iterator               walks the elements of one block
+ *     segment(it), local(it)       split an iterator
+ *     begin(seg), end(seg)         bounds of a block
+ *     compose(seg, local)          join them back into an It
+ */
+template <typename It> struct segment_traits;
+
+template <typename T, typename Ref, typename Ptr, std::size_t BlockBytes>
+struct segment_traits<deque_iterator<T, Ref, Ptr, BlockBytes>> {
+	using iterator         = deque_iterator<T, Ref, Ptr, BlockBytes>;
+	using segment_iterator = typename iterator::map_pointer;
+	using local_iterator   = Ptr;
+
+	static segment_iterator segment(const iterator &it) { return it.node; }
+
+	static local_iterator local(const iterator &it) { return it.cur; }
+
+	static local_iterator begin(segment_iterator seg) { return *seg; }
+
+	static local_iterator end(segment_iterator seg) {
+		return *seg + iterator::buffer_size();
+	}
+
+	// the end of a block is the start of the next one
+	static iterator compose(segment_iterator seg, local_iterator pos) {
+		iterator it;
+		if (pos == end(seg))
+			it.set_node(seg + 1), it.cur = it.first;
+		else
+			it.set_node(seg), it.cur = const_cast<T *>(&*pos);
+		return it;
+	}
+};
+
+template <typename It>
+concept segmented_iterator =
+    requires { typename segment_traits<It>::segment_iterator; };
+
+// call fn(local_first, local_last) for each contiguous piece of [first, last)
+template <typename It, typename Fn>
+void for_each_segment(It first, It last, Fn &&fn) {
+	if constexpr (segmented_iterator<It>) {
+		using traits = segment_traits<It>;
+		auto seg     = traits::segment(first);
+		auto seg_end = traits::segment(last);
+		if (seg == seg_end) {
+			fn(traits::local(first), traits::local(last));
+			return;
+		}
+		fn(traits::local(first), traits::end(seg));
+		for (++seg; seg != seg_end; ++seg)
+			fn(traits::begin(seg), traits::end(seg));
+		fn(traits::begin(seg_end), traits::local(last));
+	} else {
+		fn(first, last);
+	}
+}
+
+namespace detail {
+
+// copy or move the plain range [first, last) to a possibly segmented out
+template <bool Move, typename In, typename Out>
+Out copy_to_segments(In first, In last, Out out) {
+	auto step = [](auto b, auto e, auto dst) {
+		if constexpr (Move)
+			return std::move(b, e, dst);
+		else
+			return std::copy(b, e, dst);
+	};
+
+	if constexpr (segmented_iterator<Out>) {
+		using traits = segment_traits<Out>;
+		auto seg     = traits::segment(out);
+		auto pos     = traits::local(out);
+		while (first != last) {
+			auto room  = traits::end(seg) - pos;
+			auto count = last - first;
+			if (count > room)
+				count = room;
+			pos = step(first, first + count, pos);
+			first += count;
+			if (first != last)
+				++seg, pos = traits::begin(seg);
+		}
+		return traits::compose(seg, pos);
+	} else {
+		return step(first, last, out);
+	}
+}
+
+} // namespace detail
+
+template <typename InputIt, typename OutputIt>
+OutputIt copy(InputIt first, InputIt last, OutputIt d_first) {
+	for_each_segment(first, last, [&](auto b, auto e) {
+		d_first = detail::copy_to_segments<false>(b, e, d_first);
+	});
+	return d_first;
+}
+
+template <typename InputIt, typename OutputIt>
+OutputIt move(InputIt first, InputIt last, OutputIt d_first) {
+	for_each_segment(first, last, [&](auto b, auto e) {
+		d_first = detail::copy_to_segments<true>(b, e, d_first);
+	});
+	return d_first;
+}
+
+template <typename ForwardIt, typename T>
+void fill(ForwardIt first, ForwardIt last, const T &value) {
+	for_each_segment(first, last,
+	                 [&](auto b, auto e) { std::fill(b, e, value); });
+}
+
+template <typename InputIt, typename UnaryFunc>
+UnaryFunc for_each(InputIt first, InputIt last, UnaryFunc f) {
+	for_each_segment(first, last, [&](auto b, auto e) {
+		for (; b != e; ++b)
+			f(*b);
+	});
+	return f;
+}
+
+template <typename InputIt, typename T>
+InputIt find(InputIt first, InputIt last, const T &value) {
+	if constexpr (segmented_iterator<InputIt>) {
+		using traits = segment_traits<InputIt>;
+		auto seg     = traits::segment(first);
+		auto seg_end = traits::segment(last);
+		auto pos     = traits::local(first);
+		for (; seg != seg_end; ++seg, pos = traits::begin(seg)) {
+			auto hit = tp::algo::find(pos, traits::end(seg), value);
+			if (hit != traits::end(seg))
+				return traits::compose(seg, hit);
+		}
+		return traits::compose(
+		    seg, tp::algo::find(pos, traits::local(last), value));
+	} else {
+		return tp::algo::find(first, last, value);
+	}
+}
+
+template <typename InputIt, typename T>
+T accumulate(InputIt first, InputIt last, T init) {
+	for_each_segment(first, last, [&](auto b, auto e) {
+		init = std::accumulate(b, e, std::move(init));
+	});
+	return init;
+}
+
+template <typename InputIt, typename T, typename BinaryOp>
+T accumulate(InputIt first, InputIt last, T init, BinaryOp op) {
+	for_each_segment(first, last, [&](auto b, auto e) {
+		init = std::accumulate(b, e, std::move(init), op);
+	});
+	return init;
+}
+
+} // namespace tp
@@ -0,0 +1,479 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+
+#include <growth_policy.hpp>
+#include <iterator.hpp>
+#include <memory.hpp>
+#include <vector.hpp>
+
+namespace tp {
+
+/*
+ * A vector that keeps up to N elements in an inline buffer and allocates
+ * through Alloc only once it grows past N. The interface follows vector.hpp.
+ *
+ * Converting to and from vector is O(1) when the elements live on the heap:
+ * the buffer is handed over instead of copied. Inline elements are relocated.
+ */
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>,
+          typename Growth = tp::doubling_growth>
+class small_vector {
+	static_assert(N > 0, "small_vector needs at least one inline element");
+
+	using alloc_traits = std::allocator_traits<Alloc>;
+
+public:
+	using value_type      = T;
+	using allocator_type  = Alloc;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T &;
+	using const_reference = const T &;
+	using pointer         = alloc_traits::pointer;
+	using const_pointer   = alloc_traits::const_pointer;
+	using growth_policy   = Growth;
+	using vector_type     = ::vector<T, Alloc, Growth>;
+
+	using iterator       = tp::normal_iterator<pointer, small_vector>;
+	using const_iterator = tp::normal_iterator<const_pointer, small_vector>;
+	using reverse_iterator       = tp::reverse_iterator<iterator>;
+	using const_reverse_iterator = tp::reverse_iterator<const_iterator>;
+
+	small_vector() : alloc{}, sz(0), cap(N), _data(inline_data()) {}
+
+	explicit small_vector(const Alloc &_alloc)
+	    : alloc(_alloc), sz(0), cap(N), _data(inline_data()) {}
+
+	small_vector(size_type count, const T &value, const Alloc &_alloc = Alloc())
+	    : small_vector(_alloc) {
+		reserve(count);
+		for (; sz < count; ++sz)
+			alloc_traits::construct(alloc, _data + sz, value);
+	}
+
+	explicit small_vector(size_type count, const Alloc &_alloc = Alloc())
+	    : small_vector(_alloc) {
+		reserve(count);
+		for (; sz < count; ++sz)
+			alloc_traits::construct(alloc, _data + sz);
+	}
+
+	template <typename InputIt>
+	requires tp::is_iterator<InputIt>
+	small_vector(InputIt first, InputIt last, const Alloc &_alloc = Alloc())
+	    : small_vector(_alloc) {
+		insert(end(), first, last);
+	}
+
+	small_vector(std::initializer_list<T> init, const Alloc &_alloc = Alloc())
+	    : small_vector(init.begin(), init.end(), _alloc) {}
+
+	// copy ctor
+	small_vector(const small_vector &other)
+	    : small_vector(alloc_traits::select_on_container_copy_construction(
+	          other.alloc)) {
+		insert(end(), other.begin(), other.end());
+	}
+
+	/*
+	 * Move constructor.
+	 * A heap buffer is taken over, inline elements are relocated one by one.
+	 * After the move, other is empty() and back on its inline buffer.
+	 */
+	small_vector(small_vector &&other)
+	    : alloc(std::move(other.alloc)), sz(0), cap(N),
+	      _data(inline_data()) {
+		take(other);
+	}
+
+	// copy from a vector
+	explicit small_vector(const vector_type &other)
+	    : small_vector(alloc_traits::select_on_container_copy_construction(
+	          other.alloc)) {
+		reserve(other.sz);
+		for (; sz < other.sz; ++sz)
+			alloc_traits::construct(alloc, _data + sz, other._data[sz]);
+	}
+
+	// adopt the heap buffer of a vector, no element is touched
+	explicit small_vector(vector_type &&other)
+	    : alloc(std::move(other.alloc)), sz(0), cap(N),
+	      _data(inline_data()) {
+		if (other._data) {
+			_data = other._data;
+			sz    = other.sz;
+			cap   = other.cap;
+
+			other._data = nullptr;
+			other.sz    = 0;
+			other.cap   = 0;
+		}
+	}
+
+	// dtor
+	~small_vector() {
+		clear();
+		release();
+	}
+
+	small_vector &operator=(const small_vector &other) {
+		if (this != &other) {
+			clear();
+			insert(end(), other.begin(), other.end());
+		}
+		return *this;
+	}
+
+	small_vector &operator=(small_vector &&other) {
+		if (this != &other) {
+			clear();
+			release();
+			if (alloc_traits::propagate_on_container_move_assignment::value)
+				alloc = std::move(other.alloc);
+			take(other);
+		}
+		return *this;
+	}
+
+	small_vector &operator=(std::initializer_list<T> ilist) {
+		clear();
+		insert(end(), ilist);
+		return *this;
+	}
+
+	// copy into a vector
+	vector_type to_vector() const & {
+		vector_type ret;
+		ret.alloc = alloc_traits::select_on_container_copy_construction(alloc);
+		ret.reserve(sz);
+		for (; ret.sz < sz; ++ret.sz)
+			alloc_traits::construct(ret.alloc, ret._data + ret.sz,
+			                        _data[ret.sz]);
+		return ret;
+	}
+
+	// hand the elements over to a vector, *this is left empty
+	vector_type to_vector() && {
+		vector_type ret;
+		ret.alloc = alloc;
+		if (is_inline()) {
+			ret.reserve(sz);
+			relocate(_data, _data + sz, ret._data);
+			ret.sz = sz;
+		} else {
+			ret._data = _data;
+			ret.sz    = sz;
+			ret.cap   = cap;
+			_data     = inline_data();
+			cap       = N;
+		}
+		sz = 0;
+		return ret;
+	}
+
+	allocator_type get_allocator() const { return alloc; }
+
+	reference at(size_type pos) {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return _data[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return _data[pos];
+	}
+
+	reference operator[](size_type pos) { return _data[pos]; }
+
+	const_reference operator[](size_type pos) const { return _data[pos]; }
+
+	reference front() { return *_data; }
+
+	const_reference front() const { return *_data; }
+
+	reference back() { return *(_data + sz - 1); }
+
+	const_reference back() const { return *(_data + sz - 1); }
+
+	T *data() { return _data; }
+
+	const T *data() const { return _data; }
+
+	iterator begin() { return iterator(_data); }
+
+	const_iterator begin() const { return const_iterator(_data); }
+
+	const_iterator cbegin() const { return const_iterator(_data); }
+
+	iterator end() { return iterator(_data + sz); }
+
+	const_iterator end() const { return const_iterator(_data + sz); }
+
+	const_iterator cend() const { return const_iterator(_data + sz); }
+
+	reverse_iterator rbegin() { return reverse_iterator(_data + sz - 1); }
+
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(_data + sz - 1);
+	}
+
+	const_reverse_iterator crbegin() const {
+		return const_reverse_iterator(_data + sz - 1);
+	}
+
+	reverse_iterator rend() { return reverse_iterator(_data - 1); }
+
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(_data - 1);
+	}
+
+	const_reverse_iterator crend() const {
+		return const_reverse_iterator(_data - 1);
+	}
+
+	bool empty() const { return sz == 0; }
+
+	size_type size() const { return sz; }
+
+	size_type capacity() const { return cap; }
+
+	static constexpr size_type inline_capacity() { return N; }
+
+	// true while the elements live in the inline buffer
+	bool is_inline() const { return _data == inline_data(); }
+
+	void reserve(size_type new_cap) {
+		if (new_cap > cap)
+			reallocate(new_cap);
+	}
+
+	// moves the elements back inline when they fit
+	void shrink_to_fit() {
+		if (is_inline() || sz == cap)
+			return;
+		if (sz <= N) {
+			T *heap = _data;
+			relocate(heap, heap + sz, inline_data());
+			alloc_traits::deallocate(alloc, heap, cap);
+			_data = inline_data();
+			cap   = N;
+		} else {
+			reallocate(sz);
+		}
+	}
+
+	void clear() {
+		for (size_type i = 0; i < sz; ++i)
+			alloc_traits::destroy(alloc, _data + i);
+		sz = 0;
+	}
+
+	iterator insert(const_iterator pos, const T &value) {
+		return emplace(pos, value);
+	}
+
+	iterator insert(const_iterator pos, T &&value) {
+		return emplace(pos, std::move(value));
+	}
+
+	iterator insert(const_iterator pos, size_type count, const T &value) {
+		if (count == 0)
+			return iterator(_data + (pos - cbegin()));
+		// value may be an element that the gap moves
+		T tmp(value);
+		T *flag = make_gap(pos, count);
+		for (size_type i = 0; i < count; ++i)
+			alloc_traits::construct(alloc, flag + i, tmp);
+		sz += count;
+		return iterator(flag);
+	}
+
+	template <typename InputIt>
+	requires tp::is_iterator<InputIt>
+	iterator insert(const_iterator pos, InputIt first, InputIt last) {
+		size_type count = last - first;
+		T *flag         = make_gap(pos, count);
+		for (T *dst = flag; first != last; ++dst, ++first)
+			alloc_traits::construct(alloc, dst, *first);
+		sz += count;
+		return iterator(flag);
+	}
+
+	iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+		return insert(pos, ilist.begin(), ilist.end());
+	}
+
+	template <typename... Args>
+	iterator emplace(const_iterator pos, Args &&...args) {
+		// args may refer to an element that the gap moves
+		T tmp(std::forward<Args>(args)...);
+		T *flag = make_gap(pos, 1);
+		alloc_traits::construct(alloc, flag, std::move(tmp));
+		++sz;
+		return iterator(flag);
+	}
+
+	iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+	iterator erase(const_iterator first, const_iterator last) {
+		T *dst = _data + (first - cbegin());
+		T *src = _data + (last - cbegin());
+
+		for (T *walk = dst; walk != src; ++walk)
+			alloc_traits::destroy(alloc, walk);
+		relocate(src, _data + sz, dst);
+
+		sz -= src - dst;
+		return iterator(dst);
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		if (sz == cap)
+			return grow_emplace_back(std::forward<Args>(args)...);
+		alloc_traits::construct(alloc, _data + sz,
+		                        std::forward<Args>(args)...);
+		++sz;
+		return *(_data + sz - 1);
+	}
+
+	void pop_back() {
+		--sz;
+		alloc_traits::destroy(alloc, _data + sz);
+	}
+
+	void resize(size_type count) {
+		if (sz > count) {
+			erase(cbegin() + count, cend());
+		} else if (sz < count) {
+			if (cap < count)
+				grow(count);
+			for (; sz < count; ++sz)
+				alloc_traits::construct(alloc, _data + sz);
+		}
+	}
+
+	void resize(size_type count, const value_type &value) {
+		if (sz > count) {
+			erase(cbegin() + count, cend());
+		} else if (sz < count) {
+			if (cap < count)
+				grow(count);
+			for (; sz < count; ++sz)
+				alloc_traits::construct(alloc, _data + sz, value);
+		}
+	}
+
+	void swap(small_vector &other) {
+		if (!is_inline() && !other.is_inline()) {
+			std::swap(_data, other._data);
+			std::swap(sz, other.sz);
+			std::swap(cap, other.cap);
+			if (alloc_traits::propagate_on_container_swap::value) {
+				using std::swap;
+				swap(alloc, other.alloc);
+			}
+		} else {
+			small_vector tmp(std::move(other));
+			other = std::move(*this);
+			*this = std::move(tmp);
+		}
+	}
+
+private:
+	T *inline_data() { return reinterpret_cast<T *>(buf); }
+
+	const T *inline_data() const { return reinterpret_cast<const T *>(buf); }
+
+	// open a hole of `count` uninitialized slots at pos, growing if needed
+	T *make_gap(const_iterator pos, size_type count) {
+		size_type offset = pos - cbegin();
+		if (sz + count > cap)
+			grow(sz + count);
+		T *flag = _data + offset;
+		relocate(flag, _data + sz, flag + count);
+		return flag;
+	}
+
+	// args may refer to an element: build the new one before the old move
+	template <typename... Args> reference grow_emplace_back(Args &&...args) {
+		size_type new_cap = Growth::next_capacity(cap, sz + 1, sizeof(T));
+		T *new_data       = alloc_traits::allocate(alloc, new_cap);
+		try {
+			alloc_traits::construct(alloc, new_data + sz,
+			                        std::forward<Args>(args)...);
+		} catch (...) {
+			alloc_traits::deallocate(alloc, new_data, new_cap);
+			throw;
+		}
+		relocate(_data, _data + sz, new_data);
+		release();
+
+		_data = new_data;
+		cap   = new_cap;
+		return _data[sz++];
+	}
+
+	void grow(size_type required) {
+		reallocate(Growth::next_capacity(cap, required, sizeof(T)));
+	}
+
+	void reallocate(size_type new_cap) {
+		T *new_data = alloc_traits::allocate(alloc, new_cap);
+		relocate(_data, _data + sz, new_data);
+		release();
+
+		_data = new_data;
+		cap   = new_cap;
+	}
+
+	// free the heap buffer, if any; elements must already be gone
+	void release() {
+		if (!is_inline())
+			alloc_traits::deallocate(alloc, _data, cap);
+		_data = inline_data();
+		cap   = N;
+	}
+
+	// take the elements of other, which is left empty and inline
+	void take(small_vector &other) {
+		if (other.is_inline()) {
+			reserve(other.sz);
+			relocate(other._data, other._data + other.sz, _data);
+			sz = other.sz;
+		} else if (alloc == other.alloc) {
+			_data = other._data;
+			sz    = other.sz;
+			cap   = other.cap;
+			other._data = other.inline_data();
+			other.cap   = N;
+		} else {
+			reserve(other.sz);
+			relocate(other._data, other._data + other.sz, _data);
+			sz = other.sz;
+			other.release();
+		}
+		other.sz = 0;
+	}
+
+	void relocate(T *first, T *last, T *dest) {
+		tp::relocate(alloc, first, last, dest);
+	}
+
+	Alloc alloc;
+	size_type sz;
+	size_type cap;
+	T *_data;
+	alignas(T) unsigned char buf[N * sizeof(T)];
+};
+
+} // namespace tp
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tp {
+
+/*
+ * Unbounded single-producer/single-consumer queue.
+ *
+ * Elements live in a chain of blocks shaped like deque nodes: an array of
+ * BlockBytes / sizeof(T) elements (at least one), with a link to the next
+ * block and a count of the slots the producer has published in front of
+ * it. The producer only writes a block's slots and count, the consumer
+ * only reads them; both sides keep their position in their own cache line,
+ * and a count or link is only loaded again when the cached one runs out.
+ * All synchronization is acquire/release.
+ *
+ * Blocks the consumer is done with are not freed: the producer takes them
+ * back from the front of the chain once the consumer has published that it
+ * moved past them, so a queue in steady state stops allocating.
+ *
+ * One thread may call push/emplace/try_push_n, one other thread
+ * try_pop/try_pop_n/empty. Destruction and everything else needs both
+ * sides to be quiet.
+ */
+template <typename T, std::size_t BlockBytes = 4096,
+          typename Alloc = std::allocator<T>>
+class spsc_queue {
+	static constexpr std::size_t block_elems =
+	    sizeof(T) < BlockBytes ? BlockBytes / sizeof(T) : 1;
+
+	struct block {
+		std::atomic<block *> next{nullptr};
+		std::atomic<std::size_t> committed{0};
+		alignas(T) unsigned char storage[block_elems * sizeof(T)];
+
+		T *slots() { return std::launder(reinterpret_cast<T *>(storage)); }
+	};
+
+	using block_alloc_type =
+	    typename std::allocator_traits<Alloc>::template rebind_alloc<block>;
+	using block_alloc_traits = std::allocator_traits<block_alloc_type>;
+	using T_alloc_type =
+	    typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+	using T_alloc_traits = std::allocator_traits<T_alloc_type>;
+
+	static constexpr std::size_t cache_line = 64;
+
+public:
+	using value_type     = T;
+	using allocator_type = Alloc;
+	using size_type      = std::size_t;
+
+	explicit spsc_queue(const Alloc &alloc = Alloc())
+	    : balloc(alloc), talloc(alloc) {
+		block *b = new_block();
+		prod.tail = prod.first = prod.consumer_seen = b;
+		cons.head = b;
+		consumer_head.store(b, std::memory_order_relaxed);
+	}
+
+	spsc_queue(const spsc_queue &)            = delete;
+	spsc_queue &operator=(const spsc_queue &) = delete;
+
+	~spsc_queue() {
+		drop_all();
+		for (block *b = prod.first; b;) {
+			block *next = b->next.load(std::memory_order_relaxed);
+			block_alloc_traits::destroy(balloc, b);
+			block_alloc_traits::deallocate(balloc, b, 1);
+			b = next;
+		}
+	}
+
+	// elements per block
+	static constexpr size_type block_size() { return block_elems; }
+
+	/* producer side */
+
+	void push(const T &value) { emplace(value); }
+
+	void push(T &&value) { emplace(std::move(value)); }
+
+	template <typename... Args> void emplace(Args &&...args) {
+		if (prod.index == block_elems)
+			next_tail();
+		block *b = prod.tail;
+		T_alloc_traits::construct(talloc, b->slots() + prod.index,
+		                          std::forward<Args>(args)...);
+		b->committed.store(++prod.index, std::memory_order_release);
+	}
+
+	/*
+	 * Push src[0, n); trivially copyable T is memcpy'd and published once
+	 * per block rather than per element. The queue is unbounded, so all n
+	 * go in (or allocation throws); the count is returned for symmetry
+	 * with try_pop_n.
+	 */
+	size_type try_push_n(const T *src, size_type n) {
+		if constexpr (!std::is_trivially_copyable_v<T>) {
+			for (size_type i = 0; i < n; ++i)
+				emplace(src[i]);
+		} else {
+			for (size_type left = n; left;) {
+				if (prod.index == block_elems)
+					next_tail();
+				block *b        = prod.tail;
+				size_type count = std::min(left, block_elems - prod.index);
+				std::memcpy(static_cast<void *>(b->slots() + prod.index), src,
+				            count * sizeof(T));
+				prod.index += count;
+				b->committed.store(prod.index, std::memory_order_release);
+				src += count, left -= count;
+			}
+		}
+		return n;
+	}
+
+	/* consumer side */
+
+	// move the front element into out; false if the queue is empty
+	bool try_pop(T &out) {
+		if (cons.index == cons.avail && !refill())
+			return false;
+		T *slot = cons.head->slots() + cons.index;
+		out     = std::move(*slot);
+		T_alloc_traits::destroy(talloc, slot);
+		++cons.index;
+		return true;
+	}
+
+	// move up to n elements to dst; returns how many
+	size_type try_pop_n(T *dst, size_type n) {
+		size_type done = 0;
+		while (done < n) {
+			if (cons.index == cons.avail && !refill())
+				break;
+			size_type count = std::min(n - done, cons.avail - cons.index);
+			T *src          = cons.head->slots() + cons.index;
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				std::memcpy(static_cast<void *>(dst + done), src,
+				            count * sizeof(T));
+			} else {
+				for (size_type i = 0; i < count; ++i) {
+					dst[done + i] = std::move(src[i]);
+					T_alloc_traits::destroy(talloc, src + i);
+				}
+			}
+			cons.index += count;
+			done += count;
+		}
+		return done;
+	}
+
+	bool empty() { return cons.index == cons.avail && !refill(); }
+
+private:
+	block *new_block() {
+		block *b = block_alloc_traits::allocate(balloc, 1);
+		block_alloc_traits::construct(balloc, b);
+		return b;
+	}
+
+	// producer: link a fresh or recycled block after the tail
+	void next_tail() {
+		block *b = take_spare();
+		prod.tail->next.store(b, std::memory_order_release);
+		prod.tail  = b;
+		prod.index = 0;
+	}
+
+	/*
+	 * Blocks from prod.first up to the consumer's current block have been
+	 * drained. The consumer read their links before publishing that it
+	 * moved on, so they can be reset and reused.
+	 */
+	block *take_spare() {
+		if (prod.first == prod.consumer_seen)
+			prod.consumer_seen = consumer_head.load(std::memory_order_acquire);
+		if (prod.first == prod.consumer_seen)
+			return new_block();
+		block *b   = prod.first;
+		prod.first = b->next.load(std::memory_order_relaxed);
+		b->next.store(nullptr, std::memory_order_relaxed);
+		b->committed.store(0, std::memory_order_relaxed);
+		return b;
+	}
+
+	// consumer: look for more published elements; false if there are none
+	bool refill() {
+		block *b   = cons.head;
+		cons.avail = b->committed.load(std::memory_order_acquire);
+		if (cons.index < cons.avail)
+			return true;
+		if (cons.index < block_elems)
+			return false;
+		block *next = b->next.load(std::memory_order_acquire);
+		if (!next)
+			return false;
+		cons.head  = next;
+		cons.index = 0;
+		consumer_head.store(next, std::memory_order_release);
+		cons.avail = next->committed.load(std::memory_order_acquire);
+		return cons.index < cons.avail;
+	}
+
+	// destroy whatever is still queued
+	void drop_all() {
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			for (block *b = cons.head; b;
+			     b = b->next.load(std::memory_order_relaxed)) {
+				size_type first = b == cons.head ? cons.index : 0;
+				size_type last  = b->committed.load(std::memory_order_relaxed);
+				for (size_type i = first; i < last; ++i)
+					T_alloc_traits::destroy(talloc, b->slots() + i);
+			}
+		}
+	}
+
+	struct alignas(cache_line) producer_state {
+		block *tail          = nullptr;
+		size_type index      = 0;
+		block *first         = nullptr; // oldest block, maybe drained
+		block *consumer_seen = nullptr; // last consumer_head loaded
+	};
+
+	struct alignas(cache_line) consumer_state {
+		block *head     = nullptr;
+		size_type index = 0;
+		size_type avail = 0; // committed count of head last loaded
+	};
+
+	[[no_unique_address]] block_alloc_type balloc;
+	[[no_unique_address]] T_alloc_type talloc;
+	producer_state prod;
+	consumer_state cons;
+	alignas(cache_line) std::atomic<block *> consumer_head{nullptr};
+};
+
+} // namespace tp
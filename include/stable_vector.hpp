@@ -0,0 +1,459 @@
+#pragma once
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <iterator.hpp>
+
+namespace tp {
+
+template <typename T, std::size_t FirstBlock, typename Alloc>
+class stable_vector;
+
+/*
+ * Iterator over a stable_vector. Keeps the current block's bounds so ++/--
+ * only recompute the block at a block boundary.
+ */
+template <typename T, std::size_t FirstBlock, bool Const>
+class stable_vector_iterator {
+	template <typename, std::size_t, typename> friend class stable_vector;
+	template <typename, std::size_t, bool>
+	friend class stable_vector_iterator;
+
+	using elem_pointer = T *;
+	using block_table  = T *const *;
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = T;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = std::conditional_t<Const, const T *, T *>;
+	using reference         = std::conditional_t<Const, const T &, T &>;
+
+	stable_vector_iterator()
+	    : blocks(), idx(0), cur(), seg_first(), seg_last() {}
+
+	// iterator -> const_iterator
+	template <bool C>
+	requires(Const && !C)
+	stable_vector_iterator(const stable_vector_iterator<T, FirstBlock, C> &it)
+	    : blocks(it.blocks), idx(it.idx), cur(it.cur),
+	      seg_first(it.seg_first), seg_last(it.seg_last) {}
+
+	reference operator*() const { return *cur; }
+
+	pointer operator->() const { return cur; }
+
+	reference operator[](difference_type n) const { return *(*this + n); }
+
+	stable_vector_iterator &operator++() {
+		++idx;
+		// cur == seg_last only off the allocated blocks (end, rend)
+		if (cur == seg_last || ++cur == seg_last)
+			seek(idx);
+		return *this;
+	}
+
+	stable_vector_iterator operator++(int) {
+		stable_vector_iterator tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	stable_vector_iterator &operator--() {
+		--idx;
+		if (cur == seg_first)
+			seek(idx);
+		else
+			--cur;
+		return *this;
+	}
+
+	stable_vector_iterator operator--(int) {
+		stable_vector_iterator tmp = *this;
+		--*this;
+		return tmp;
+	}
+
+	stable_vector_iterator &operator+=(difference_type n) {
+		idx += n;
+		if (n >= seg_last - cur || -n > cur - seg_first)
+			seek(idx);
+		else
+			cur += n;
+		return *this;
+	}
+
+	stable_vector_iterator &operator-=(difference_type n) {
+		return *this += -n;
+	}
+
+	friend stable_vector_iterator operator+(stable_vector_iterator it,
+	                                        difference_type n) {
+		return it += n;
+	}
+
+	friend stable_vector_iterator operator+(difference_type n,
+	                                        stable_vector_iterator it) {
+		return it += n;
+	}
+
+	friend stable_vector_iterator operator-(stable_vector_iterator it,
+	                                        difference_type n) {
+		return it -= n;
+	}
+
+	friend difference_type operator-(const stable_vector_iterator &lhs,
+	                                 const stable_vector_iterator &rhs) {
+		return difference_type(lhs.idx) - difference_type(rhs.idx);
+	}
+
+	friend bool operator==(const stable_vector_iterator &lhs,
+	                       const stable_vector_iterator &rhs) {
+		return lhs.idx == rhs.idx;
+	}
+
+	friend std::strong_ordering operator<=>(const stable_vector_iterator &lhs,
+	                                        const stable_vector_iterator &rhs) {
+		return lhs.idx <=> rhs.idx;
+	}
+
+	// the contiguous run of elements the iterator is in
+	pointer segment_begin() const { return seg_first; }
+
+	pointer segment_end() const { return seg_last; }
+
+private:
+	stable_vector_iterator(block_table b, std::size_t i) : blocks(b), idx(i) {
+		seek(i);
+	}
+
+	void seek(std::size_t i);
+
+	block_table blocks;
+	std::size_t idx;
+	elem_pointer cur;
+	elem_pointer seg_first;
+	elem_pointer seg_last;
+};
+
+/*
+ * A vector made of blocks that double in size: block k holds
+ * FirstBlock << k elements. Growing allocates the next block and never moves
+ * an element, so pointers and references stay valid until the element is
+ * removed, and there is no over-reservation to avoid reallocations.
+ *
+ * Index i lives in block bit_width(i + FirstBlock) - 1 - log2(FirstBlock),
+ * so operator[] is one bit scan plus two loads. The block table is a fixed
+ * array and never reallocates either.
+ *
+ * Elements can be added and removed at the end only.
+ */
+template <typename T, std::size_t FirstBlock = 16,
+          typename Alloc = std::allocator<T>>
+class stable_vector {
+	static_assert(std::has_single_bit(FirstBlock),
+	              "FirstBlock must be a power of two");
+
+	using alloc_traits = std::allocator_traits<Alloc>;
+
+	static constexpr int first_shift = std::countr_zero(FirstBlock);
+	static constexpr int max_blocks  = 64 - first_shift;
+
+	template <typename, std::size_t, bool>
+	friend class stable_vector_iterator;
+
+public:
+	using value_type      = T;
+	using allocator_type  = Alloc;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T &;
+	using const_reference = const T &;
+	using pointer         = T *;
+	using const_pointer   = const T *;
+
+	using iterator       = stable_vector_iterator<T, FirstBlock, false>;
+	using const_iterator = stable_vector_iterator<T, FirstBlock, true>;
+	using reverse_iterator       = tp::reverse_iterator<iterator>;
+	using const_reverse_iterator = tp::reverse_iterator<const_iterator>;
+
+	stable_vector()
+	    : alloc{}, sz(0), tail(), tail_end(), nblocks(0), blocks{} {}
+
+	explicit stable_vector(const Alloc &_alloc)
+	    : alloc(_alloc), sz(0), tail(), tail_end(), nblocks(0), blocks{} {}
+
+	stable_vector(size_type count, const T &value,
+	              const Alloc &_alloc = Alloc())
+	    : stable_vector(_alloc) {
+		resize(count, value);
+	}
+
+	explicit stable_vector(size_type count, const Alloc &_alloc = Alloc())
+	    : stable_vector(_alloc) {
+		resize(count);
+	}
+
+	template <typename InputIt>
+	requires tp::is_iterator<InputIt>
+	stable_vector(InputIt first, InputIt last, const Alloc &_alloc = Alloc())
+	    : stable_vector(_alloc) {
+		for (; first != last; ++first)
+			emplace_back(*first);
+	}
+
+	stable_vector(std::initializer_list<T> init,
+	              const Alloc &_alloc = Alloc())
+	    : stable_vector(init.begin(), init.end(), _alloc) {}
+
+	// copy ctor
+	stable_vector(const stable_vector &other)
+	    : stable_vector(
+	          alloc_traits::select_on_container_copy_construction(other.alloc)) {
+		reserve(other.sz);
+		for (const T &elem : other)
+			emplace_back(elem);
+	}
+
+	// move ctor, steals the blocks
+	stable_vector(stable_vector &&other)
+	    : alloc(std::move(other.alloc)), sz(other.sz), tail(other.tail),
+	      tail_end(other.tail_end), nblocks(other.nblocks) {
+		for (int k = 0; k < max_blocks; ++k)
+			blocks[k] = other.blocks[k], other.blocks[k] = nullptr;
+		other.sz      = 0;
+		other.nblocks = 0;
+		other.tail = other.tail_end = nullptr;
+	}
+
+	~stable_vector() {
+		clear();
+		release_blocks(-1);
+	}
+
+	stable_vector &operator=(const stable_vector &other) {
+		if (this != &other) {
+			clear();
+			reserve(other.sz);
+			for (const T &elem : other)
+				emplace_back(elem);
+		}
+		return *this;
+	}
+
+	stable_vector &operator=(stable_vector &&other) {
+		if (this != &other) {
+			stable_vector tmp(std::move(other));
+			swap(tmp);
+		}
+		return *this;
+	}
+
+	stable_vector &operator=(std::initializer_list<T> ilist) {
+		clear();
+		for (const T &elem : ilist)
+			emplace_back(elem);
+		return *this;
+	}
+
+	reference at(size_type pos) {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return (*this)[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		if (pos >= sz)
+			throw std::out_of_range("out of range\n");
+		return (*this)[pos];
+	}
+
+	reference operator[](size_type pos) {
+		size_type j = pos + FirstBlock;
+		int hb      = std::bit_width(j) - 1;
+		return blocks[hb - first_shift][j - (size_type(1) << hb)];
+	}
+
+	const_reference operator[](size_type pos) const {
+		return const_cast<stable_vector &>(*this)[pos];
+	}
+
+	reference front() { return blocks[0][0]; }
+
+	const_reference front() const { return blocks[0][0]; }
+
+	reference back() { return (*this)[sz - 1]; }
+
+	const_reference back() const { return (*this)[sz - 1]; }
+
+	iterator begin() { return iterator(blocks, 0); }
+
+	const_iterator begin() const { return const_iterator(blocks, 0); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(blocks, sz); }
+
+	const_iterator end() const { return const_iterator(blocks, sz); }
+
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(end() - 1); }
+
+	reverse_iterator rend() { return reverse_iterator(begin() - 1); }
+
+	bool empty() const { return sz == 0; }
+
+	size_type size() const { return sz; }
+
+	// elements that fit in the blocks allocated so far
+	size_type capacity() const { return block_start(nblocks); }
+
+	// allocate blocks up to new_cap; nothing is moved
+	void reserve(size_type new_cap) {
+		while (capacity() < new_cap)
+			add_block();
+	}
+
+	// free the blocks past the one holding the last element
+	void shrink_to_fit() {
+		release_blocks(block_of(sz + FirstBlock - 1));
+		set_tail();
+	}
+
+	void clear() {
+		for (size_type i = 0; i < sz; ++i)
+			alloc_traits::destroy(alloc, &(*this)[i]);
+		sz = 0;
+		set_tail();
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		if (tail == tail_end) {
+			if (sz == capacity())
+				add_block();
+			set_tail();
+		}
+		alloc_traits::construct(alloc, tail, std::forward<Args>(args)...);
+		++sz;
+		return *tail++;
+	}
+
+	void pop_back() {
+		--sz;
+		alloc_traits::destroy(alloc, &(*this)[sz]);
+		set_tail();
+	}
+
+	void resize(size_type count) {
+		reserve(count);
+		while (sz > count)
+			pop_back();
+		while (sz < count)
+			emplace_back();
+	}
+
+	void resize(size_type count, const value_type &value) {
+		reserve(count);
+		while (sz > count)
+			pop_back();
+		while (sz < count)
+			emplace_back(value);
+	}
+
+	void swap(stable_vector &other) {
+		std::swap(alloc, other.alloc);
+		std::swap(sz, other.sz);
+		std::swap(tail, other.tail);
+		std::swap(tail_end, other.tail_end);
+		std::swap(nblocks, other.nblocks);
+		std::swap(blocks, other.blocks);
+	}
+
+	// blocks allocated so far and the size of block k, for block-wise loops
+	int block_count() const { return nblocks; }
+
+	static size_type block_size(int k) { return FirstBlock << k; }
+
+	T *block_data(int k) { return blocks[k]; }
+
+	const T *block_data(int k) const { return blocks[k]; }
+
+private:
+	// index of the first element of block k
+	static size_type block_start(int k) {
+		return (FirstBlock << k) - FirstBlock;
+	}
+
+	// block holding index j - FirstBlock
+	static int block_of(size_type j) {
+		return std::bit_width(j) - 1 - first_shift;
+	}
+
+	// point tail at slot sz, or at nothing when no block holds it yet
+	void set_tail() {
+		size_type j = sz + FirstBlock;
+		int hb      = std::bit_width(j) - 1;
+		int k       = hb - first_shift;
+		if (k >= nblocks) {
+			tail = tail_end = nullptr;
+			return;
+		}
+		tail     = blocks[k] + (j - (size_type(1) << hb));
+		tail_end = blocks[k] + (size_type(1) << hb);
+	}
+
+	void add_block() {
+		if (nblocks == max_blocks)
+			throw std::length_error("stable_vector: too many elements");
+		blocks[nblocks] = alloc_traits::allocate(alloc, block_size(nblocks));
+		++nblocks;
+	}
+
+	// free blocks [keep + 1, nblocks); keep == -1 frees all of them
+	void release_blocks(int keep) {
+		while (nblocks > keep + 1 && nblocks > 0) {
+			--nblocks;
+			alloc_traits::deallocate(alloc, blocks[nblocks],
+			                         block_size(nblocks));
+			blocks[nblocks] = nullptr;
+		}
+	}
+
+	Alloc alloc;
+	size_type sz;
+	T *tail;     // where the next push_back goes
+	T *tail_end; // end of tail's block
+	int nblocks;
+	T *blocks[max_blocks];
+};
+
+template <typename T, std::size_t FirstBlock, bool Const>
+void stable_vector_iterator<T, FirstBlock, Const>::seek(std::size_t i) {
+	constexpr int first_shift = std::countr_zero(FirstBlock);
+	std::size_t j = i + FirstBlock;
+	int hb        = std::bit_width(j) - 1;
+	int k         = hb - first_shift;
+	T *block      = k >= 0 ? blocks[k] : nullptr;
+	if (!block) {
+		// before the first or past the last block, only idx is meaningful
+		cur = seg_first = seg_last = nullptr;
+		return;
+	}
+	seg_first = block;
+	seg_last  = block + (std::size_t(1) << hb);
+	cur       = block + (j - (std::size_t(1) << hb));
+}
+
+} // namespace tp
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tp {
+
+/*
+ * Fixed-size fork-join pool for the parallel algorithms.
+ *
+ * A pool of concurrency n owns n - 1 worker threads; the thread calling
+ * run() is the n-th, so thread_pool(1) runs everything inline. run() only
+ * waits for the indices it handed out, not for the helpers to start, which
+ * makes nested run() calls from inside a task safe.
+ */
+class thread_pool {
+public:
+	explicit thread_pool(
+	    std::size_t concurrency = std::thread::hardware_concurrency()) {
+		concurrency = std::max<std::size_t>(concurrency, 1);
+		workers.reserve(concurrency - 1);
+		for (std::size_t i = 1; i < concurrency; ++i)
+			workers.emplace_back([this] { work(); });
+	}
+
+	thread_pool(const thread_pool &)            = delete;
+	thread_pool &operator=(const thread_pool &) = delete;
+
+	~thread_pool() {
+		{
+			std::lock_guard lock(mtx);
+			stopping = true;
+		}
+		cv.notify_all();
+		for (auto &t : workers)
+			t.join();
+	}
+
+	// number of threads taking part in run(), the caller included
+	std::size_t concurrency() const { return workers.size() + 1; }
+
+	// shared pool sized to hardware_concurrency
+	static thread_pool &instance() {
+		static thread_pool pool;
+		return pool;
+	}
+
+	// call fn(i) for every i in [0, n) and wait; the first exception thrown
+	// by fn is rethrown here once all started calls have finished
+	template <typename Fn> void run(std::size_t n, Fn &&fn) {
+		if (n == 0)
+			return;
+		if (n == 1 || workers.empty()) {
+			for (std::size_t i = 0; i < n; ++i)
+				fn(i);
+			return;
+		}
+
+		auto job  = std::make_shared<batch>();
+		job->n    = n;
+		job->body = [&fn](std::size_t i) { fn(i); };
+
+		std::size_t helpers = std::min(n - 1, workers.size());
+		{
+			std::lock_guard lock(mtx);
+			for (std::size_t i = 0; i < helpers; ++i)
+				tasks.emplace_back([job] { job->drain(); });
+		}
+		if (helpers == 1)
+			cv.notify_one();
+		else
+			cv.notify_all();
+
+		job->drain();
+		job->wait();
+		if (job->error)
+			std::rethrow_exception(job->error);
+	}
+
+private:
+	/*
+	 * One run() call. Late helpers find next >= n and return without
+	 * touching body, which refers to the caller's stack.
+	 */
+	struct batch {
+		std::size_t n = 0;
+		std::function<void(std::size_t)> body;
+		std::atomic<std::size_t> next{0};
+		std::atomic<std::size_t> done{0};
+		std::exception_ptr error;
+		std::mutex mtx;
+		std::condition_variable cv;
+
+		void drain() {
+			std::size_t finished = 0;
+			for (std::size_t i; (i = next.fetch_add(1)) < n; ++finished) {
+				try {
+					body(i);
+				} catch (...) {
+					std::lock_guard lock(mtx);
+					if (!error)
+						error = std::current_exception();
+				}
+			}
+			if (finished && done.fetch_add(finished) + finished == n) {
+				std::lock_guard lock(mtx);
+				cv.notify_all();
+			}
+		}
+
+		void wait() {
+			std::unique_lock lock(mtx);
+			cv.wait(lock, [this] { return done.load() == n; });
+		}
+	};
+
+	void work() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(mtx);
+				cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+				if (tasks.empty())
+					return;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool stopping = false;
+};
+
+} // namespace tp
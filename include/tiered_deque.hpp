@@ -0,0 +1,590 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <vector.hpp>
+
+namespace tp {
+
+template <typename T, typename Alloc, std::size_t BlockBytes>
+class tiered_deque;
+
+template <typename Deque, bool Const> class tiered_deque_iterator {
+	using owner_type = std::conditional_t<Const, const Deque, Deque>;
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = typename Deque::value_type;
+	using difference_type   = std::ptrdiff_t;
+	using reference =
+	    std::conditional_t<Const, const value_type &, value_type &>;
+	using pointer =
+	    std::conditional_t<Const, const value_type *, value_type *>;
+
+	tiered_deque_iterator() = default;
+
+	tiered_deque_iterator(owner_type *d, std::size_t blk, pointer cur,
+	                      pointer run_end)
+	    : d(d), blk(blk), cur(cur), run_end(run_end) {}
+
+	operator tiered_deque_iterator<Deque, true>() const requires(!Const) {
+		return {d, blk, cur, run_end};
+	}
+
+	reference operator*() const { return *cur; }
+
+	pointer operator->() const { return cur; }
+
+	reference operator[](difference_type n) const { return *(*this + n); }
+
+	tiered_deque_iterator &operator++() {
+		if (++cur == run_end && blk + 1 < d->nodes.size())
+			set_block(blk + 1, 0);
+		return *this;
+	}
+
+	tiered_deque_iterator operator++(int) {
+		tiered_deque_iterator tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	tiered_deque_iterator &operator--() {
+		if (cur == d->nodes[blk].data + d->nodes[blk].first)
+			set_block(blk - 1, d->nodes[blk - 1].size());
+		--cur;
+		return *this;
+	}
+
+	tiered_deque_iterator operator--(int) {
+		tiered_deque_iterator tmp = *this;
+		--*this;
+		return tmp;
+	}
+
+	// jumps go through the block index: O(log blocks)
+	tiered_deque_iterator &operator+=(difference_type n) {
+		return *this = d->iter_at(index() + n);
+	}
+
+	tiered_deque_iterator &operator-=(difference_type n) { return *this += -n; }
+
+	friend tiered_deque_iterator operator+(tiered_deque_iterator it,
+	                                       difference_type n) {
+		return it += n;
+	}
+
+	friend tiered_deque_iterator operator+(difference_type n,
+	                                       tiered_deque_iterator it) {
+		return it += n;
+	}
+
+	friend tiered_deque_iterator operator-(tiered_deque_iterator it,
+	                                       difference_type n) {
+		return it -= n;
+	}
+
+	friend difference_type operator-(const tiered_deque_iterator &a,
+	                                 const tiered_deque_iterator &b) {
+		return difference_type(a.index()) - difference_type(b.index());
+	}
+
+	friend bool operator==(const tiered_deque_iterator &a,
+	                       const tiered_deque_iterator &b) {
+		return a.cur == b.cur;
+	}
+
+	friend auto operator<=>(const tiered_deque_iterator &a,
+	                        const tiered_deque_iterator &b) {
+		return a.blk != b.blk ? a.blk <=> b.blk
+		                      : std::compare_three_way()(a.cur, b.cur);
+	}
+
+private:
+	template <typename, bool> friend class tiered_deque_iterator;
+	template <typename, typename, std::size_t> friend class tiered_deque;
+
+	// point at element i of the run of block b
+	void set_block(std::size_t b, std::size_t i) {
+		auto &n = d->nodes[b];
+		blk     = b;
+		cur     = n.data + n.first + i;
+		run_end = n.data + n.last;
+	}
+
+	std::size_t index() const {
+		if (d->nodes.empty())
+			return 0;
+		auto &n = d->nodes[blk];
+		return d->prefix(blk) + (cur - (n.data + n.first));
+	}
+
+	owner_type *d   = nullptr;
+	std::size_t blk = 0;
+	pointer cur     = nullptr;
+	pointer run_end = nullptr; // end of the run of block blk
+};
+
+/*
+ * Deque for heavy insert/erase in the middle.
+ *
+ * Like deque, elements live in fixed-size blocks of BlockBytes (at least
+ * 16 elements), but a block may be partly filled: it holds a contiguous
+ * run [first, last) anywhere in its storage. Inserting or erasing shifts
+ * only the elements of one block, toward whichever side is nearer and has
+ * room; a full block is split in two halves first, an emptied one is
+ * dropped and a block that falls below a quarter is merged with a
+ * neighbour when the two fit in half a block.
+ *
+ * Since blocks hold different counts, the position of an element is found
+ * through a Fenwick tree over the block sizes: operator[], insert and
+ * iterator jumps cost O(log blocks), a size change one O(log blocks)
+ * update. Splits, merges and new front blocks rebuild the tree and shift
+ * the block table, O(blocks), which is amortized over the block's worth of
+ * inserts that caused them. Iterating with ++/-- stays O(1).
+ *
+ * The trade-off against deque: a middle insert moves at most one block of
+ * elements instead of up to half the container, random access is a tree
+ * walk instead of a division.
+ */
+template <typename T, typename Alloc = std::allocator<T>,
+          std::size_t BlockBytes = 4096>
+class tiered_deque {
+	using T_alloc_type =
+	    typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+	using T_alloc_traits = std::allocator_traits<T_alloc_type>;
+
+	static constexpr std::size_t block_elems =
+	    std::max<std::size_t>(BlockBytes / sizeof(T), 16);
+
+	struct node {
+		T *data;
+		std::size_t first, last;
+
+		std::size_t size() const { return last - first; }
+	};
+
+public:
+	using value_type      = T;
+	using allocator_type  = Alloc;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T &;
+	using const_reference = const T &;
+	using iterator        = tiered_deque_iterator<tiered_deque, false>;
+	using const_iterator  = tiered_deque_iterator<tiered_deque, true>;
+
+	tiered_deque() = default;
+
+	explicit tiered_deque(const Alloc &alloc) : alloc(alloc) {}
+
+	tiered_deque(std::initializer_list<T> ilist, const Alloc &alloc = Alloc())
+	    : alloc(alloc) {
+		for (const T &x : ilist)
+			push_back(x);
+	}
+
+	tiered_deque(const tiered_deque &other)
+	    : alloc(T_alloc_traits::select_on_container_copy_construction(
+	          other.alloc)) {
+		for (const T &x : other)
+			push_back(x);
+	}
+
+	tiered_deque(tiered_deque &&other)
+	    : alloc(std::move(other.alloc)), nodes(std::move(other.nodes)),
+	      tree(std::move(other.tree)), sz(std::exchange(other.sz, 0)) {}
+
+	tiered_deque &operator=(const tiered_deque &other) {
+		if (this != &other) {
+			clear();
+			for (const T &x : other)
+				push_back(x);
+		}
+		return *this;
+	}
+
+	tiered_deque &operator=(tiered_deque &&other) {
+		if (this != &other) {
+			clear();
+			std::swap(nodes, other.nodes);
+			std::swap(tree, other.tree);
+			std::swap(sz, other.sz);
+		}
+		return *this;
+	}
+
+	~tiered_deque() { clear(); }
+
+	allocator_type get_allocator() const { return allocator_type(alloc); }
+
+	// elements per block
+	static constexpr size_type block_size() { return block_elems; }
+
+	size_type size() const { return sz; }
+
+	bool empty() const { return sz == 0; }
+
+	// blocks in use, for tests and occupancy checks
+	size_type block_count() const { return nodes.size(); }
+
+	iterator begin() { return make_iter<iterator>(this, 0, 0); }
+
+	const_iterator begin() const {
+		return make_iter<const_iterator>(this, 0, 0);
+	}
+
+	iterator end() { return make_end<iterator>(this); }
+
+	const_iterator end() const { return make_end<const_iterator>(this); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	const_iterator cend() const { return end(); }
+
+	reference operator[](size_type pos) { return *locate(pos); }
+
+	const_reference operator[](size_type pos) const {
+		return *const_cast<tiered_deque *>(this)->locate(pos);
+	}
+
+	reference at(size_type pos) {
+		if (pos >= sz)
+			throw std::out_of_range("tiered_deque::at");
+		return (*this)[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		if (pos >= sz)
+			throw std::out_of_range("tiered_deque::at");
+		return (*this)[pos];
+	}
+
+	reference front() { return nodes.front().data[nodes.front().first]; }
+
+	const_reference front() const {
+		return nodes.front().data[nodes.front().first];
+	}
+
+	reference back() { return nodes.back().data[nodes.back().last - 1]; }
+
+	const_reference back() const {
+		return nodes.back().data[nodes.back().last - 1];
+	}
+
+	void clear() {
+		for (node &n : nodes) {
+			destroy_range(n.data + n.first, n.data + n.last);
+			T_alloc_traits::deallocate(alloc, n.data, block_elems);
+		}
+		nodes.clear();
+		tree.clear();
+		sz = 0;
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	void push_front(const T &value) { emplace_front(value); }
+
+	void push_front(T &&value) { emplace_front(std::move(value)); }
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		if (nodes.empty() || nodes.back().last == block_elems)
+			append_node(0);
+		node &n = nodes.back();
+		T *p    = n.data + n.last;
+		T_alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+		++n.last;
+		grew(nodes.size() - 1, 1);
+		return *p;
+	}
+
+	template <typename... Args> reference emplace_front(Args &&...args) {
+		if (nodes.empty() || nodes.front().first == 0)
+			insert_node(0, block_elems);
+		node &n = nodes.front();
+		T *p    = n.data + n.first - 1;
+		T_alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+		--n.first;
+		grew(0, 1);
+		return *p;
+	}
+
+	void pop_back() { erase_at(nodes.size() - 1, nodes.back().size() - 1); }
+
+	void pop_front() { erase_at(0, 0); }
+
+	iterator insert(const_iterator pos, const T &value) {
+		return emplace(pos, value);
+	}
+
+	iterator insert(const_iterator pos, T &&value) {
+		return emplace(pos, std::move(value));
+	}
+
+	template <typename... Args>
+	iterator emplace(const_iterator pos, Args &&...args) {
+		size_type index = pos.index();
+		if (index == sz) {
+			emplace_back(std::forward<Args>(args)...);
+			return iter_at(index);
+		}
+		// args may refer to an element that is about to move
+		T tmp(std::forward<Args>(args)...);
+		auto [blk, off] = find(index);
+		if (nodes[blk].size() == block_elems) {
+			split(blk);
+			std::tie(blk, off) = find(index);
+		}
+		node &n = nodes[blk];
+		T *p    = n.data + n.first + off;
+		bool left =
+		    n.last == block_elems || (n.first > 0 && off < n.size() / 2);
+		if (left) {
+			// elements before p go down one slot
+			T *f = n.data + n.first;
+			if (p == f) {
+				T_alloc_traits::construct(alloc, f - 1, std::move(tmp));
+			} else {
+				T_alloc_traits::construct(alloc, f - 1, std::move(*f));
+				std::move(f + 1, p, f);
+				p[-1] = std::move(tmp);
+			}
+			--n.first;
+		} else {
+			// elements from p go up one slot
+			T *l = n.data + n.last;
+			if (p == l) {
+				T_alloc_traits::construct(alloc, l, std::move(tmp));
+			} else {
+				T_alloc_traits::construct(alloc, l, std::move(l[-1]));
+				std::move_backward(p, l - 1, l);
+				*p = std::move(tmp);
+			}
+			++n.last;
+		}
+		grew(blk, 1);
+		return iter_at(index);
+	}
+
+	iterator erase(const_iterator pos) {
+		size_type index = pos.index();
+		auto [blk, off] = find(index);
+		erase_at(blk, off);
+		return iter_at(index);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		size_type index = first.index();
+		for (difference_type n = last - first; n > 0; --n) {
+			auto [blk, off] = find(index);
+			erase_at(blk, off);
+		}
+		return iter_at(index);
+	}
+
+private:
+	template <typename, bool> friend class tiered_deque_iterator;
+
+	T *allocate_block() { return T_alloc_traits::allocate(alloc, block_elems); }
+
+	// empty block whose run starts at slot at
+	void append_node(size_type at) {
+		nodes.push_back({allocate_block(), at, at});
+		if (tree.empty())
+			tree.push_back(0);
+		// Fenwick entry i covers blocks (i - lowbit(i), i]; the new one is
+		// empty, so it sums the blocks already there
+		size_type i = nodes.size();
+		tree.push_back(prefix(i - 1) - prefix(i - (i & -i)));
+	}
+
+	void insert_node(size_type blk, size_type at) {
+		nodes.insert(nodes.begin() + blk, {allocate_block(), at, at});
+		rebuild();
+	}
+
+	void remove_node(size_type blk) {
+		T_alloc_traits::deallocate(alloc, nodes[blk].data, block_elems);
+		nodes.erase(nodes.begin() + blk);
+		rebuild();
+	}
+
+	/* Fenwick tree over the block sizes, 1-based */
+
+	void rebuild() {
+		tree.clear();
+		tree.resize(nodes.size() + 1, 0);
+		for (size_type i = 1; i <= nodes.size(); ++i) {
+			tree[i] += nodes[i - 1].size();
+			size_type j = i + (i & -i);
+			if (j <= nodes.size())
+				tree[j] += tree[i];
+		}
+	}
+
+	// delta may wrap around: the sums are modular
+	void grew(size_type blk, size_type delta) {
+		for (size_type i = blk + 1; i < tree.size(); i += i & -i)
+			tree[i] += delta;
+		sz += delta;
+	}
+
+	// elements in blocks [0, blk)
+	size_type prefix(size_type blk) const {
+		size_type sum = 0;
+		for (; blk > 0; blk -= blk & -blk)
+			sum += tree[blk];
+		return sum;
+	}
+
+	// block and offset in its run of element pos < size()
+	std::pair<size_type, size_type> find(size_type pos) const {
+		size_type blk  = 0;
+		size_type step = std::bit_floor(nodes.size());
+		for (; step; step >>= 1) {
+			if (blk + step <= nodes.size() && tree[blk + step] <= pos) {
+				blk += step;
+				pos -= tree[blk];
+			}
+		}
+		return {blk, pos};
+	}
+
+	T *locate(size_type pos) {
+		auto [blk, off] = find(pos);
+		return nodes[blk].data + nodes[blk].first + off;
+	}
+
+	// iterator at element i of the run of block blk
+	template <typename It, typename Self>
+	static It make_iter(Self *self, size_type blk, size_type i) {
+		if (self->nodes.empty())
+			return It(self, 0, nullptr, nullptr);
+		const node &n = self->nodes[blk];
+		return It(self, blk, n.data + n.first + i, n.data + n.last);
+	}
+
+	template <typename It, typename Self> static It make_end(Self *self) {
+		if (self->nodes.empty())
+			return It(self, 0, nullptr, nullptr);
+		return make_iter<It>(self, self->nodes.size() - 1,
+		                     self->nodes.back().size());
+	}
+
+	iterator iter_at(size_type pos) {
+		if (pos >= sz)
+			return end();
+		auto [blk, off] = find(pos);
+		return make_iter<iterator>(this, blk, off);
+	}
+
+	const_iterator iter_at(size_type pos) const {
+		if (pos >= sz)
+			return end();
+		auto [blk, off] = find(pos);
+		return make_iter<const_iterator>(this, blk, off);
+	}
+
+	// move the upper half of a full block to a new block after it, centered
+	void split(size_type blk) {
+		nodes.insert(nodes.begin() + blk + 1, {allocate_block(), 0, 0});
+		node &lo = nodes[blk], &hi = nodes[blk + 1];
+		size_type keep  = lo.size() / 2;
+		size_type moved = lo.size() - keep;
+		hi.first = hi.last = (block_elems - moved) / 2;
+		T *from            = lo.data + lo.first + keep;
+		relocate(from, lo.data + lo.last, hi.data + hi.first);
+		hi.last += moved;
+		lo.last -= moved;
+		rebuild();
+	}
+
+	void erase_at(size_type blk, size_type off) {
+		node &n = nodes[blk];
+		T *p    = n.data + n.first + off;
+		if (off < n.size() / 2) {
+			std::move_backward(n.data + n.first, p, p + 1);
+			T_alloc_traits::destroy(alloc, n.data + n.first);
+			++n.first;
+		} else {
+			std::move(p + 1, n.data + n.last, p);
+			T_alloc_traits::destroy(alloc, n.data + n.last - 1);
+			--n.last;
+		}
+		grew(blk, size_type(-1));
+
+		if (n.size() == 0)
+			remove_node(blk);
+		else if (n.size() < block_elems / 4)
+			merge_around(blk);
+	}
+
+	// fold a sparse block into a neighbour if both fit in half a block
+	void merge_around(size_type blk) {
+		if (blk + 1 < nodes.size() &&
+		    nodes[blk].size() + nodes[blk + 1].size() <= block_elems / 2)
+			merge(blk);
+		else if (blk > 0 &&
+		         nodes[blk - 1].size() + nodes[blk].size() <= block_elems / 2)
+			merge(blk - 1);
+	}
+
+	// append the elements of block blk + 1 to block blk
+	void merge(size_type blk) {
+		node &a = nodes[blk], &b = nodes[blk + 1];
+		if (a.last + b.size() > block_elems)
+			shift_down(a, (block_elems - a.size() - b.size()) / 2);
+		relocate(b.data + b.first, b.data + b.last, a.data + a.last);
+		a.last += b.size();
+		b.last = b.first;
+		remove_node(blk + 1);
+	}
+
+	// move the run of n down to start at slot to < n.first
+	void shift_down(node &n, size_type to) {
+		T *src = n.data + n.first, *dst = n.data + to;
+		size_type count = n.size();
+		for (size_type i = 0; i < count; ++i) {
+			if (dst + i < src)
+				T_alloc_traits::construct(alloc, dst + i, std::move(src[i]));
+			else
+				dst[i] = std::move(src[i]);
+		}
+		destroy_range(std::max(dst + count, src), src + count);
+		n.first = to;
+		n.last  = to + count;
+	}
+
+	void destroy_range(T *first, T *last) {
+		for (; first != last; ++first)
+			T_alloc_traits::destroy(alloc, first);
+	}
+
+	// move [first, last) into raw slots at dst and destroy the originals
+	void relocate(T *first, T *last, T *dst) {
+		for (T *p = first; p != last; ++p, ++dst)
+			T_alloc_traits::construct(alloc, dst, std::move(*p));
+		destroy_range(first, last);
+	}
+
+	[[no_unique_address]] T_alloc_type alloc;
+	::vector<node> nodes;
+	::vector<size_type> tree; // tree[0] unused
+	size_type sz = 0;
+};
+
+} // namespace tp
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <intrusive_list.hpp>
+#include <list.hpp>
+
+namespace tp {
+
+// embed in an object to put it on a timer_wheel
+struct timer_hook : auto_unlink_hook {
+	std::uint64_t expires = 0; // tick, set by schedule()
+};
+
+/*
+ * Hierarchical timing wheel (Varghese & Lauck) over intrusive timers:
+ * timer_wheel<conn, &conn::timer>, where conn has a timer_hook member.
+ *
+ * Level l has 2^SlotBits buckets, each a list_node_base sentinel, and a
+ * bucket of level l covers 2^(SlotBits * l) ticks. A timer goes to the
+ * level of the highest SlotBits-wide digit in which its expiry differs
+ * from the current tick, and to the bucket of its expiry's digit there:
+ * hooking it in is O(1) and so is cancelling, by unhooking. When the low
+ * digits of the current tick wrap to zero, the bucket of the next level
+ * that has just been reached is moved out whole with transfer() and its
+ * timers are placed again, now on lower levels; every timer is moved at
+ * most Levels - 1 times before it fires.
+ *
+ * The default 4 levels x 256 slots span 2^32 ticks. A timer further out
+ * waits in the top level and is placed again when that bucket comes up.
+ * A bitmap of the buckets that may hold timers lets advance() jump over
+ * ticks that reach none, so a sparse wheel can move far ahead cheaply.
+ *
+ * Timers are auto-unlink hooks: one that is destroyed or unlinked leaves
+ * the wheel by itself. The wheel does not count its timers for the same
+ * reason.
+ */
+template <typename T, auto Hook, unsigned Levels = 4, unsigned SlotBits = 8>
+class timer_wheel {
+	using traits = detail::hook_traits<decltype(Hook)>;
+
+	static_assert(std::is_same_v<typename traits::value_type, T>);
+	static_assert(std::is_same_v<typename traits::hook_type, timer_hook>);
+	static_assert(Levels >= 2 && SlotBits >= 1 && Levels * SlotBits < 64);
+
+	static constexpr std::size_t slots  = std::size_t(1) << SlotBits;
+	static constexpr std::uint64_t mask = slots - 1;
+	static constexpr unsigned span_bits = Levels * SlotBits;
+
+public:
+	explicit timer_wheel(std::uint64_t now = 0) : cur(now) {
+		for (auto &level : buckets)
+			for (list_node_base &b : level)
+				b._next = b._prev = &b;
+	}
+
+	timer_wheel(const timer_wheel &)            = delete;
+	timer_wheel &operator=(const timer_wheel &) = delete;
+
+	// pending timers are unlinked, not fired
+	~timer_wheel() {
+		for (auto &level : buckets)
+			for (list_node_base &b : level)
+				unlink_all(b);
+	}
+
+	std::uint64_t now() const { return cur; }
+
+	/*
+	 * Fire t at tick expires; an expiry that is not in the future fires on
+	 * the next tick. A pending timer is moved.
+	 */
+	void schedule(T &t, std::uint64_t expires) {
+		timer_hook &h = t.*Hook;
+		h.unlink();
+		h.expires = expires > cur ? expires : cur + 1;
+		place(h);
+	}
+
+	void cancel(T &t) { (t.*Hook).unlink(); }
+
+	static bool pending(const T &t) { return (t.*Hook).is_linked(); }
+
+	/*
+	 * Move the current tick up to to, calling on_expire(T &) for every
+	 * timer that comes due, in tick order. A timer is unlinked before its
+	 * callback runs, which may schedule or cancel any timer, this one
+	 * included, or destroy it. Returns the number of timers fired.
+	 */
+	template <typename F> std::size_t advance(std::uint64_t to, F &&on_expire) {
+		std::size_t fired = 0;
+		while (cur < to) {
+			if (empty(buckets[0][(cur + 1) & mask])) {
+				// skip the ticks that reach no timer
+				std::uint64_t next = next_event();
+				if (next > to) {
+					cur = to;
+					break;
+				}
+				cur = next - 1;
+			}
+			++cur;
+			if ((cur & mask) == 0)
+				cascade();
+			fired += expire(0, cur & mask, on_expire);
+		}
+		return fired;
+	}
+
+private:
+	static T *owner(list_node_base *nd) {
+		return intrusive_list_iterator<Hook, false>::owner(nd);
+	}
+
+	static std::size_t digit(std::uint64_t tick, unsigned level) {
+		return (tick >> (SlotBits * level)) & mask;
+	}
+
+	// level: the highest digit in which expires differs from now
+	void place(timer_hook &h) {
+		std::uint64_t diff = h.expires ^ cur;
+		unsigned level;
+		std::size_t slot;
+		if ((h.expires - cur) >> span_bits) {
+			// beyond the span: park in the top bucket that comes up last
+			level = Levels - 1;
+			slot  = (digit(cur, level) - 1) & mask;
+		} else if (diff >> span_bits) {
+			// within the span, but across a turn of the top level
+			level = Levels - 1;
+			slot  = digit(h.expires, level);
+		} else {
+			// diff is 0 only for a timer cascaded down on its own tick
+			level = diff ? (std::bit_width(diff) - 1) / SlotBits : 0;
+			slot  = digit(h.expires, level);
+		}
+		h.hook(&buckets[level][slot]);
+		occupied[level][slot / 64] |= std::uint64_t(1) << slot % 64;
+	}
+
+	// first maybe occupied slot of level in [first, last), or last
+	std::size_t find_slot(unsigned level, std::size_t first,
+	                      std::size_t last) const {
+		while (first < last) {
+			std::uint64_t bits = occupied[level][first / 64] >> first % 64;
+			if (bits) {
+				std::size_t s = first + std::countr_zero(bits);
+				return s < last ? s : last;
+			}
+			first = (first / 64 + 1) * 64;
+		}
+		return last;
+	}
+
+	/*
+	 * The first tick after now that reaches a maybe occupied bucket, or
+	 * UINT64_MAX. Bucket s of level l is reached when digit l of the tick
+	 * is s and the digits below it are zero.
+	 */
+	std::uint64_t next_event() const {
+		std::uint64_t next = UINT64_MAX;
+		for (unsigned level = 0; level < Levels; ++level) {
+			std::size_t d = digit(cur, level);
+			std::size_t s = find_slot(level, d + 1, slots);
+			if (s == slots && (s = find_slot(level, 0, d + 1)) == d + 1)
+				continue;
+			std::uint64_t unit   = std::uint64_t(1) << (SlotBits * level);
+			std::uint64_t period = unit << SlotBits;
+			std::uint64_t t      = cur - cur % period + s * unit;
+			if (t <= cur)
+				t += period;
+			if (t < next)
+				next = t;
+		}
+		return next;
+	}
+
+	/*
+	 * The low digits of cur just became zero: starting from the highest
+	 * level reached, move each reached bucket out and spread its timers
+	 * over the levels below.
+	 */
+	void cascade() {
+		unsigned top = 1;
+		while (top + 1 < Levels &&
+		       ((cur >> (SlotBits * top)) & mask) == 0)
+			++top;
+		for (unsigned level = top; level >= 1; --level) {
+			std::size_t slot  = digit(cur, level);
+			list_node_base &b = buckets[level][slot];
+			occupied[level][slot / 64] &= ~(std::uint64_t(1) << slot % 64);
+			if (empty(b))
+				continue;
+			list_node_base moving;
+			moving._next = moving._prev = &moving;
+			moving.transfer(b._next, &b);
+			while (moving._next != &moving) {
+				timer_hook &h = *static_cast<timer_hook *>(moving._next);
+				h.unlink();
+				place(h);
+			}
+		}
+	}
+
+	template <typename F>
+	std::size_t expire(unsigned level, std::size_t slot, F &on_expire) {
+		list_node_base &b = buckets[level][slot];
+		occupied[level][slot / 64] &= ~(std::uint64_t(1) << slot % 64);
+		if (empty(b))
+			return 0;
+		// detach the bucket first: callbacks may reschedule into it
+		list_node_base due;
+		due._next = due._prev = &due;
+		due.transfer(b._next, &b);
+		std::size_t fired = 0;
+		while (due._next != &due) {
+			timer_hook &h = *static_cast<timer_hook *>(due._next);
+			h.unlink();
+			++fired;
+			on_expire(*owner(&h));
+		}
+		return fired;
+	}
+
+	static bool empty(const list_node_base &b) { return b._next == &b; }
+
+	static void unlink_all(list_node_base &b) {
+		while (!empty(b))
+			static_cast<timer_hook *>(b._next)->unlink();
+	}
+
+	static constexpr std::size_t words = (slots + 63) / 64;
+
+	list_node_base buckets[Levels][slots];
+	// a bit per bucket, set when a timer goes in and cleared when the
+	// bucket comes up; unlinked timers leave stale bits behind
+	std::uint64_t occupied[Levels][words] = {};
+	std::uint64_t cur;
+};
+
+} // namespace tp
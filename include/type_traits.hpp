@@ -0,0 +1,27 @@
+#pragma once
+
+#include <type_traits>
+
+namespace tp {
+
+/*
+ * A type is trivially relocatable when moving an object to a new address and
+ * ending the lifetime of the source is equivalent to copying its bytes.
+ * Containers use it to grow and shift elements with memcpy/memmove instead of
+ * element-wise move construction + destruction.
+ *
+ * Defaults to std::is_trivially_copyable. Types that are not trivially
+ * copyable but can still be moved bitwise (e.g. most types holding a
+ * unique_ptr) may opt in:
+ *
+ *     template <> struct tp::is_trivially_relocatable<my_type>
+ *         : std::true_type {};
+ */
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+} // namespace tp
@@ -0,0 +1,599 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <iterator.hpp>
+#include <list.hpp>
+
+namespace tp {
+
+namespace detail {
+
+// the header of a list is a bare base with count 0; real nodes never are
+struct unrolled_node_base : list_node_base {
+	std::size_t count = 0;
+};
+
+template <typename T, std::size_t N> struct unrolled_node : unrolled_node_base {
+	using value_type = T;
+
+	T *data() { return std::launder(reinterpret_cast<T *>(storage)); }
+
+	alignas(T) unsigned char storage[N * sizeof(T)];
+};
+
+} // namespace detail
+
+template <typename Node, bool Const> class unrolled_list_iterator {
+	using base_node = detail::unrolled_node_base;
+
+public:
+	using value_type      = typename Node::value_type;
+	using difference_type = std::ptrdiff_t;
+	using pointer =
+	    std::conditional_t<Const, const value_type *, value_type *>;
+	using reference =
+	    std::conditional_t<Const, const value_type &, value_type &>;
+	using iterator_category = std::bidirectional_iterator_tag;
+
+	unrolled_list_iterator() = default;
+
+	// element i of node nd, or the end if nd is the header
+	unrolled_list_iterator(list_node_base *nd, std::size_t i) {
+		set_node(nd, i);
+	}
+
+	operator unrolled_list_iterator<Node, true>() const requires(!Const) {
+		return {node, cur, run_end};
+	}
+
+	reference operator*() const { return *cur; }
+
+	pointer operator->() const { return cur; }
+
+	unrolled_list_iterator &operator++() {
+		if (++cur == run_end)
+			set_node(node->_next, 0);
+		return *this;
+	}
+
+	unrolled_list_iterator operator++(int) {
+		unrolled_list_iterator tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	unrolled_list_iterator &operator--() {
+		if (!cur || cur == run_end - count())
+			set_node(node->_prev, count_of(node->_prev) - 1);
+		else
+			--cur;
+		return *this;
+	}
+
+	unrolled_list_iterator operator--(int) {
+		unrolled_list_iterator tmp = *this;
+		--*this;
+		return tmp;
+	}
+
+	friend bool operator==(const unrolled_list_iterator &a,
+	                       const unrolled_list_iterator &b) {
+		return a.cur == b.cur && a.node == b.node;
+	}
+
+private:
+	template <typename, bool> friend class unrolled_list_iterator;
+	template <typename, typename, std::size_t> friend class unrolled_list;
+
+	unrolled_list_iterator(list_node_base *nd, pointer cur, pointer run_end)
+	    : node(nd), cur(cur), run_end(run_end) {}
+
+	static std::size_t count_of(list_node_base *nd) {
+		return static_cast<base_node *>(nd)->count;
+	}
+
+	std::size_t count() const { return count_of(node); }
+
+	// offset of cur within its node
+	std::size_t offset() const { return cur ? count() - (run_end - cur) : 0; }
+
+	void set_node(list_node_base *nd, std::size_t i) {
+		node = nd;
+		if (count_of(nd) == 0) {
+			cur = run_end = nullptr;
+			return;
+		}
+		pointer d = static_cast<Node *>(nd)->data();
+		cur       = d + i;
+		run_end   = d + count_of(nd);
+	}
+
+	list_node_base *node = nullptr;
+	pointer cur          = nullptr;
+	pointer run_end      = nullptr; // end of the elements of node
+};
+
+/*
+ * Doubly linked list of small arrays.
+ *
+ * Every node holds up to node_elems elements, packed at its front, in
+ * about NodeBytes (one to four cache lines is the useful range): a scan
+ * walks arrays and chases a pointer once per node, and the links cost two
+ * pointers per node rather than per element.
+ *
+ * Inserting into a full node splits it in halves; an erase that leaves a
+ * node under a quarter full merges it with a neighbour when the two fit in
+ * one node. Both move at most one node's worth of elements. The nodes are
+ * linked like tp::list nodes, so a splice moves whole nodes in O(1),
+ * splitting the node at pos (and at first and last) when those fall
+ * inside a node.
+ *
+ * Insert and erase invalidate iterators into the nodes they touch, which
+ * are the node of pos and its neighbours; iterators into other nodes stay
+ * valid, and so do all iterators after a splice, apart from those into a
+ * split node.
+ */
+template <typename T, typename Alloc = std::allocator<T>,
+          std::size_t NodeBytes = 256>
+class unrolled_list {
+public:
+	static constexpr std::size_t node_elems = std::max<std::size_t>(
+	    1, (NodeBytes - sizeof(detail::unrolled_node_base)) / sizeof(T));
+
+private:
+	using node_base = detail::unrolled_node_base;
+	using node      = detail::unrolled_node<T, node_elems>;
+	using Node_alloc_type =
+	    typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+	using Node_alloc_traits = std::allocator_traits<Node_alloc_type>;
+
+public:
+	using value_type             = T;
+	using allocator_type         = Alloc;
+	using size_type              = std::size_t;
+	using difference_type        = std::ptrdiff_t;
+	using reference              = value_type &;
+	using const_reference        = const value_type &;
+	using iterator               = unrolled_list_iterator<node, false>;
+	using const_iterator         = unrolled_list_iterator<node, true>;
+	using reverse_iterator       = tp::reverse_iterator<iterator>;
+	using const_reverse_iterator = tp::reverse_iterator<const_iterator>;
+
+	unrolled_list() { init(); }
+
+	explicit unrolled_list(const Alloc &alloc) : impl(Node_alloc_type(alloc)) {
+		init();
+	}
+
+	unrolled_list(size_type count, const T &value,
+	              const Alloc &alloc = Alloc())
+	    : unrolled_list(alloc) {
+		for (size_type i = 0; i < count; ++i)
+			emplace_back(value);
+	}
+
+	template <typename InputIt>
+	requires tp::is_iterator<InputIt>
+	unrolled_list(InputIt first, InputIt last, const Alloc &alloc = Alloc())
+	    : unrolled_list(alloc) {
+		for (; first != last; ++first)
+			emplace_back(*first);
+	}
+
+	unrolled_list(std::initializer_list<T> init, const Alloc &alloc = Alloc())
+	    : unrolled_list(init.begin(), init.end(), alloc) {}
+
+	unrolled_list(const unrolled_list &other)
+	    : unrolled_list(other.begin(), other.end(),
+	                    Node_alloc_traits::select_on_container_copy_construction(
+	                        other.get_Node_allocator())) {}
+
+	unrolled_list(unrolled_list &&other)
+	    : impl(Node_alloc_type(other.get_Node_allocator())) {
+		init();
+		take_nodes(other);
+	}
+
+	~unrolled_list() { clear(); }
+
+	unrolled_list &operator=(const unrolled_list &other) {
+		if (this != &other) {
+			clear();
+			if constexpr (Node_alloc_traits::
+			                  propagate_on_container_copy_assignment::value)
+				get_Node_allocator() = other.get_Node_allocator();
+			for (const T &x : other)
+				emplace_back(x);
+		}
+		return *this;
+	}
+
+	unrolled_list &operator=(unrolled_list &&other) {
+		if (this != &other) {
+			clear();
+			if constexpr (Node_alloc_traits::
+			                  propagate_on_container_move_assignment::value)
+				get_Node_allocator() = other.get_Node_allocator();
+			if (get_Node_allocator() == other.get_Node_allocator()) {
+				take_nodes(other);
+			} else {
+				for (T &x : other)
+					emplace_back(std::move(x));
+				other.clear();
+			}
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const {
+		return allocator_type(get_Node_allocator());
+	}
+
+	iterator begin() { return iterator(impl.header._next, 0); }
+
+	const_iterator begin() const { return const_iterator(first_node(), 0); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(&impl.header, 0); }
+
+	const_iterator end() const { return const_iterator(header(), 0); }
+
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(--end()); }
+
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(--end());
+	}
+
+	reverse_iterator rend() { return reverse_iterator(end()); }
+
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(end());
+	}
+
+	bool empty() const { return impl.size == 0; }
+
+	size_type size() const { return impl.size; }
+
+	reference front() { return *begin(); }
+
+	const_reference front() const { return *begin(); }
+
+	reference back() { return *--end(); }
+
+	const_reference back() const { return *--end(); }
+
+	void clear() {
+		list_node_base *cur = impl.header._next;
+		while (cur != &impl.header) {
+			node *n = static_cast<node *>(cur);
+			cur     = cur->_next;
+			std::destroy_n(n->data(), n->count);
+			free_node(n);
+		}
+		init();
+	}
+
+	template <typename... Args> reference emplace_back(Args &&...args) {
+		// the common case: room at the end of the last node
+		if (node *last = real_node(impl.header._prev);
+		    last && last->count < node_elems) {
+			T *p = last->data() + last->count;
+			Node_alloc_traits::construct(get_Node_allocator(), p,
+			                             std::forward<Args>(args)...);
+			++last->count;
+			++impl.size;
+			return *p;
+		}
+		return *emplace(cend(), std::forward<Args>(args)...);
+	}
+
+	template <typename... Args> reference emplace_front(Args &&...args) {
+		return *emplace(cbegin(), std::forward<Args>(args)...);
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	void push_front(const T &value) { emplace_front(value); }
+
+	void push_front(T &&value) { emplace_front(std::move(value)); }
+
+	void pop_back() { erase(--cend()); }
+
+	void pop_front() { erase(cbegin()); }
+
+	iterator insert(const_iterator pos, const T &value) {
+		return emplace(pos, value);
+	}
+
+	iterator insert(const_iterator pos, T &&value) {
+		return emplace(pos, std::move(value));
+	}
+
+	template <typename... Args>
+	iterator emplace(const_iterator pos, Args &&...args) {
+		node_base *at = static_cast<node_base *>(pos.node);
+		size_type off = pos.offset();
+		node *n       = nullptr;
+		if (off == 0) {
+			// before a node (or at the end): append to the previous one if
+			// it has room, else start a node between the two
+			if (node *prev = real_node(at->_prev);
+			    prev && prev->count < node_elems) {
+				n   = prev;
+				off = prev->count;
+			} else if (at == &impl.header || at->count == node_elems) {
+				n = make_node();
+				n->hook(at);
+			}
+		}
+		if (!n) {
+			n = static_cast<node *>(at);
+			if (n->count == node_elems) {
+				// args may refer to an element that the split moves
+				T value(std::forward<Args>(args)...);
+				size_type half = node_elems / 2;
+				node *right    = split(n, half);
+				if (off > half) {
+					n = right;
+					off -= half;
+				}
+				insert_at(n, off, std::move(value));
+				++impl.size;
+				return iterator(n, off);
+			}
+		}
+
+		insert_at(n, off, std::forward<Args>(args)...);
+		++impl.size;
+		return iterator(n, off);
+	}
+
+	iterator erase(const_iterator pos) {
+		node *n       = static_cast<node *>(pos.node);
+		size_type off = pos.offset();
+		T *d          = n->data();
+		std::move(d + off + 1, d + n->count, d + off);
+		std::destroy_at(d + n->count - 1);
+		--n->count;
+		--impl.size;
+
+		if (n->count == 0) {
+			list_node_base *next = n->_next;
+			n->unhook();
+			free_node(n);
+			return iterator(next, 0);
+		}
+		if (n->count * 4 < node_elems) {
+			if (node *next = real_node(n->_next);
+			    next && n->count + next->count <= node_elems) {
+				absorb(n, next);
+			} else if (node *prev = real_node(n->_prev);
+			           prev && prev->count + n->count <= node_elems) {
+				off += prev->count;
+				absorb(prev, n);
+				n = prev;
+			}
+		}
+		if (off == n->count)
+			return iterator(n->_next, 0);
+		return iterator(n, off);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		// merges move elements under last; count first
+		difference_type n = std::distance(first, last);
+		iterator it       = remove_const(first);
+		for (; n > 0; --n)
+			it = erase(it);
+		return it;
+	}
+
+	/*
+	 * Splices link whole nodes into this list; elements are only moved by
+	 * the split of a node that pos, first or last points into. The
+	 * allocators have to compare equal.
+	 */
+
+	// all of other, O(1)
+	void splice(const_iterator pos, unrolled_list &other) {
+		assert(get_Node_allocator() == other.get_Node_allocator());
+		if (other.empty() || &other == this)
+			return;
+		list_node_base *at = split_before(pos);
+		at->transfer(other.impl.header._next, &other.impl.header);
+		impl.size += other.impl.size;
+		other.impl.size = 0;
+	}
+
+	void splice(const_iterator pos, unrolled_list &&other) {
+		splice(pos, other);
+	}
+
+	// [first, last) of other, O(nodes in the range) to count the elements
+	void splice(const_iterator pos, unrolled_list &other, const_iterator first,
+	            const_iterator last) {
+		assert(get_Node_allocator() == other.get_Node_allocator());
+		if (first == last)
+			return;
+		// take the offsets up front: a split moves the elements after the
+		// split point, and with them positions in the same node
+		split_point f{first.node, first.offset()};
+		split_point l{last.node, last.offset()};
+		split_point p{pos.node, pos.offset()};
+		list_node_base *start = other.split_at(f);
+		l.follow(f, start);
+		p.follow(f, start);
+		list_node_base *stop = other.split_at(l);
+		p.follow(l, stop);
+		size_type moved = 0;
+		for (list_node_base *nd = start; nd != stop; nd = nd->_next)
+			moved += static_cast<node_base *>(nd)->count;
+		list_node_base *at = split_at(p);
+		at->transfer(start, stop);
+		other.impl.size -= moved;
+		impl.size += moved;
+	}
+
+	void splice(const_iterator pos, unrolled_list &&other, const_iterator first,
+	            const_iterator last) {
+		splice(pos, other, first, last);
+	}
+
+	void swap(unrolled_list &other) {
+		if constexpr (Node_alloc_traits::propagate_on_container_swap::value) {
+			using std::swap;
+			swap(get_Node_allocator(), other.get_Node_allocator());
+		}
+		unrolled_list tmp(get_Node_allocator());
+		tmp.take_nodes(*this);
+		take_nodes(other);
+		other.take_nodes(tmp);
+	}
+
+	// number of nodes; size() / node_count() is the average fill
+	size_type node_count() const {
+		size_type n = 0;
+		for (const list_node_base *nd = impl.header._next; nd != header();
+		     nd = nd->_next)
+			++n;
+		return n;
+	}
+
+	friend bool operator==(const unrolled_list &a, const unrolled_list &b) {
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+	}
+
+private:
+	struct unrolled_impl : public Node_alloc_type {
+		node_base header;
+		size_type size = 0;
+
+		unrolled_impl() : Node_alloc_type() {}
+
+		unrolled_impl(const Node_alloc_type &a) : Node_alloc_type(a) {}
+	};
+
+	unrolled_impl impl;
+
+	Node_alloc_type &get_Node_allocator() { return impl; }
+
+	const Node_alloc_type &get_Node_allocator() const { return impl; }
+
+	void init() {
+		impl.header._next = impl.header._prev = &impl.header;
+		impl.size                             = 0;
+	}
+
+	// the const begin/end still hand out a mutable node pointer
+	list_node_base *header() const {
+		return const_cast<node_base *>(&impl.header);
+	}
+
+	list_node_base *first_node() const { return impl.header._next; }
+
+	node *real_node(list_node_base *nd) {
+		return nd == &impl.header ? nullptr : static_cast<node *>(nd);
+	}
+
+	static iterator remove_const(const_iterator it) {
+		return iterator(it.node, it.offset());
+	}
+
+	// append all nodes of other
+	void take_nodes(unrolled_list &other) {
+		if (other.empty())
+			return;
+		impl.header.transfer(other.impl.header._next, &other.impl.header);
+		impl.size += other.impl.size;
+		other.impl.size = 0;
+	}
+
+	node *make_node() {
+		node *n = Node_alloc_traits::allocate(get_Node_allocator(), 1);
+		return ::new (static_cast<void *>(n)) node;
+	}
+
+	void free_node(node *n) {
+		Node_alloc_traits::deallocate(get_Node_allocator(), n, 1);
+	}
+
+	template <typename... Args>
+	void insert_at(node *n, size_type off, Args &&...args) {
+		T *d = n->data();
+		if (off == n->count) {
+			Node_alloc_traits::construct(get_Node_allocator(), d + off,
+			                             std::forward<Args>(args)...);
+		} else {
+			// args may refer to an element that is about to move
+			T value(std::forward<Args>(args)...);
+			Node_alloc_traits::construct(get_Node_allocator(), d + n->count,
+			                             std::move(d[n->count - 1]));
+			std::move_backward(d + off, d + n->count - 1, d + n->count);
+			d[off] = std::move(value);
+		}
+		++n->count;
+	}
+
+	// move elements [at, count) of n into a new node after it
+	node *split(node *n, size_type at) {
+		node *right = make_node();
+		right->hook(n->_next);
+		std::uninitialized_move(n->data() + at, n->data() + n->count,
+		                        right->data());
+		std::destroy(n->data() + at, n->data() + n->count);
+		right->count = n->count - at;
+		n->count     = at;
+		return right;
+	}
+
+	// append the elements of next to n and drop next
+	void absorb(node *n, node *next) {
+		std::uninitialized_move(next->data(), next->data() + next->count,
+		                        n->data() + n->count);
+		std::destroy_n(next->data(), next->count);
+		n->count += next->count;
+		next->unhook();
+		free_node(next);
+	}
+
+	// the node pos is the first element of, splitting its node if needed
+	list_node_base *split_before(const_iterator pos) {
+		return split_at({pos.node, pos.offset()});
+	}
+
+	// a position kept as node and offset across splits
+	struct split_point {
+		list_node_base *node;
+		size_type off;
+
+		// s was split at its offset, moving the rest to node right
+		void follow(const split_point &s, list_node_base *right) {
+			if (node == s.node && s.off != 0 && off >= s.off) {
+				node = right;
+				off -= s.off;
+			}
+		}
+	};
+
+	list_node_base *split_at(const split_point &p) {
+		if (p.off == 0)
+			return p.node;
+		return split(static_cast<node *>(p.node), p.off);
+	}
+};
+
+} // namespace tp
@@ -1,11 +1,28 @@
 #pragma once
 
+#include <concepts>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <ranges>
 
+#include <growth_policy.hpp>
 #include <iterator.hpp>
-
-
-template <typename T, typename Alloc = std::allocator<T>> class vector {
+#include <memory.hpp>
+
+namespace tp {
+template <typename T, std::size_t N, typename Alloc, typename Growth>
+class small_vector;
+} // namespace tp
+
+/*
+ * Growth is a growth policy from growth_policy.hpp; it decides the new
+ * capacity on every growth path (push_back, emplace_back, insert, resize).
+ * reserve and shrink_to_fit still allocate exactly what is asked for.
+ */
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Growth = tp::doubling_growth>
+class vector {
 public:
 	using value_type      = T;
 	using allocator_type  = Alloc;
@@ -15,6 +32,7 @@ public:
 	using const_reference = const T &;
 	using pointer         = std::allocator_traits<Alloc>::pointer;
 	using const_pointer   = std::allocator_traits<Alloc>::const_pointer;
+	using growth_policy   = Growth;
 
 	/* class iterator;
 	 * class const_iterator;
@@ -81,9 +99,9 @@ public:
 	vector(vector &&other)
 	    : alloc(std::move(other.alloc)), sz(other.sz), cap(other.cap),
 	      _data(other._data) {
-		other.data = nullptr;
-		other.sz   = 0;
-		other.cap  = 0;
+		other._data = nullptr;
+		other.sz    = 0;
+		other.cap   = 0;
 	}
 
 	// dtor
@@ -281,7 +299,7 @@ public:
 	iterator insert(const_iterator pos, size_type count, const T &value);
 
 	template <typename InputIt>
-	requires is_iterator<InputIt> iterator insert(const_iterator pos,
+	requires tp::is_iterator<InputIt> iterator insert(const_iterator pos,
 	                                              InputIt first, InputIt last);
 
 	iterator insert(const_iterator pos, std::initializer_list<T> ilist);
@@ -318,29 +336,151 @@ public:
 
 	void resize(size_type count) {
 		if (sz > count) {
-			sz = count;
+			erase_at_end(_data + count);
 		} else if (sz < count) {
 			if (cap < count)
-				_data = reallocate(count);
-			for (size_type i = 0; i < count; ++i)
+				_data = grow(count);
+			for (; sz < count; ++sz)
 				// call default ctor
-				std::allocator_traits<Alloc>::construct(alloc, _data + i);
+				std::allocator_traits<Alloc>::construct(alloc, _data + sz);
 		}
 	}
 
 	void resize(size_type count, const value_type &value) {
 		if (sz > count)
-			sz = count;
+			erase_at_end(_data + count);
 		else if (sz < count) {
 			if (cap < count)
-				_data = reallocate(count);
-			for (size_type i = 0; i < count; ++i)
+				_data = grow(count);
+			for (; sz < count; ++sz)
 				// call copy ctor
-				std::allocator_traits<Alloc>::construct(alloc, _data + i,
+				std::allocator_traits<Alloc>::construct(alloc, _data + sz,
 				                                        value);
 		}
 	}
 
+	/*
+	 * Like resize(count), but new elements are default-initialized instead of
+	 * value-initialized: for trivial types their bytes are left as they are,
+	 * ready to be overwritten by read(), memcpy or a decoder.
+	 */
+	void resize_for_overwrite(size_type count) {
+		if (sz > count) {
+			erase_at_end(_data + count);
+		} else if (sz < count) {
+			if (cap < count)
+				_data = grow(count);
+			if constexpr (!std::is_trivially_default_constructible_v<T>) {
+				for (T *p = _data + sz; p != _data + count; ++p)
+					::new (static_cast<void *>(p)) T;
+			}
+			sz = count;
+		}
+	}
+
+	/*
+	 * Append the elements of rg. Sized ranges grow the buffer once; a
+	 * contiguous range of trivially copyable T is copied with memcpy.
+	 * Other input ranges (e.g. a std::istream_iterator view) are appended
+	 * one by one.
+	 */
+	template <std::ranges::input_range Range>
+	requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	void append_range(Range &&rg) {
+		if constexpr (std::ranges::contiguous_range<Range> &&
+		              std::ranges::sized_range<Range> &&
+		              std::is_same_v<std::ranges::range_value_t<Range>, T>) {
+			size_type count = std::ranges::size(rg);
+			const T *src    = std::ranges::data(rg);
+			if (sz + count > cap) {
+				// a source inside this vector moves with the elements
+				std::less<const T *> before;
+				if (!before(src, _data) && before(src, _data + sz)) {
+					size_type off = src - _data;
+					_data         = grow(sz + count);
+					src           = _data + off;
+				} else {
+					_data = grow(sz + count);
+				}
+			}
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				if (count)
+					std::memcpy(static_cast<void *>(_data + sz), src,
+					            count * sizeof(T));
+				sz += count;
+			} else {
+				for (const T *end = src + count; src != end; ++src, ++sz)
+					std::allocator_traits<Alloc>::construct(alloc, _data + sz,
+					                                        *src);
+			}
+		} else if constexpr (std::ranges::sized_range<Range>) {
+			size_type count = std::ranges::size(rg);
+			if (sz + count > cap) {
+				// the range may read from this vector: build the new
+				// elements before the old ones move
+				size_type new_cap =
+				    Growth::next_capacity(cap, sz + count, sizeof(T));
+				T *new_data =
+				    std::allocator_traits<Alloc>::allocate(alloc, new_cap);
+				T *p = new_data + sz;
+				try {
+					for (auto &&elem : rg) {
+						std::allocator_traits<Alloc>::construct(
+						    alloc, p, std::forward<decltype(elem)>(elem));
+						++p;
+					}
+				} catch (...) {
+					while (p != new_data + sz)
+						std::allocator_traits<Alloc>::destroy(alloc, --p);
+					std::allocator_traits<Alloc>::deallocate(alloc, new_data,
+					                                         new_cap);
+					throw;
+				}
+				relocate(_data, _data + sz, new_data);
+				std::allocator_traits<Alloc>::deallocate(alloc, _data, cap);
+				_data = new_data;
+				cap   = new_cap;
+				sz += count;
+				return;
+			}
+			for (auto &&elem : rg) {
+				std::allocator_traits<Alloc>::construct(
+				    alloc, _data + sz, std::forward<decltype(elem)>(elem));
+				++sz;
+			}
+		} else {
+			for (auto &&elem : rg)
+				emplace_back(std::forward<decltype(elem)>(elem));
+		}
+	}
+
+	/*
+	 * Make room for n more elements and let fn write them in place:
+	 *
+	 *     size_type fn(T *first, size_type n);
+	 *
+	 * fn constructs at most n elements at [first, first + n) and returns how
+	 * many it wrote (a void fn means all n), which lets a short read() append
+	 * only what it got. Trivial types may simply be assigned or memcpy'd;
+	 * other types must be constructed with placement new. Nothing is
+	 * zero-filled and there is no per-element capacity check.
+	 */
+	template <typename Fn>
+	requires std::invocable<Fn &, T *, size_type>
+	void append_uninitialized(size_type n, Fn fn) {
+		if (sz + n > cap)
+			_data = grow(sz + n);
+
+		if constexpr (std::is_void_v<std::invoke_result_t<Fn &, T *,
+		                                                  size_type>>) {
+			fn(_data + sz, n);
+			sz += n;
+		} else {
+			size_type written = fn(_data + sz, n);
+			sz += written < n ? written : n;
+		}
+	}
+
 	void swap(vector &other) {
 		std::swap(_data, other._data);
 		std::swap(sz, other.sz);
@@ -353,23 +493,52 @@ public:
 	}
 
 private:
-	T *reallocate() {
-		size_type new_cap = 2 * cap;
-		return reallocate(new_cap);
+	// small_vector hands its heap buffer to / takes it from a vector
+	template <typename, std::size_t, typename, typename>
+	friend class tp::small_vector;
+
+	T *reallocate() { return grow(sz + 1); }
+
+	// reallocate to the capacity the growth policy picks for `required`
+	T *grow(size_type required) {
+		return reallocate(Growth::next_capacity(cap, required, sizeof(T)));
 	}
 
 	T *reallocate(size_type new_cap) {
-		T *new_data = std::allocator_traits<Alloc>::allocate(alloc, new_cap);
-		for (size_type i = 0; i < sz; ++i) {
-			std::allocator_traits<Alloc>::construct(alloc, new_data + i,
-			                                        std::move(_data[i]));
+		using ext = tp::allocator_ext_traits<Alloc>;
+
+		// let an extended allocator grow or move the buffer without copying
+		if (_data && sz) {
+			if (new_cap > cap && ext::try_expand(alloc, _data, cap, new_cap)) {
+				cap = new_cap;
+				return _data;
+			}
+			if constexpr (ext::has_reallocate &&
+			              tp::is_trivially_relocatable_v<T>) {
+				T *new_data = ext::reallocate(alloc, _data, cap, new_cap);
+				cap         = new_cap;
+				return new_data;
+			}
 		}
+
+		T *new_data = std::allocator_traits<Alloc>::allocate(alloc, new_cap);
+		relocate(_data, _data + sz, new_data);
 		std::allocator_traits<Alloc>::deallocate(alloc, _data, cap);
 
 		cap = new_cap;
 		return new_data;
 	}
 
+	void relocate(T *first, T *last, T *dest) {
+		tp::relocate(alloc, first, last, dest);
+	}
+
+	void erase_at_end(T *pos) {
+		for (T *walk = pos; walk != _data + sz; ++walk)
+			std::allocator_traits<Alloc>::destroy(alloc, walk);
+		sz = pos - _data;
+	}
+
 	Alloc alloc;
 	size_type sz;
 	size_type cap;
@@ -649,10 +818,10 @@ private:
  *     const_iterator it;
  * }; */
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
-                         const T &value) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(
+    typename vector<T, Alloc, Growth>::const_iterator pos, const T &value) {
 
 	size_type offset = pos - cbegin();
 
@@ -660,12 +829,7 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 		_data = reallocate();
 
 	T *flag = _data + offset;
-	T *src = _data + sz - 1, *dst = _data + sz;
-
-	while (src >= flag) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		--src, --dst;
-	}
+	relocate(flag, _data + sz, flag + 1);
 
 	std::allocator_traits<Alloc>::construct(alloc, flag, value);
 	++sz;
@@ -673,22 +837,17 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 	return iterator(flag);
 }
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
-                         T &&value) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(
+    typename vector<T, Alloc, Growth>::const_iterator pos, T &&value) {
 	size_type offset = pos - cbegin();
 
 	if (sz == cap)
 		_data = reallocate();
 
 	T *flag = _data + offset;
-	T *src = _data + sz - 1, *dst = _data + sz;
-
-	while (src >= flag) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		--src, --dst;
-	}
+	relocate(flag, _data + sz, flag + 1);
 
 	std::allocator_traits<Alloc>::construct(alloc, flag, std::move(value));
 	++sz;
@@ -696,23 +855,19 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 	return begin() + offset;
 }
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
-                         typename vector<T, Alloc>::size_type count,
-                         const T &value) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(
+    typename vector<T, Alloc, Growth>::const_iterator pos,
+    typename vector<T, Alloc, Growth>::size_type count, const T &value) {
 	size_type offset = pos - cbegin();
 
 	if (sz + count > cap)
-		_data = reallocate(sz + count);
+		_data = grow(sz + count);
 
 	T *flag = _data + offset;
-	T *src = _data + sz - 1, *dst = _data + sz + count - 1;
+	relocate(flag, _data + sz, flag + count);
 
-	while (src >= flag) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		--src, --dst;
-	}
 	for (size_type i = 0; i < count; ++i)
 		std::allocator_traits<Alloc>::construct(alloc, flag++, value);
 
@@ -720,23 +875,21 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 	return begin() + offset;
 }
 
-template <typename T, typename Alloc> template <typename InputIt>
-requires is_iterator<InputIt> vector<T, Alloc>::iterator
-vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
-                         InputIt first, InputIt last) {
+template <typename T, typename Alloc, typename Growth>
+template <typename InputIt>
+requires tp::is_iterator<InputIt> vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(
+    typename vector<T, Alloc, Growth>::const_iterator pos, InputIt first,
+    InputIt last) {
 	size_type offset = pos - cbegin();
 	size_type count  = last - first;
 
 	if (sz + count > cap)
-		_data = reallocate(sz + count);
+		_data = grow(sz + count);
 
 	T *flag = _data + offset;
-	T *src = _data + sz - 1, *dst = _data + sz + count - 1;
+	relocate(flag, _data + sz, flag + count);
 
-	while (src >= flag) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		--src, --dst;
-	}
 	while (first != last) {
 		std::allocator_traits<Alloc>::construct(alloc, flag++, *(first++));
 	}
@@ -745,23 +898,20 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 	return begin() + offset;
 }
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
-                         std::initializer_list<T> ilist) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(
+    typename vector<T, Alloc, Growth>::const_iterator pos,
+    std::initializer_list<T> ilist) {
 	size_type offset = pos - cbegin();
 	size_type count  = ilist.size();
 
 	if (sz + count > cap)
-		_data = reallocate(sz + count);
+		_data = grow(sz + count);
 
 	T *flag = _data + offset;
-	T *src = _data + sz - 1, *dst = _data + sz + count - 1;
+	relocate(flag, _data + sz, flag + count);
 
-	while (src >= flag) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		--src, --dst;
-	}
 	auto it = ilist.begin();
 	while (it != ilist.end()) {
 		std::allocator_traits<Alloc>::construct(alloc, flag++, *(it++));
@@ -771,29 +921,26 @@ vector<T, Alloc>::insert(typename vector<T, Alloc>::const_iterator pos,
 	return begin() + offset;
 }
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::erase(vector<T, Alloc>::const_iterator pos) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::erase(
+    vector<T, Alloc, Growth>::const_iterator pos) {
 	size_type offset = pos - cbegin();
 
-	T *src = _data + offset + 1;
 	T *dst = _data + offset;
 
 	std::allocator_traits<Alloc>::destroy(alloc, dst);
-
-	while (src < _data + sz) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		++src, ++dst;
-	}
+	relocate(dst + 1, _data + sz, dst);
 
 	--sz;
 	return begin() + offset;
 }
 
-template <typename T, typename Alloc>
-typename vector<T, Alloc>::iterator
-vector<T, Alloc>::erase(vector<T, Alloc>::const_iterator first,
-                        vector<T, Alloc>::const_iterator last) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::erase(
+    vector<T, Alloc, Growth>::const_iterator first,
+    vector<T, Alloc, Growth>::const_iterator last) {
 	size_type offset = first - cbegin();
 	T *dst           = _data + (first - cbegin());
 	T *src           = _data + (last - cbegin());
@@ -804,10 +951,7 @@ vector<T, Alloc>::erase(vector<T, Alloc>::const_iterator first,
 		++walk;
 	}
 
-	while (src < _data + sz) {
-		std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
-		++src, ++dst;
-	}
+	relocate(src, _data + sz, dst);
 
 	sz -= (last - first);
 	return begin() + offset;
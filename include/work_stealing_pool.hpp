@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <chase_lev_deque.hpp>
+
+namespace tp {
+
+namespace detail {
+
+// a forked call; lives on the stack of the thread that forked it
+struct ws_task {
+	void (*call)(ws_task *) = nullptr;
+	std::atomic<bool> done{false};
+	std::exception_ptr error;
+};
+
+template <typename Fn> struct ws_fn_task : ws_task {
+	explicit ws_fn_task(Fn &f) : fn(f) {
+		call = [](ws_task *t) { static_cast<ws_fn_task *>(t)->fn(); };
+	}
+
+	Fn &fn;
+};
+
+} // namespace detail
+
+/*
+ * Work-stealing pool for nested fork-join parallelism.
+ *
+ * Every worker owns a chase_lev_deque of forked tasks. invoke(f, g) on a
+ * worker pushes g to the bottom of its own deque, runs f and then pops g
+ * back, unless an idle worker stole it from the top in the meantime; in
+ * that case it runs other stolen work until g is done. Idle workers steal
+ * from random victims, spin a little and then park on a condition
+ * variable until new work is pushed.
+ *
+ * Like thread_pool, a pool of concurrency n owns n - 1 threads. A call
+ * from outside the pool is handed to the workers through a locked queue,
+ * and the calling thread steals work while it waits, so it is the n-th.
+ */
+class work_stealing_pool {
+	using task = detail::ws_task;
+
+public:
+	explicit work_stealing_pool(
+	    std::size_t concurrency = std::thread::hardware_concurrency()) {
+		concurrency = std::max<std::size_t>(concurrency, 1);
+		for (std::size_t i = 1; i < concurrency; ++i)
+			slots.push_back(std::make_unique<slot>());
+		for (std::size_t i = 0; i < slots.size(); ++i)
+			slots[i]->thread = std::thread([this, i] { work(i); });
+	}
+
+	work_stealing_pool(const work_stealing_pool &)            = delete;
+	work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+	~work_stealing_pool() {
+		{
+			std::lock_guard lock(park_mtx);
+			stopping = true;
+		}
+		park_cv.notify_all();
+		for (auto &s : slots)
+			s->thread.join();
+	}
+
+	// number of threads that run tasks, an outside caller included
+	std::size_t concurrency() const { return slots.size() + 1; }
+
+	// shared pool sized to hardware_concurrency
+	static work_stealing_pool &instance() {
+		static work_stealing_pool pool;
+		return pool;
+	}
+
+	/*
+	 * Run f() and g(), possibly in parallel, and return when both are done.
+	 * If either throws, the exception is rethrown here after both finished
+	 * (f's first).
+	 */
+	template <typename F, typename G> void invoke(F &&f, G &&g) {
+		if (slots.empty()) {
+			f();
+			g();
+			return;
+		}
+
+		int self = worker_index();
+		if (self < 0) {
+			// from outside: the whole fork runs on a worker
+			auto root = [&] { invoke(f, g); };
+			detail::ws_fn_task<decltype(root)> t(root);
+			inject(&t);
+			wait(t, self);
+			if (t.error)
+				std::rethrow_exception(t.error);
+			return;
+		}
+
+		detail::ws_fn_task<G> gt(g);
+		slots[self]->tasks.push(&gt);
+		wake_one();
+
+		std::exception_ptr ferr;
+		try {
+			f();
+		} catch (...) {
+			ferr = std::current_exception();
+		}
+
+		// every fork inside f was joined, so the bottom task is gt
+		task *t;
+		if (slots[self]->tasks.pop(t))
+			run(t);
+		else
+			wait(gt, self);
+
+		if (ferr)
+			std::rethrow_exception(ferr);
+		if (gt.error)
+			std::rethrow_exception(gt.error);
+	}
+
+private:
+	struct slot {
+		chase_lev_deque<task *> tasks;
+		std::thread thread;
+	};
+
+	struct worker_id {
+		work_stealing_pool *pool = nullptr;
+		int index                = -1;
+	};
+
+	static worker_id &current() {
+		thread_local worker_id id;
+		return id;
+	}
+
+	int worker_index() const {
+		worker_id &id = current();
+		return id.pool == this ? id.index : -1;
+	}
+
+	static void run(task *t) {
+		try {
+			t->call(t);
+		} catch (...) {
+			t->error = std::current_exception();
+		}
+		// t may be gone as soon as done is set
+		t->done.store(true, std::memory_order_release);
+	}
+
+	void inject(task *t) {
+		{
+			std::lock_guard lock(inject_mtx);
+			injected.push_back(t);
+			injected_cnt.fetch_add(1, std::memory_order_relaxed);
+		}
+		wake_one();
+	}
+
+	// own deque first, then the injected queue, then a random victim
+	task *find_work(int self) {
+		task *t;
+		if (self >= 0) {
+			if (slots[self]->tasks.pop(t))
+				return t;
+			if (injected_cnt.load(std::memory_order_relaxed)) {
+				std::lock_guard lock(inject_mtx);
+				if (!injected.empty()) {
+					t = injected.front();
+					injected.pop_front();
+					injected_cnt.fetch_sub(1, std::memory_order_relaxed);
+					return t;
+				}
+			}
+		}
+
+		std::size_t n     = slots.size();
+		std::size_t start = next_random() % n;
+		for (std::size_t i = 0; i < n; ++i) {
+			std::size_t victim = (start + i) % n;
+			if (int(victim) != self && slots[victim]->tasks.steal(t))
+				return t;
+		}
+		return nullptr;
+	}
+
+	// help out until t is done
+	void wait(task &t, int self) {
+		while (!t.done.load(std::memory_order_acquire)) {
+			if (task *other = find_work(self))
+				run(other);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void wake_one() {
+		// pairs with the sleepers increment in work(): either the waker sees
+		// the sleeper or the sleeper's last scan sees the new task
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepers.load(std::memory_order_relaxed) == 0)
+			return;
+		{
+			std::lock_guard lock(park_mtx);
+			++epoch;
+		}
+		park_cv.notify_one();
+	}
+
+	void work(std::size_t index) {
+		current() = {this, int(index)};
+		for (;;) {
+			task *t = find_work(index);
+			for (int spin = 0; !t && spin < 64; ++spin) {
+				std::this_thread::yield();
+				t = find_work(index);
+			}
+			if (t) {
+				run(t);
+				continue;
+			}
+
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+			std::uint64_t seen;
+			{
+				std::lock_guard lock(park_mtx);
+				seen = epoch;
+			}
+			bool stop = false;
+			t         = find_work(index);
+			if (!t) {
+				std::unique_lock lock(park_mtx);
+				park_cv.wait(lock,
+				             [&] { return stopping || epoch != seen; });
+				stop = stopping;
+			}
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+			if (t)
+				run(t);
+			else if (stop)
+				return;
+		}
+	}
+
+	static std::uint64_t next_random() {
+		thread_local std::uint64_t state =
+		    std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+	std::vector<std::unique_ptr<slot>> slots;
+
+	std::mutex inject_mtx;
+	std::deque<task *> injected;
+	std::atomic<std::size_t> injected_cnt{0};
+
+	std::mutex park_mtx;
+	std::condition_variable park_cv;
+	std::atomic<int> sleepers{0};
+	std::uint64_t epoch = 0;
+	bool stopping       = false;
+};
+
+} // namespace tp
@@ -5,8 +5,25 @@
 #include "test_unique_ptr.hpp"
 #include "test_array.hpp"
 #include "test_vector.hpp"
+#include "test_small_vector.hpp"
+#include "test_stable_vector.hpp"
+#include "test_mmap_allocator.hpp"
+#include "test_hugepage_allocator.hpp"
+#include "test_algo.hpp"
+#include "test_parallel.hpp"
+#include "test_work_stealing.hpp"
+#include "test_mapped_vector.hpp"
 #include "test_deque.hpp"
+#include "test_ring_buffer.hpp"
+#include "test_spsc_queue.hpp"
+#include "test_mpmc_queue.hpp"
+#include "test_segmented.hpp"
+#include "test_tiered_deque.hpp"
 #include "test_list.hpp"
+#include "test_unrolled_list.hpp"
+#include "test_intrusive_list.hpp"
+#include "test_timer_wheel.hpp"
+#include "test_node_pool_allocator.hpp"
 
 int main(int argc, char **argv) {
 	testing::InitGoogleTest(&argc, argv);
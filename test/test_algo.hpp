@@ -0,0 +1,86 @@
+#include <algo.hpp>
+#include <array.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector.hpp>
+
+template <typename T> static void check_algo(tp::algo::isa level) {
+	tp::algo::set_isa(level);
+
+	// sizes around the SSE2 / AVX2 block widths exercise the scalar tails
+	for (std::size_t n : {0, 1, 7, 16, 31, 32, 33, 64, 100, 257}) {
+		vector<T> vec;
+		for (std::size_t i = 0; i < n; ++i)
+			vec.push_back(T((i * 7) % 23) + T(1));
+
+		for (int v = 0; v < 25; ++v) {
+			T value = T(v);
+			auto it = tp::algo::find(vec.begin(), vec.end(), value);
+			auto *ref = std::find(vec.data(), vec.data() + n, value);
+			ASSERT_EQ(it - vec.begin(), ref - vec.data());
+			ASSERT_EQ(tp::algo::count(vec.begin(), vec.end(), value),
+			          std::count(vec.data(), vec.data() + n, value));
+		}
+
+		auto mn = tp::algo::min_element(vec.begin(), vec.end());
+		auto mx = tp::algo::max_element(vec.begin(), vec.end());
+		ASSERT_EQ(mn - vec.begin(),
+		          std::min_element(vec.data(), vec.data() + n) - vec.data());
+		ASSERT_EQ(mx - vec.begin(),
+		          std::max_element(vec.data(), vec.data() + n) - vec.data());
+
+		vector<T> copy(vec);
+		ASSERT_TRUE(tp::algo::equal(vec.begin(), vec.end(), copy.begin()));
+		if (n) {
+			copy[n - 1] = T(0);
+			ASSERT_FALSE(
+			    tp::algo::equal(vec.begin(), vec.end(), copy.begin()));
+		}
+	}
+}
+
+template <typename T> static void check_algo_all() {
+	for (auto level : {tp::algo::isa::scalar, tp::algo::isa::sse2,
+	                   tp::algo::isa::avx2})
+		check_algo<T>(level);
+	tp::algo::set_isa(tp::algo::isa::avx2);
+}
+
+TEST(algo, integers) {
+	check_algo_all<std::int8_t>();
+	check_algo_all<std::uint8_t>();
+	check_algo_all<std::int16_t>();
+	check_algo_all<std::uint16_t>();
+	check_algo_all<std::int32_t>();
+	check_algo_all<std::uint32_t>();
+	check_algo_all<std::int64_t>();
+	check_algo_all<std::uint64_t>();
+}
+
+TEST(algo, floating) {
+	check_algo_all<float>();
+	check_algo_all<double>();
+}
+
+TEST(algo, extremes) {
+	vector<std::uint32_t> u{5, 0xffffffffu, 1, 0x80000000u, 7, 0, 9, 3, 2};
+	vector<std::int64_t> s{5, -1, INT64_MIN, 3, INT64_MAX, 0, 8, 9, 1};
+	ASSERT_EQ(*tp::algo::max_element(u.begin(), u.end()), 0xffffffffu);
+	ASSERT_EQ(*tp::algo::min_element(u.begin(), u.end()), 0u);
+	ASSERT_EQ(*tp::algo::max_element(s.begin(), s.end()), INT64_MAX);
+	ASSERT_EQ(*tp::algo::min_element(s.begin(), s.end()), INT64_MIN);
+}
+
+TEST(algo, mixed_value_type) {
+	tp::array<std::uint8_t, 40> arr{};
+	arr[33] = 200;
+
+	ASSERT_EQ(tp::algo::find(arr.begin(), arr.end(), 200) - arr.begin(), 33);
+	// no uint8_t can equal -56 or 456, even though they truncate to 200
+	ASSERT_EQ(tp::algo::find(arr.begin(), arr.end(), -56), arr.end());
+	ASSERT_EQ(tp::algo::count(arr.begin(), arr.end(), 456), 0);
+
+	vector<float> vec{1.0f, 0.5f, 0.1f};
+	ASSERT_EQ(tp::algo::find(vec.begin(), vec.end(), 0.5) - vec.begin(), 1);
+	ASSERT_EQ(tp::algo::find(vec.begin(), vec.end(), 0.1), vec.end());
+}
@@ -1,6 +1,11 @@
 #include <deque.hpp>
 // #include <deque>
 #include <gtest/gtest.h>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
 
 /* class deque_test : public testing::Test {
  * protected:
@@ -50,6 +55,29 @@ TEST(deque, copy_ctor) {
 	}
 }
 
+// trivially copyable, but not assignable
+struct deque_const_member {
+	const int key;
+	int value;
+};
+
+TEST(deque, copy_ctor_const_member) {
+	deque<deque_const_member> tmp;
+	for (int i = 0; i < 300; ++i)
+		tmp.push_back({i, -i});
+	tmp.pop_front();
+	deque<deque_const_member> dq(tmp);
+	ASSERT_EQ(dq.size(), 299);
+	for (size_t i = 0; i < dq.size(); ++i) {
+		ASSERT_EQ(dq[i].key, int(i) + 1);
+		ASSERT_EQ(dq[i].value, -int(i) - 1);
+	}
+
+	std::vector<deque_const_member> src{{1, 2}, {3, 4}};
+	deque<deque_const_member> from_range(src.begin(), src.end());
+	ASSERT_EQ(from_range.back().key, 3);
+}
+
 TEST(deque, move_ctor) {
 	deque<int> tmp{1,2,3,4};
 	deque<int> dq(std::move(tmp));
@@ -586,3 +614,251 @@ TEST(deque, swap) {
 		++it;
 	}
 }
+
+static std::size_t deque_block_allocs = 0;
+static std::size_t deque_block_frees  = 0;
+static std::size_t deque_map_allocs   = 0;
+
+template <typename T> struct deque_counting_allocator : std::allocator<T> {
+	template <typename U> struct rebind {
+		using other = deque_counting_allocator<U>;
+	};
+
+	deque_counting_allocator() = default;
+	template <typename U>
+	deque_counting_allocator(const deque_counting_allocator<U> &) {}
+
+	// blocks and maps are counted apart
+	T *allocate(std::size_t n) {
+		if constexpr (!std::is_pointer_v<T>)
+			++deque_block_allocs;
+		else
+			++deque_map_allocs;
+		return std::allocator<T>::allocate(n);
+	}
+
+	void deallocate(T *p, std::size_t n) {
+		if constexpr (!std::is_pointer_v<T>)
+			++deque_block_frees;
+		std::allocator<T>::deallocate(p, n);
+	}
+};
+
+TEST(deque, spare_blocks) {
+	deque<int, deque_counting_allocator<int>> dq;
+	ASSERT_EQ(dq.spare_block_limit(), DEQUE_SPARE_BLOCKS);
+
+	// a FIFO queue that keeps crossing block boundaries
+	for (int i = 0; i < 200; ++i)
+		dq.push_back(i);
+	std::size_t before = 0;
+	for (int i = 200; i < 100000; ++i) {
+		// warm up until the first block has been freed at the front
+		if (i == 1000)
+			before = deque_block_allocs;
+		dq.push_back(i);
+		ASSERT_EQ(dq.front(), i - 200);
+		dq.pop_front();
+	}
+	// the block freed at the front comes back at the back
+	ASSERT_EQ(deque_block_allocs, before);
+
+	// both ends share the cache
+	for (int i = 0; i < 200; ++i)
+		dq.pop_back();
+	ASSERT_EQ(dq.size(), 0);
+	ASSERT_EQ(dq.spare_blocks(), DEQUE_SPARE_BLOCKS);
+	before = deque_block_allocs;
+	for (int i = 0; i < 200; ++i)
+		dq.push_front(i);
+	ASSERT_EQ(deque_block_allocs, before);
+
+	dq.set_spare_block_limit(0);
+	ASSERT_EQ(dq.spare_blocks(), 0);
+	dq.set_spare_block_limit(8);
+	dq.clear();
+	ASSERT_GT(dq.spare_blocks(), 0);
+	dq.trim_spare_blocks();
+	ASSERT_EQ(dq.spare_blocks(), 0);
+
+	// the limit goes with the spare blocks on swap
+	deque<int, deque_counting_allocator<int>> other;
+	for (int i = 0; i < 5000; ++i)
+		dq.push_back(i);
+	dq.clear();
+	ASSERT_GT(dq.spare_blocks(), DEQUE_SPARE_BLOCKS);
+	dq.swap(other);
+	ASSERT_EQ(other.spare_block_limit(), 8);
+	ASSERT_EQ(dq.spare_block_limit(), DEQUE_SPARE_BLOCKS);
+	ASSERT_LE(other.spare_blocks(), 8);
+	ASSERT_GT(other.spare_blocks(), DEQUE_SPARE_BLOCKS);
+}
+
+TEST(deque, block_size) {
+	using small_blocks = deque<int, std::allocator<int>, 64>;
+	static_assert(small_blocks::iterator::buffer_size() == 16);
+	static_assert(deque<int>::iterator::buffer_size() ==
+	              DEQUE_BUF_SIZE / sizeof(int));
+
+	small_blocks dq;
+	for (int i = 0; i < 1000; ++i)
+		dq.push_back(i);
+	for (int i = 0; i < 1000; ++i)
+		dq.push_front(-i);
+	ASSERT_EQ(dq.size(), 2000);
+	ASSERT_EQ(dq[0], -999);
+	ASSERT_EQ(dq[1999], 999);
+	ASSERT_EQ(dq.end() - dq.begin(), 2000);
+	dq.erase(dq.begin() + 10, dq.begin() + 1500);
+	ASSERT_EQ(dq.size(), 510);
+	ASSERT_EQ(dq[10], 500);
+
+	// elements larger than a default block no longer get one block each
+	struct big {
+		char bytes[1024];
+	};
+	using big_blocks = deque<big, std::allocator<big>, 65536>;
+	static_assert(big_blocks::iterator::buffer_size() == 64);
+	static_assert(deque<big>::iterator::buffer_size() == 1);
+	big_blocks bigs(100);
+	bigs[99].bytes[0] = 'x';
+	ASSERT_EQ((bigs.begin() + 99)->bytes[0], 'x');
+
+	// blocks too small to link as spares are freed right away
+	using tiny_blocks = deque<char, std::allocator<char>, 4>;
+	static_assert(tiny_blocks::iterator::buffer_size() == 4);
+	tiny_blocks tiny;
+	for (int i = 0; i < 100; ++i)
+		tiny.push_back(char(i));
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_EQ(tiny.front(), char(i));
+		tiny.pop_front();
+	}
+	ASSERT_EQ(tiny.spare_blocks(), 0);
+	tiny.push_front('a');
+	ASSERT_EQ(tiny.back(), 'a');
+}
+
+TEST(deque, map_recentering) {
+	deque<int, deque_counting_allocator<int>> dq;
+	for (int i = 0; i < 1000; ++i)
+		dq.push_back(i);
+
+	// a queue drifting to the back reuses the free front of the map, once
+	// the map is at least twice the nodes in use
+	std::size_t maps = 0;
+	for (int i = 1000; i < 200000; ++i) {
+		if (i == 10000)
+			maps = deque_map_allocs;
+		dq.push_back(i);
+		ASSERT_EQ(dq.front(), i - 1000);
+		dq.pop_front();
+	}
+	ASSERT_EQ(deque_map_allocs, maps);
+
+	// and the same towards the front
+	for (int i = 0; i < 200000; ++i) {
+		dq.push_front(i);
+		dq.pop_back();
+	}
+	ASSERT_EQ(deque_map_allocs, maps);
+	ASSERT_EQ(dq.size(), 1000);
+	ASSERT_EQ(dq.back(), 199000);
+}
+
+TEST(deque, shrink_to_fit) {
+	std::size_t live = deque_block_allocs - deque_block_frees;
+	{
+		deque<int, deque_counting_allocator<int>> dq;
+		for (int i = 0; i < 100000; ++i)
+			dq.push_back(i);
+		for (int i = 0; i < 99900; ++i)
+			dq.pop_front();
+		dq.set_spare_block_limit(64);
+		for (int i = 0; i < 50; ++i)
+			dq.pop_back();
+		dq.push_back(-1);
+		ASSERT_GT(dq.spare_blocks(), 0);
+
+		std::size_t maps = deque_map_allocs;
+		dq.shrink_to_fit();
+		ASSERT_EQ(dq.spare_blocks(), 0);
+		ASSERT_EQ(deque_map_allocs, maps + 1);
+		// 51 elements span at most two 128-int blocks
+		ASSERT_LE(deque_block_allocs - deque_block_frees - live, 2);
+
+		ASSERT_EQ(dq.size(), 51);
+		for (int i = 0; i < 50; ++i)
+			ASSERT_EQ(dq[i], 99900 + i);
+		ASSERT_EQ(dq.back(), -1);
+
+		// nothing left to cut
+		dq.shrink_to_fit();
+		ASSERT_EQ(deque_map_allocs, maps + 1);
+
+		// still grows at both ends
+		for (int i = 0; i < 1000; ++i)
+			dq.push_front(i), dq.push_back(i);
+		ASSERT_EQ(dq.size(), 2051);
+		ASSERT_EQ(dq.front(), 999);
+		ASSERT_EQ(dq.back(), 999);
+	}
+	ASSERT_EQ(deque_block_allocs - deque_block_frees, live);
+}
+
+TEST(deque, append_range) {
+	deque<int, std::allocator<int>, 64> dq{1};
+	std::vector<int> nums;
+	for (int i = 2; i <= 100; ++i)
+		nums.push_back(i);
+	std::initializer_list<long> il{101, 102};
+	std::istringstream in("103 104 105");
+
+	dq.append_range(nums);
+	dq.append_range(il);
+	dq.append_range(std::views::istream<int>(in));
+	dq.append_range(std::views::iota(106, 200));
+	ASSERT_EQ(dq.size(), 199);
+	for (int i = 0; i < 199; ++i)
+		ASSERT_EQ(dq[i], i + 1);
+
+	// every offset within a block
+	for (int off = 0; off < 17; ++off) {
+		deque<int, std::allocator<int>, 64> part(off, -1);
+		part.append_range(std::span(nums.data(), 40));
+		ASSERT_EQ(part.size(), off + 40);
+		ASSERT_EQ(part[off], 2);
+		ASSERT_EQ(part.back(), 41);
+	}
+
+	deque<std::string, std::allocator<std::string>, 128> strs;
+	std::vector<std::string> words(50, "word");
+	strs.append_range(words);
+	strs.append_range(words);
+	ASSERT_EQ(strs.size(), 100);
+	ASSERT_EQ(strs[99], "word");
+}
+
+TEST(deque, prepend_range) {
+	deque<int, std::allocator<int>, 64> dq{200};
+	std::vector<int> nums;
+	for (int i = 100; i < 200; ++i)
+		nums.push_back(i);
+	std::istringstream in("1 2 3");
+
+	dq.prepend_range(nums);
+	dq.prepend_range(std::views::iota(4, 100));
+	dq.prepend_range(std::views::istream<int>(in));
+	ASSERT_EQ(dq.size(), 200);
+	for (int i = 0; i < 200; ++i)
+		ASSERT_EQ(dq[i], i + 1);
+
+	deque<std::string, std::allocator<std::string>, 128> strs{"end"};
+	std::vector<std::string> words{"a", "b", "c"};
+	for (int i = 0; i < 20; ++i)
+		strs.prepend_range(words);
+	ASSERT_EQ(strs.size(), 61);
+	ASSERT_EQ(strs[0], "a");
+	ASSERT_EQ(strs[59], "c");
+	ASSERT_EQ(strs.back(), "end");
+}
@@ -0,0 +1,43 @@
+#include <deque.hpp>
+#include <gtest/gtest.h>
+#include <hugepage_allocator.hpp>
+#include <list.hpp>
+#include <vector.hpp>
+
+TEST(hugepage_allocator, alignment) {
+	tp::hugepage_allocator<char> alloc;
+	const std::size_t n = alloc.huge_page_size + 1;
+
+	char *p = alloc.allocate(n);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p) % alloc.huge_page_size, 0);
+	p[0] = p[n - 1] = 'x';
+	alloc.deallocate(p, n);
+
+	// small requests stay on the regular heap
+	char *q = alloc.allocate(16);
+	q[15] = 'x';
+	alloc.deallocate(q, 16);
+}
+
+TEST(hugepage_allocator, containers) {
+	vector<long, tp::hugepage_allocator<long>> vec;
+	deque<long, tp::hugepage_allocator<long>> dq;
+	list<long, tp::hugepage_allocator<long>> lt;
+	const long n = 1 << 19;
+
+	for (long i = 0; i < n; ++i) {
+		vec.push_back(i);
+		dq.push_back(i);
+	}
+	for (long i = 0; i < 1000; ++i)
+		lt.push_back(i);
+
+	ASSERT_EQ(vec.size(), n);
+	ASSERT_EQ(dq.size(), n);
+	ASSERT_EQ(lt.size(), 1000);
+	for (long i = 0; i < n; ++i) {
+		ASSERT_EQ(vec[i], i);
+		ASSERT_EQ(dq[i], i);
+	}
+	ASSERT_EQ(*--lt.end(), 999);
+}
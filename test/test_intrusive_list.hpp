@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <intrusive_list.hpp>
+#include <memory>
+#include <vector>
+
+struct ilist_conn {
+	explicit ilist_conn(int id) : id(id) {}
+
+	int id;
+	list_node_base hook;
+	tp::auto_unlink_hook timer_hook; // a second list, auto-unlinked
+};
+
+using conn_list  = tp::intrusive_list<ilist_conn, &ilist_conn::hook>;
+using timer_list = tp::intrusive_list<ilist_conn, &ilist_conn::timer_hook>;
+
+template <typename List> static std::vector<int> ilist_ids(const List &lst) {
+	std::vector<int> ret;
+	for (const ilist_conn &c : lst)
+		ret.push_back(c.id);
+	return ret;
+}
+
+TEST(intrusive_list, link_unlink) {
+	std::vector<std::unique_ptr<ilist_conn>> conns;
+	for (int i = 0; i < 6; ++i)
+		conns.push_back(std::make_unique<ilist_conn>(i));
+
+	conn_list lst;
+	ASSERT_TRUE(lst.empty());
+	for (auto &c : conns)
+		lst.push_back(*c);
+	ASSERT_EQ(lst.size(), 6);
+	ASSERT_EQ(lst.front().id, 0);
+	ASSERT_EQ(lst.back().id, 5);
+	ASSERT_EQ(&*lst.iterator_to(*conns[3]), conns[3].get());
+
+	// by reference, O(1)
+	lst.erase(*conns[3]);
+	lst.erase(*conns[0]);
+	ASSERT_EQ(ilist_ids(lst), (std::vector<int>{1, 2, 4, 5}));
+	ASSERT_EQ(lst.size(), 4);
+
+	lst.push_front(*conns[3]);
+	auto it = lst.insert(lst.iterator_to(*conns[5]), *conns[0]);
+	ASSERT_EQ(it->id, 0);
+	ASSERT_EQ(ilist_ids(lst), (std::vector<int>{3, 1, 2, 4, 0, 5}));
+
+	lst.pop_front();
+	lst.pop_back();
+	ASSERT_EQ(ilist_ids(lst), (std::vector<int>{1, 2, 4, 0}));
+
+	std::vector<int> back;
+	for (auto rit = lst.rbegin(); rit != lst.rend(); ++rit)
+		back.push_back((*rit).id);
+	ASSERT_EQ(back, (std::vector<int>{0, 4, 2, 1}));
+
+	lst.reverse();
+	ASSERT_EQ(ilist_ids(lst), (std::vector<int>{0, 4, 2, 1}));
+
+	auto even = [](const ilist_conn &c) { return c.id % 2 == 0; };
+	ASSERT_EQ(lst.remove_if(even), 3);
+	ASSERT_EQ(ilist_ids(lst), (std::vector<int>{1}));
+	lst.clear();
+	ASSERT_TRUE(lst.empty());
+	ASSERT_EQ(lst.size(), 0);
+}
+
+TEST(intrusive_list, auto_unlink) {
+	timer_list timers;
+	ilist_conn a(1), c(3);
+	timers.push_back(a);
+	ASSERT_FALSE(c.timer_hook.is_linked());
+	{
+		ilist_conn b(2);
+		timers.push_back(b);
+		timers.push_back(c);
+		ASSERT_TRUE(b.timer_hook.is_linked());
+		ASSERT_EQ(ilist_ids(timers), (std::vector<int>{1, 2, 3}));
+
+		// a copy is not linked anywhere
+		ilist_conn copy = b;
+		ASSERT_FALSE(copy.timer_hook.is_linked());
+	}
+	// b left with its destructor
+	ASSERT_EQ(ilist_ids(timers), (std::vector<int>{1, 3}));
+	ASSERT_EQ(timers.size(), 2);
+
+	a.timer_hook.unlink();
+	ASSERT_FALSE(a.timer_hook.is_linked());
+	ASSERT_EQ(ilist_ids(timers), (std::vector<int>{3}));
+	a.timer_hook.unlink();
+
+	// erasing through the list leaves the hook unlinked too
+	timers.erase(c);
+	ASSERT_FALSE(c.timer_hook.is_linked());
+	ASSERT_TRUE(timers.empty());
+
+	// an element can sit in one list per hook
+	conn_list all;
+	all.push_back(a);
+	timers.push_back(a);
+	timers.push_back(c);
+	all.push_back(c);
+	ASSERT_EQ(ilist_ids(all), (std::vector<int>{1, 3}));
+	ASSERT_EQ(ilist_ids(timers), (std::vector<int>{1, 3}));
+	all.clear();
+
+	{
+		timer_list scoped;
+		timers.erase(a);
+		scoped.push_back(a);
+	}
+	// the list's destructor unlinked a
+	ASSERT_FALSE(a.timer_hook.is_linked());
+}
+
+TEST(intrusive_list, splice_move) {
+	// linked elements must not move
+	std::vector<ilist_conn> conns;
+	conns.reserve(8);
+	for (int i = 0; i < 8; ++i)
+		conns.emplace_back(i);
+
+	conn_list a, b;
+	for (int i = 0; i < 4; ++i) {
+		a.push_back(conns[i]);
+		b.push_back(conns[i + 4]);
+	}
+
+	a.splice(a.iterator_to(conns[2]), b, b.iterator_to(conns[5]));
+	ASSERT_EQ(ilist_ids(a), (std::vector<int>{0, 1, 5, 2, 3}));
+	ASSERT_EQ(a.size(), 5);
+	ASSERT_EQ(b.size(), 3);
+
+	a.splice(a.begin(), b, b.iterator_to(conns[6]), b.end());
+	ASSERT_EQ(ilist_ids(a), (std::vector<int>{6, 7, 0, 1, 5, 2, 3}));
+	ASSERT_EQ(ilist_ids(b), (std::vector<int>{4}));
+	ASSERT_EQ(a.size(), 7);
+	ASSERT_EQ(b.size(), 1);
+
+	// within one list
+	a.splice(a.end(), a, a.begin(), a.iterator_to(conns[0]));
+	ASSERT_EQ(ilist_ids(a), (std::vector<int>{0, 1, 5, 2, 3, 6, 7}));
+	ASSERT_EQ(a.size(), 7);
+
+	a.splice(a.end(), b);
+	ASSERT_TRUE(b.empty());
+	ASSERT_EQ(a.size(), 8);
+
+	conn_list moved(std::move(a));
+	ASSERT_TRUE(a.empty());
+	ASSERT_EQ(moved.size(), 8);
+	ASSERT_EQ(ilist_ids(moved), (std::vector<int>{0, 1, 5, 2, 3, 6, 7, 4}));
+
+	ilist_conn &last = moved.back();
+	moved.pop_back();
+	b.push_back(last);
+	moved.swap(b);
+	ASSERT_EQ(ilist_ids(moved), (std::vector<int>{4}));
+	ASSERT_EQ(b.size(), 7);
+	a = std::move(b);
+	ASSERT_EQ(a.size(), 7);
+	a.clear();
+	moved.clear();
+}
+
+TEST(intrusive_list, dispose) {
+	conn_list lst;
+	for (int i = 0; i < 5; ++i)
+		lst.push_back(*new ilist_conn(i));
+
+	int deleted = 0;
+	auto dispose = [&](ilist_conn *c) {
+		++deleted;
+		delete c;
+	};
+	auto it = lst.erase_and_dispose(std::next(lst.begin()), dispose);
+	ASSERT_EQ(it->id, 2);
+	ASSERT_EQ(lst.size(), 4);
+	lst.clear_and_dispose(dispose);
+	ASSERT_EQ(deleted, 5);
+	ASSERT_TRUE(lst.empty());
+}
@@ -1,5 +1,8 @@
 #include <list.hpp>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <utility>
 
 inline auto inc_iter(list<int>::iterator it, std::size_t num)-> decltype(it) {
 	while (num--)
@@ -333,3 +336,120 @@ TEST(list, swap) {
 		++it, ++it1;
 	}
 }
+
+// walks both directions so broken _prev links show up too
+template <typename T>
+static void expect_list(list<T> &lt, std::initializer_list<T> target) {
+	ASSERT_EQ(lt.size(), target.size());
+	auto it = lt.begin();
+	for (const T &x : target) {
+		ASSERT_EQ(*it, x);
+		++it;
+	}
+	ASSERT_EQ(it, lt.end());
+	for (auto rit = std::rbegin(target); rit != std::rend(target); ++rit)
+		ASSERT_EQ(*--it, *rit);
+}
+
+TEST(list, erase_size) {
+	list<int> lt{1, 2, 3, 4, 5};
+	lt.erase(lt.begin());
+	lt.pop_back();
+	expect_list(lt, {2, 3, 4});
+}
+
+TEST(list, sort) {
+	list<int> lt{5, 3, 9, 1, 3, 7, 0, 2, 8};
+	lt.sort();
+	expect_list(lt, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+	lt.sort(std::greater<>());
+	expect_list(lt, {9, 8, 7, 5, 3, 3, 2, 1, 0});
+
+	list<int> one{4}, none;
+	one.sort();
+	none.sort();
+	expect_list(one, {4});
+	ASSERT_TRUE(none.empty());
+
+	// stable: order by key only, the second member keeps insertion order
+	list<std::pair<int, int>> pairs;
+	std::mt19937 rng(3);
+	for (int i = 0; i < 5000; ++i)
+		pairs.emplace_back(int(rng() % 50), i);
+	pairs.sort([](auto &a, auto &b) { return a.first < b.first; });
+	ASSERT_EQ(pairs.size(), 5000);
+	auto prev = pairs.begin();
+	for (auto it = ++pairs.begin(); it != pairs.end(); prev = it++) {
+		ASSERT_LE(prev->first, it->first);
+		if (prev->first == it->first) {
+			ASSERT_LT(prev->second, it->second);
+		}
+		ASSERT_EQ(it.node->_prev, prev.node);
+	}
+}
+
+TEST(list, merge) {
+	list<int> a{1, 3, 5, 7}, b{0, 2, 3, 8, 9};
+	a.merge(b);
+	expect_list(a, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+	ASSERT_TRUE(b.empty());
+	ASSERT_EQ(b.size(), 0);
+
+	list<int> c{6, 4}, d{9, 5, 1};
+	c.merge(std::move(d), std::greater<>());
+	expect_list(c, {9, 6, 5, 4, 1});
+	a.merge(a);
+	ASSERT_EQ(a.size(), 9);
+}
+
+TEST(list, splice) {
+	list<int> a{1, 2, 3}, b{10, 20, 30, 40};
+
+	// a single element
+	a.splice(++a.begin(), b, ++b.begin());
+	expect_list(a, {1, 20, 2, 3});
+	expect_list(b, {10, 30, 40});
+
+	// a range
+	a.splice(a.end(), b, b.begin(), --b.end());
+	expect_list(a, {1, 20, 2, 3, 10, 30});
+	expect_list(b, {40});
+
+	// everything
+	a.splice(a.begin(), b);
+	expect_list(a, {40, 1, 20, 2, 3, 10, 30});
+	ASSERT_TRUE(b.empty());
+
+	// within the same list the size stays
+	a.splice(a.begin(), a, --a.end());
+	expect_list(a, {30, 40, 1, 20, 2, 3, 10});
+	a.splice(a.end(), a, a.begin(), ++++a.begin());
+	expect_list(a, {1, 20, 2, 3, 10, 30, 40});
+	a.splice(a.begin(), a, a.begin());
+	expect_list(a, {1, 20, 2, 3, 10, 30, 40});
+
+	list<int> c{7};
+	a.splice(a.begin(), std::move(c));
+	ASSERT_EQ(*a.begin(), 7);
+}
+
+TEST(list, remove_unique) {
+	list<int> lt{1, 1, 2, 3, 3, 3, 1, 4, 4};
+	ASSERT_EQ(lt.unique(), 4);
+	expect_list(lt, {1, 2, 3, 1, 4});
+	ASSERT_EQ(lt.remove(1), 2);
+	expect_list(lt, {2, 3, 4});
+	// the value lives in the list itself
+	lt.push_back(2);
+	ASSERT_EQ(lt.remove(*lt.begin()), 2);
+	expect_list(lt, {3, 4});
+	lt.push_back(2);
+	ASSERT_EQ(lt.remove_if([](int x) { return x % 2 == 0; }), 2);
+	expect_list(lt, {3});
+
+	list<int> mod{1, 4, 7, 2, 5};
+	ASSERT_EQ(mod.unique([](int a, int b) { return a % 3 == b % 3; }), 3);
+	expect_list(mod, {1, 2});
+	mod.reverse();
+	expect_list(mod, {2, 1});
+}
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <mapped_vector.hpp>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector.hpp>
+
+struct mapped_record {
+	int id;
+	double value;
+};
+
+static std::string mapped_path(const char *name) {
+	std::string path = testing::TempDir() + name;
+	std::remove(path.c_str());
+	return path;
+}
+
+TEST(mapped_vector, persist) {
+	auto path = mapped_path("tp_mapped_persist");
+	{
+		tp::mapped_vector<mapped_record> vec(path.c_str());
+		ASSERT_TRUE(vec.empty());
+		// grows across several pages
+		for (int i = 0; i < 10000; ++i)
+			vec.push_back({i, i * 0.5});
+		ASSERT_EQ(vec.size(), 10000);
+		ASSERT_GE(vec.capacity(), 10000);
+	}
+
+	tp::mapped_vector<mapped_record> ro(
+	    path.c_str(), tp::mapped_vector<mapped_record>::open_mode::read_only);
+	ASSERT_TRUE(ro.read_only());
+	ASSERT_EQ(ro.size(), 10000);
+	for (int i = 0; i < 10000; ++i) {
+		ASSERT_EQ(ro[i].id, i);
+		ASSERT_EQ(ro[i].value, i * 0.5);
+	}
+	ASSERT_THROW(ro.push_back({0, 0}), std::logic_error);
+	ASSERT_THROW(ro.at(10000), std::out_of_range);
+	std::remove(path.c_str());
+}
+
+TEST(mapped_vector, append_reopen) {
+	auto path = mapped_path("tp_mapped_append");
+	vector<long> src;
+	for (long i = 0; i < 5000; ++i)
+		src.push_back(i * i);
+
+	tp::mapped_vector<long> vec(path.c_str());
+	vec.append_range(std::span(src.data(), src.size()));
+	vec.flush();
+	ASSERT_EQ(vec.size(), 5000);
+
+	// reopen read-write and keep appending
+	vec.close();
+	ASSERT_FALSE(vec.is_open());
+	vec.open(path.c_str());
+	ASSERT_EQ(vec.size(), 5000);
+	vec.emplace_back(-1);
+	vec.resize(6000);
+	ASSERT_EQ(vec[5000], -1);
+	ASSERT_EQ(vec[5999], 0);
+	ASSERT_EQ(vec[4999], 4999L * 4999);
+
+	vec.resize(10);
+	vec.shrink_to_fit();
+	ASSERT_EQ(vec.size(), 10);
+	ASSERT_LT(vec.capacity(), 6000);
+
+	// sources inside the vector survive the mapping moving
+	while (vec.size() < vec.capacity())
+		vec.push_back(7);
+	vec.push_back(vec[0]);
+	ASSERT_EQ(vec.back(), 0);
+	std::size_t n = vec.size();
+	vec.append_range(std::span(vec.data(), n));
+	ASSERT_EQ(vec.size(), 2 * n);
+	ASSERT_EQ(vec[n + 3], 9);
+	while (vec.size() < vec.capacity())
+		vec.push_back(7);
+	vec.append_range(std::span(vec.data(), 4) | std::views::reverse);
+	ASSERT_EQ(vec.back(), 0);
+	ASSERT_EQ(vec[vec.size() - 4], 9);
+	vec.resize(10);
+
+	tp::mapped_vector<long> moved(std::move(vec));
+	ASSERT_FALSE(vec.is_open());
+	ASSERT_EQ(moved.back(), 81);
+	moved.close();
+
+	// element size is checked on open
+	ASSERT_THROW(tp::mapped_vector<int> bad(path.c_str()), std::runtime_error);
+	std::remove(path.c_str());
+
+	ASSERT_THROW(tp::mapped_vector<int> missing(
+	                 path.c_str(),
+	                 tp::mapped_vector<int>::open_mode::read_only),
+	             std::system_error);
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <mmap_allocator.hpp>
+#include <vector.hpp>
+
+TEST(mmap_allocator, try_expand_and_reallocate) {
+	tp::mmap_allocator<long> alloc;
+	const std::size_t n = 2 * alloc.mmap_threshold / sizeof(long) - 1;
+
+	long *p = alloc.allocate(n);
+	for (std::size_t i = 0; i < n; ++i)
+		p[i] = i;
+
+	// growing within the last page never moves
+	ASSERT_TRUE(alloc.try_expand(p, n, n + 1));
+
+	long *q = alloc.reallocate(p, n + 1, 4 * n);
+	for (std::size_t i = 0; i < n; ++i)
+		ASSERT_EQ(q[i], long(i));
+
+	// back below the threshold: copied into an ordinary allocation
+	long *r = alloc.reallocate(q, 4 * n, 16);
+	for (std::size_t i = 0; i < 16; ++i)
+		ASSERT_EQ(r[i], long(i));
+	alloc.deallocate(r, 16);
+}
+
+TEST(mmap_allocator, vector_growth) {
+	vector<long, tp::mmap_allocator<long>> vec;
+	const long n = 1 << 20;
+
+	for (long i = 0; i < n; ++i)
+		vec.push_back(i);
+	vec.insert(vec.begin(), -1);
+	ASSERT_EQ(vec.size(), n + 1);
+	ASSERT_EQ(vec.front(), -1);
+	for (long i = 0; i < n; ++i)
+		ASSERT_EQ(vec[i + 1], i);
+
+	vec.erase(vec.begin() + 100, vec.end());
+	vec.shrink_to_fit();
+	ASSERT_EQ(vec.capacity(), 100);
+	ASSERT_EQ(vec.back(), 98);
+}
@@ -0,0 +1,154 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mpmc_queue.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(mpmc_queue, single_thread) {
+	tp::mpmc_queue<int> q(100);
+	ASSERT_EQ(q.capacity(), 128);
+	int v = -1;
+	ASSERT_TRUE(q.empty());
+	ASSERT_FALSE(q.try_pop(v));
+
+	// several laps around the slots
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 128; ++i)
+			ASSERT_TRUE(q.try_push(i));
+		ASSERT_FALSE(q.try_push(-1));
+		ASSERT_EQ(q.size(), 128);
+		for (int i = 0; i < 128; ++i) {
+			ASSERT_TRUE(q.try_pop(v));
+			ASSERT_EQ(v, i);
+		}
+		ASSERT_FALSE(q.try_pop(v));
+	}
+
+	q.push(7);
+	q.pop(v);
+	ASSERT_EQ(v, 7);
+
+	tp::mpmc_queue<int, 4> fixed;
+	ASSERT_EQ(fixed.capacity(), 4);
+	ASSERT_TRUE(fixed.try_push(1));
+	ASSERT_TRUE(fixed.try_pop(v));
+	ASSERT_EQ(v, 1);
+}
+
+TEST(mpmc_queue, batch) {
+	tp::mpmc_queue<int, 16> q;
+	int src[40], out[40];
+	for (int i = 0; i < 40; ++i)
+		src[i] = i;
+
+	// start off the first slot so the batch wraps
+	for (int i = 0; i < 10; ++i)
+		q.push(-1);
+	ASSERT_EQ(q.try_pop_n(out, 10), 10);
+	ASSERT_EQ(q.try_push_n(src, 12), 12);
+	ASSERT_EQ(q.try_push_n(src + 12, 10), 4);
+	ASSERT_EQ(q.try_push_n(src, 1), 0);
+
+	ASSERT_EQ(q.try_pop_n(out, 5), 5);
+	ASSERT_EQ(q.try_pop_n(out + 5, 40), 11);
+	for (int i = 0; i < 16; ++i)
+		ASSERT_EQ(out[i], i);
+	ASSERT_EQ(q.try_pop_n(out, 40), 0);
+}
+
+TEST(mpmc_queue, strings) {
+	std::string v;
+	{
+		tp::mpmc_queue<std::string> q(4);
+		q.emplace(3, 'a');
+		q.push("bb");
+		std::string words[] = {"ccc", "dddd", "eeeee"};
+		ASSERT_EQ(q.try_push_n(words, 3), 2);
+		q.pop(v);
+		ASSERT_EQ(v, "aaa");
+		ASSERT_TRUE(q.try_pop(v));
+		ASSERT_EQ(v, "bb");
+		ASSERT_TRUE(q.try_emplace(std::string(20, 'x')));
+		// the destructor frees the three left
+	}
+}
+
+TEST(mpmc_queue, threads) {
+	// every item comes out exactly once, whatever mix of calls is used
+	constexpr int producers = 4, consumers = 3, per_producer = 20000;
+	tp::mpmc_queue<int> q(64);
+	std::vector<std::atomic<int>> seen(producers * per_producer);
+	std::atomic<int> left{producers * per_producer};
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p)
+		threads.emplace_back([&, p] {
+			int base = p * per_producer;
+			for (int i = 0; i < per_producer;) {
+				if (p == 0) {
+					q.push(base + i++);
+				} else if (p == 1) {
+					int batch[7];
+					int n = std::min(7, per_producer - i);
+					for (int k = 0; k < n; ++k)
+						batch[k] = base + i + k;
+					int done = q.try_push_n(batch, n);
+					i += done;
+					if (!done)
+						std::this_thread::yield();
+				} else if (q.try_push(base + i)) {
+					++i;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	for (int c = 0; c < consumers; ++c)
+		threads.emplace_back([&, c] {
+			int batch[5];
+			while (left.load() > 0) {
+				int n = 0;
+				if (c == 0)
+					n = q.try_pop_n(batch, 5);
+				else if (q.try_pop(batch[0]))
+					n = 1;
+				for (int k = 0; k < n; ++k)
+					++seen[batch[k]];
+				if (n)
+					left -= n;
+				else
+					std::this_thread::yield();
+			}
+		});
+	for (auto &t : threads)
+		t.join();
+	for (auto &s : seen)
+		ASSERT_EQ(s, 1);
+	ASSERT_TRUE(q.empty());
+}
+
+TEST(mpmc_queue, blocking) {
+	// consumers park on an empty queue, producers on a full one
+	tp::mpmc_queue<long, 2> q;
+	constexpr long n = 20000;
+	std::atomic<long> sum{0};
+	std::vector<std::thread> threads;
+	for (int c = 0; c < 2; ++c)
+		threads.emplace_back([&] {
+			long v, local = 0;
+			for (long i = 0; i < n; ++i) {
+				q.pop(v);
+				local += v;
+			}
+			sum += local;
+		});
+	for (int p = 0; p < 2; ++p)
+		threads.emplace_back([&] {
+			for (long i = 1; i <= n; ++i)
+				q.push(i);
+		});
+	for (auto &t : threads)
+		t.join();
+	ASSERT_EQ(sum, n * (n + 1));
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <list.hpp>
+#include <map.hpp>
+#include <memory>
+#include <node_pool_allocator.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(node_pool_allocator, reuse) {
+	tp::node_pool pool;
+	void *a = pool.allocate(24);
+	void *b = pool.allocate(24);
+	ASSERT_NE(a, b);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(a) % 16, 0);
+	ASSERT_EQ(pool.reserved(), std::size_t(64) << 10);
+
+	// freed nodes come back first, last in first out
+	pool.deallocate(a, 24);
+	pool.deallocate(b, 24);
+	ASSERT_EQ(pool.allocate(20), b);
+	ASSERT_EQ(pool.allocate(32), a);
+
+	// other size classes have their own lists
+	void *c = pool.allocate(100);
+	ASSERT_NE(c, a);
+	ASSERT_NE(c, b);
+
+	// a slab is only added once the current one is used up
+	for (int i = 0; i < 5000; ++i)
+		pool.allocate(64);
+	ASSERT_GT(pool.reserved(), std::size_t(64) << 10);
+}
+
+TEST(node_pool_allocator, rebind_and_equality) {
+	tp::node_pool_allocator<int> a;
+	tp::node_pool_allocator<int> b;
+	tp::node_pool_allocator<double> c(a);
+	ASSERT_TRUE(a == a);
+	ASSERT_FALSE(a == b);
+	ASSERT_TRUE(a == c);
+	ASSERT_TRUE(c == a);
+	ASSERT_EQ(a.resource(), c.resource());
+
+	auto shared = std::make_shared<tp::node_pool>();
+	tp::node_pool_allocator<int> d(shared);
+	tp::node_pool_allocator<long> e(shared);
+	ASSERT_TRUE(d == e);
+
+	// arrays and large types bypass the pool
+	int *arr = a.allocate(10);
+	arr[9]   = 1;
+	a.deallocate(arr, 10);
+	struct big {
+		char bytes[1024];
+	};
+	tp::node_pool_allocator<big> f(a);
+	big *p = f.allocate(1);
+	p->bytes[1023] = 0;
+	f.deallocate(p, 1);
+	ASSERT_EQ(a.resource()->reserved(), 0);
+}
+
+TEST(node_pool_allocator, list) {
+	using alloc = tp::node_pool_allocator<std::string>;
+	list<std::string, alloc> lst;
+	for (int i = 0; i < 1000; ++i)
+		lst.push_back(std::to_string(i));
+	ASSERT_EQ(lst.size(), 1000);
+	std::size_t reserved = lst.get_allocator().resource()->reserved();
+	ASSERT_GT(reserved, 0);
+
+	// churn reuses freed nodes instead of growing the pool
+	for (int round = 0; round < 10; ++round) {
+		lst.remove_if([](const std::string &s) { return s.size() == 3; });
+		for (int i = 100; i < 1000; ++i)
+			lst.push_back(std::to_string(i));
+	}
+	ASSERT_EQ(lst.size(), 1000);
+	ASSERT_EQ(lst.get_allocator().resource()->reserved(), reserved);
+
+	int expect = 0;
+	for (auto &s : lst)
+		ASSERT_EQ(s, std::to_string(expect++));
+
+	// containers can share one pool
+	auto pool = std::make_shared<tp::node_pool>();
+	list<int, tp::node_pool_allocator<int>> a{
+	    tp::node_pool_allocator<int>(pool)};
+	list<int, tp::node_pool_allocator<int>> b{
+	    tp::node_pool_allocator<int>(pool)};
+	a.push_back(1);
+	b.push_back(2);
+	a.splice(a.end(), b);
+	ASSERT_EQ(a.size(), 2);
+	ASSERT_TRUE(b.empty());
+
+	// a copy gets its own unlocked pool, a thread-safe pool is shared
+	auto copy = a;
+	ASSERT_NE(copy.get_allocator(), a.get_allocator());
+	ASSERT_EQ(*std::next(copy.begin()), 2);
+	copy.push_back(3);
+	ASSERT_EQ(a.size(), 2);
+	auto locked = std::make_shared<tp::node_pool>(2);
+	list<int, tp::node_pool_allocator<int>> c{
+	    tp::node_pool_allocator<int>(locked)};
+	c.push_back(1);
+	auto c_copy = c;
+	ASSERT_EQ(c_copy.get_allocator(), c.get_allocator());
+}
+
+TEST(node_pool_allocator, map) {
+	using value = tp::pair<const int, int>;
+	tp::map<int, int, tp::less<int>, tp::node_pool_allocator<value>> mp;
+	for (int i = 0; i < 1000; ++i)
+		mp.insert({i, i * 2});
+	ASSERT_EQ(mp.size(), 1000);
+	std::size_t reserved = mp.get_allocator().resource()->reserved();
+	ASSERT_GT(reserved, 0);
+
+	for (int round = 0; round < 10; ++round) {
+		for (int i = 0; i < 1000; i += 2)
+			mp.erase(mp.find(i));
+		ASSERT_EQ(mp.size(), 500);
+		for (int i = 0; i < 1000; i += 2)
+			mp.insert({i, i * 2});
+	}
+	ASSERT_EQ(mp.get_allocator().resource()->reserved(), reserved);
+	for (int i = 0; i < 1000; ++i)
+		ASSERT_EQ(mp.at(i), i * 2);
+
+	auto pool = std::make_shared<tp::node_pool>();
+	tp::map<int, int, tp::less<int>, tp::node_pool_allocator<value>> shared{
+	    tp::node_pool_allocator<value>(pool)};
+	shared[1] = 10;
+	ASSERT_EQ(shared.at(1), 10);
+	ASSERT_GT(pool->reserved(), 0);
+}
+
+TEST(node_pool_allocator, sharded_threads) {
+	auto pool = std::make_shared<tp::node_pool>(4);
+	using alloc = tp::node_pool_allocator<int>;
+	std::vector<std::thread> threads;
+	std::vector<long> sums(4);
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			list<int, alloc> lst{alloc(pool)};
+			for (int round = 0; round < 50; ++round) {
+				for (int i = 0; i < 200; ++i)
+					lst.push_back(i);
+				lst.remove_if([](int x) { return x % 3 != 0; });
+			}
+			long sum = 0;
+			for (int x : lst)
+				sum += x;
+			sums[t] = sum;
+		});
+	}
+	for (auto &th : threads)
+		th.join();
+
+	long expect = 0;
+	for (int i = 0; i < 200; i += 3)
+		expect += i;
+	for (long s : sums)
+		ASSERT_EQ(s, expect * 50);
+}
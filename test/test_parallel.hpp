@@ -0,0 +1,98 @@
+#include <atomic>
+#include <deque.hpp>
+#include <gtest/gtest.h>
+#include <parallel.hpp>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector.hpp>
+
+TEST(thread_pool, run) {
+	tp::thread_pool pool(4);
+	ASSERT_EQ(pool.concurrency(), 4);
+
+	std::atomic<long> sum = 0;
+	pool.run(1000, [&](std::size_t i) { sum += i; });
+	ASSERT_EQ(sum, 999 * 1000 / 2);
+
+	// nested run from inside a task must not deadlock
+	std::atomic<int> inner = 0;
+	pool.run(8, [&](std::size_t) {
+		pool.run(8, [&](std::size_t) { ++inner; });
+	});
+	ASSERT_EQ(inner, 64);
+
+	ASSERT_THROW(pool.run(100,
+	                      [](std::size_t i) {
+		                      if (i == 42)
+			                      throw std::runtime_error("task");
+	                      }),
+	             std::runtime_error);
+
+	// a single thread runs inline
+	tp::thread_pool serial(1);
+	ASSERT_EQ(serial.concurrency(), 1);
+	sum = 0;
+	serial.run(10, [&](std::size_t i) { sum += i; });
+	ASSERT_EQ(sum, 45);
+}
+
+TEST(parallel, for_each_transform) {
+	tp::thread_pool pool(4);
+	const int n = 100000;
+
+	vector<int> vec;
+	vec.resize(n);
+	tp::parallel_transform(vec.begin(), vec.end(), vec.begin(),
+	                       [](int) { return 1; }, pool);
+	tp::parallel_for_each(vec.begin(), vec.end(), [](int &x) { x *= 3; },
+	                      pool);
+	for (int x : vec)
+		ASSERT_EQ(x, 3);
+
+	// deque ranges are walked block by block, start mid-block on purpose
+	deque<int> dq(n, 0);
+	for (int i = 0; i < n; ++i)
+		dq[i] = i;
+	tp::parallel_for_each(dq.begin() + 7, dq.end() - 5, [](int &x) { x = -x; },
+	                      pool);
+	for (int i = 0; i < n; ++i)
+		ASSERT_EQ(dq[i], i >= 7 && i < n - 5 ? -i : i);
+
+	// deque -> vector
+	auto out = tp::parallel_transform(dq.begin(), dq.end(), vec.begin(),
+	                                  [](int x) { return 2 * x; }, pool);
+	ASSERT_TRUE(out == vec.end());
+	for (int i = 0; i < n; ++i)
+		ASSERT_EQ(vec[i], 2 * dq[i]);
+}
+
+TEST(parallel, sort) {
+	tp::thread_pool pool(4);
+	std::mt19937 rng(7);
+
+	for (int n : {0, 1, 100, 4096 * 5 + 3, 300001}) {
+		vector<int> vec;
+		for (int i = 0; i < n; ++i)
+			vec.push_back(rng() % 1000);
+		tp::parallel_sort(vec.begin(), vec.end(), std::less<>(), pool);
+		ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end())) << n;
+
+		deque<int> dq;
+		for (int i = 0; i < n; ++i)
+			dq.push_back(rng());
+		tp::parallel_sort(dq.begin(), dq.end(), std::greater<>(), pool);
+		ASSERT_TRUE(std::is_sorted(dq.begin(), dq.end(), std::greater<>()))
+		    << n;
+	}
+
+	// non-trivial elements go through the move buffer
+	vector<std::string> strs;
+	for (int i = 0; i < 50000; ++i)
+		strs.push_back(std::to_string(rng()));
+	vector<std::string> copy(strs);
+	tp::parallel_sort(strs.begin(), strs.end(), std::less<>(), pool);
+	std::sort(copy.begin(), copy.end());
+	for (int i = 0; i < 50000; ++i)
+		ASSERT_EQ(strs[i], copy[i]);
+}
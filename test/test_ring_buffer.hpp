@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <ring_buffer.hpp>
+#include <string>
+#include <vector>
+
+TEST(ring_buffer, capacity) {
+	tp::ring_buffer<int> rb(100);
+	ASSERT_EQ(rb.capacity(), 128);
+	ASSERT_TRUE(rb.empty());
+
+	tp::ring_buffer<int> none;
+	ASSERT_EQ(none.capacity(), 0);
+	ASSERT_FALSE(none.try_push_back(1));
+	ASSERT_THROW(none.push_back(1), std::length_error);
+}
+
+TEST(ring_buffer, push_pop) {
+	tp::ring_buffer<int> rb(8);
+	// walk the head around the array a few times
+	for (int round = 0; round < 5; ++round) {
+		for (int i = 0; i < 6; ++i)
+			rb.push_back(i);
+		ASSERT_EQ(rb.size(), 6);
+		ASSERT_EQ(rb.front(), 0);
+		ASSERT_EQ(rb.back(), 5);
+		for (int i = 0; i < 6; ++i) {
+			ASSERT_EQ(rb[i], i);
+			ASSERT_EQ(rb.at(i), i);
+		}
+		for (int i = 0; i < 6; ++i) {
+			ASSERT_EQ(rb.front(), i);
+			rb.pop_front();
+		}
+	}
+
+	rb.push_front(2);
+	rb.push_front(1);
+	rb.push_back(3);
+	ASSERT_EQ(rb[0], 1);
+	ASSERT_EQ(rb[2], 3);
+	rb.pop_back();
+	ASSERT_EQ(rb.back(), 2);
+	ASSERT_THROW(rb.at(2), std::out_of_range);
+
+	rb.clear();
+	for (int i = 0; i < 8; ++i)
+		rb.push_back(i);
+	ASSERT_TRUE(rb.full());
+	ASSERT_FALSE(rb.try_push_back(8));
+	ASSERT_FALSE(rb.try_push_front(8));
+	ASSERT_THROW(rb.push_back(8), std::length_error);
+	ASSERT_EQ(rb.size(), 8);
+	ASSERT_EQ(rb.back(), 7);
+}
+
+TEST(ring_buffer, overwrite) {
+	using ring = tp::ring_buffer<int>;
+	ring rb(4, ring::overflow::overwrite);
+	for (int i = 0; i < 10; ++i)
+		rb.push_back(i);
+	ASSERT_EQ(rb.size(), 4);
+	ASSERT_EQ(rb.front(), 6);
+	ASSERT_EQ(rb.back(), 9);
+
+	// at the front, the newest element goes
+	rb.push_front(5);
+	ASSERT_EQ(rb.front(), 5);
+	ASSERT_EQ(rb.back(), 8);
+
+	rb.set_mode(ring::overflow::reject);
+	ASSERT_THROW(rb.push_back(1), std::length_error);
+}
+
+TEST(ring_buffer, iterator) {
+	tp::ring_buffer<int> rb(8);
+	for (int i = 0; i < 6; ++i)
+		rb.push_back(i);
+	for (int i = 0; i < 4; ++i)
+		rb.pop_front();
+	for (int i = 6; i < 12; ++i)
+		rb.push_back(i);
+	// the elements wrap around the end of the array now
+
+	int expect = 4;
+	for (int v : rb)
+		ASSERT_EQ(v, expect++);
+	ASSERT_EQ(expect, 12);
+	ASSERT_EQ(rb.end() - rb.begin(), 8);
+	ASSERT_EQ(*(rb.begin() + 5), 9);
+	ASSERT_EQ(rb.begin()[7], 11);
+	ASSERT_TRUE(rb.begin() < rb.end());
+	ASSERT_TRUE(rb.begin() - 1 < rb.begin());
+
+	expect = 11;
+	for (auto it = rb.rbegin(); it != rb.rend(); ++it)
+		ASSERT_EQ(*it, expect--);
+	ASSERT_EQ(expect, 3);
+
+	const tp::ring_buffer<int> &crb = rb;
+	tp::ring_buffer<int>::const_iterator cit = rb.begin();
+	ASSERT_EQ(cit, crb.begin());
+	ASSERT_EQ(*std::find(crb.begin(), crb.end(), 10), 10);
+
+	std::sort(rb.begin(), rb.end(), std::greater<>());
+	ASSERT_EQ(rb.front(), 11);
+	ASSERT_EQ(rb.back(), 4);
+}
+
+TEST(ring_buffer, batch) {
+	tp::ring_buffer<int> rb(16);
+	std::vector<int> src(40);
+	for (int i = 0; i < 40; ++i)
+		src[i] = i;
+
+	for (int i = 0; i < 10; ++i)
+		rb.push_back(-1);
+	for (int i = 0; i < 10; ++i)
+		rb.pop_front();
+	// wraps: 6 slots to the end of the array, 6 from the start
+	ASSERT_EQ(rb.push_back_n(src.data(), 12), 12);
+	ASSERT_EQ(rb.push_back_n(src.data() + 12, 10), 4);
+	ASSERT_TRUE(rb.full());
+
+	int out[20];
+	ASSERT_EQ(rb.pop_front_n(out, 20), 16);
+	for (int i = 0; i < 16; ++i)
+		ASSERT_EQ(out[i], i);
+	ASSERT_TRUE(rb.empty());
+	ASSERT_EQ(rb.push_back_n(nullptr, 0), 0);
+	ASSERT_EQ(rb.pop_front_n(nullptr, 0), 0);
+
+	// in overwrite mode only the newest capacity() elements stay
+	using ring = tp::ring_buffer<int>;
+	ring ow(16, ring::overflow::overwrite);
+	ow.push_back_n(src.data(), 10);
+	ASSERT_EQ(ow.push_back_n(src.data() + 10, 30), 30);
+	ASSERT_EQ(ow.size(), 16);
+	ASSERT_EQ(ow.front(), 24);
+	ASSERT_EQ(ow.back(), 39);
+
+	ow.clear();
+	ow.append_range(src);
+	ASSERT_EQ(ow.front(), 24);
+	ring small(4);
+	ASSERT_THROW(small.append_range(src), std::length_error);
+}
+
+TEST(ring_buffer, strings) {
+	tp::ring_buffer<std::string> rb(4);
+	std::string words[] = {"a", "bb", "ccc", "dddd", "eeeee"};
+	ASSERT_EQ(rb.push_back_n(words, 3), 3);
+	rb.pop_front();
+	ASSERT_EQ(rb.push_back_n(words + 3, 2), 2);
+	ASSERT_EQ(rb.front(), "bb");
+	ASSERT_EQ(rb.back(), "eeeee");
+
+	tp::ring_buffer<std::string> copy(rb);
+	ASSERT_EQ(copy.size(), 4);
+	ASSERT_EQ(copy[1], "ccc");
+
+	std::string out[4];
+	ASSERT_EQ(rb.pop_front_n(out, 4), 4);
+	ASSERT_EQ(out[3], "eeeee");
+	ASSERT_TRUE(rb.empty());
+
+	rb = copy;
+	ASSERT_EQ(rb.size(), 4);
+	tp::ring_buffer<std::string> moved(std::move(rb));
+	ASSERT_EQ(moved.back(), "eeeee");
+	ASSERT_EQ(rb.capacity(), 0);
+
+	moved.resize(2);
+	ASSERT_EQ(moved.back(), "ccc");
+	moved.resize(4, "x");
+	ASSERT_EQ(moved.back(), "x");
+
+	// overwriting with a copy of the element being overwritten
+	using ring = tp::ring_buffer<std::string>;
+	ring ow(2, ring::overflow::overwrite);
+	ow.push_back(std::string(40, 'a'));
+	ow.push_back(std::string(40, 'b'));
+	ow.push_back(ow.front());
+	ASSERT_EQ(ow.front(), std::string(40, 'b'));
+	ASSERT_EQ(ow.back(), std::string(40, 'a'));
+	ow.push_front(ow.back());
+	ASSERT_EQ(ow.front(), std::string(40, 'a'));
+	ASSERT_EQ(ow.back(), std::string(40, 'b'));
+}
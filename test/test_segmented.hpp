@@ -0,0 +1,153 @@
+#include <deque.hpp>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <segmented.hpp>
+#include <string>
+#include <vector>
+
+// 16 ints per block, so a few hundred elements cross many blocks
+using seg_deque = deque<int, std::allocator<int>, 64>;
+
+static seg_deque make_seg_deque(int n) {
+	seg_deque dq;
+	for (int i = 0; i < n; ++i)
+		dq.push_back(i);
+	// start off a block boundary
+	dq.push_front(-1);
+	dq.push_front(-2);
+	return dq;
+}
+
+TEST(segmented, for_each_segment) {
+	seg_deque dq = make_seg_deque(100);
+	std::size_t pieces = 0, total = 0;
+	tp::for_each_segment(dq.begin(), dq.end(), [&](int *b, int *e) {
+		ASSERT_LE(e - b, 16);
+		++pieces, total += e - b;
+	});
+	ASSERT_EQ(total, dq.size());
+	ASSERT_GE(pieces, 7);
+
+	// a range inside one block is one piece
+	pieces = 0;
+	tp::for_each_segment(dq.begin() + 3, dq.begin() + 5,
+	                     [&](int *b, int *e) { ++pieces, total = e - b; });
+	ASSERT_EQ(pieces, 1);
+	ASSERT_EQ(total, 2);
+}
+
+TEST(segmented, copy) {
+	seg_deque dq = make_seg_deque(300);
+	std::vector<int> out(dq.size());
+	auto end = tp::copy(dq.begin(), dq.end(), out.begin());
+	ASSERT_EQ(end, out.end());
+	for (std::size_t i = 0; i < out.size(); ++i)
+		ASSERT_EQ(out[i], dq[i]);
+
+	// into a deque, at every offset within a block
+	for (int off = 0; off < 17; ++off) {
+		seg_deque dst(off + 100);
+		auto last = tp::copy(out.begin() + 5, out.begin() + 105,
+		                     dst.begin() + off);
+		ASSERT_EQ(last, dst.end());
+		for (int i = 0; i < 100; ++i)
+			ASSERT_EQ(dst[off + i], out[5 + i]);
+	}
+
+	// deque to deque, with the blocks out of phase
+	seg_deque dst(dq.size() + 7);
+	tp::copy(dq.begin(), dq.end(), dst.begin() + 7);
+	for (std::size_t i = 0; i < dq.size(); ++i)
+		ASSERT_EQ(dst[i + 7], dq[i]);
+
+	// empty
+	ASSERT_EQ(tp::copy(dq.begin(), dq.begin(), dst.begin()), dst.begin());
+}
+
+TEST(segmented, move) {
+	deque<std::string, std::allocator<std::string>, 128> src, dst;
+	for (int i = 0; i < 50; ++i)
+		src.push_back(std::string(30, 'a' + i % 26));
+	dst.resize(src.size());
+	tp::move(src.begin(), src.end(), dst.begin());
+	for (int i = 0; i < 50; ++i)
+		ASSERT_EQ(dst[i], std::string(30, 'a' + i % 26));
+}
+
+TEST(segmented, fill) {
+	seg_deque dq = make_seg_deque(200);
+	tp::fill(dq.begin() + 3, dq.end() - 20, 7);
+	for (std::size_t i = 0; i < dq.size(); ++i) {
+		bool inside = i >= 3 && i < dq.size() - 20;
+		ASSERT_EQ(dq[i] == 7, inside) << i;
+	}
+}
+
+TEST(segmented, find) {
+	seg_deque dq = make_seg_deque(500);
+	for (int v : {-2, -1, 0, 13, 14, 15, 16, 250, 499}) {
+		auto it = tp::find(dq.begin(), dq.end(), v);
+		ASSERT_EQ(it, std::find(dq.begin(), dq.end(), v));
+		ASSERT_EQ(*it, v);
+	}
+	ASSERT_EQ(tp::find(dq.begin(), dq.end(), 1000), dq.end());
+	// the value right before the end of the range is not past it
+	ASSERT_EQ(tp::find(dq.begin(), dq.begin() + 30, 28), dq.begin() + 30);
+	ASSERT_EQ(tp::find(dq.begin(), dq.begin() + 30, 27), dq.begin() + 29);
+
+	// the element closing a block gives an iterator equal to the usual one
+	seg_deque full;
+	for (int i = 0; i < 64; ++i)
+		full.push_back(i);
+	ASSERT_EQ(tp::find(full.begin(), full.end(), 15), full.begin() + 15);
+	ASSERT_EQ(tp::find(full.begin(), full.end(), 63), full.end() - 1);
+	ASSERT_EQ(tp::find(full.begin(), full.end(), 64), full.end());
+}
+
+TEST(segmented, accumulate) {
+	seg_deque dq = make_seg_deque(1000);
+	long sum = tp::accumulate(dq.begin(), dq.end(), 0L);
+	ASSERT_EQ(sum, std::accumulate(dq.begin(), dq.end(), 0L));
+	auto max = [](long a, int b) { return std::max(a, long(b)); };
+	long mx  = tp::accumulate(dq.begin(), dq.end(), -100L, max);
+	ASSERT_EQ(mx, 999);
+
+	int count = 0;
+	tp::for_each(dq.begin() + 10, dq.end(), [&](int &v) { v = 0, ++count; });
+	ASSERT_EQ(count, dq.size() - 10);
+	ASSERT_EQ(tp::accumulate(dq.begin(), dq.end(), 0L), 0 + 1 + 2 + 3 + 4 +
+	                                                        5 + 6 + 7 - 3);
+}
+
+TEST(segmented, plain_iterators) {
+	int a[] = {5, 3, 9, 1};
+	int b[4];
+	ASSERT_EQ(tp::copy(a, a + 4, b), b + 4);
+	ASSERT_EQ(tp::find(b, b + 4, 9), b + 2);
+	ASSERT_EQ(tp::accumulate(b, b + 4, 0), 18);
+	tp::fill(b, b + 4, 2);
+	ASSERT_EQ(tp::accumulate(b, b + 4, 0), 8);
+}
+
+TEST(segmented, deque_bulk_paths) {
+	// construction and assignment go through the segment loops
+	seg_deque dq = make_seg_deque(300);
+	seg_deque copy(dq);
+	ASSERT_EQ(copy.size(), dq.size());
+	for (std::size_t i = 0; i < dq.size(); ++i)
+		ASSERT_EQ(copy[i], dq[i]);
+
+	seg_deque filled(100, 4);
+	ASSERT_EQ(tp::accumulate(filled.begin(), filled.end(), 0), 400);
+	filled = dq;
+	ASSERT_EQ(filled.size(), dq.size());
+	ASSERT_EQ(filled.back(), 299);
+
+	deque<std::string, std::allocator<std::string>, 128> strs(40, "abc");
+	deque<std::string, std::allocator<std::string>, 128> strs2(strs);
+	ASSERT_EQ(strs2[39], "abc");
+	strs2.insert(strs2.begin() + 5, 10, "x");
+	ASSERT_EQ(strs2.size(), 50);
+	ASSERT_EQ(strs2[5], "x");
+	ASSERT_EQ(strs2[15], "abc");
+}
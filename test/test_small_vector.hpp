@@ -0,0 +1,112 @@
+#include <small_vector.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(small_vector, inline_storage) {
+	tp::small_vector<int, 4> vec{1, 2, 3};
+	ASSERT_TRUE(vec.is_inline());
+	ASSERT_EQ(vec.capacity(), 4);
+
+	vec.push_back(4);
+	ASSERT_TRUE(vec.is_inline());
+
+	// spills to the heap past N
+	vec.push_back(5);
+	ASSERT_FALSE(vec.is_inline());
+	for (int i = 0; i < 5; ++i)
+		ASSERT_EQ(vec[i], i + 1);
+
+	// and comes back once it fits again
+	vec.pop_back();
+	vec.shrink_to_fit();
+	ASSERT_TRUE(vec.is_inline());
+	ASSERT_EQ(vec.size(), 4);
+	ASSERT_EQ(vec.back(), 4);
+}
+
+TEST(small_vector, insert_erase) {
+	tp::small_vector<std::string, 2> vec{"a", "d"};
+	std::initializer_list<std::string> target{"a", "b", "c", "d", "e"};
+
+	auto it = vec.insert(vec.begin() + 1, {"b", "c"});
+	ASSERT_EQ(*it, "b");
+	vec.emplace_back("e");
+
+	auto src = target.begin();
+	for (auto &s : vec)
+		ASSERT_EQ(s, *(src++));
+
+	it = vec.erase(vec.begin() + 1, vec.begin() + 3);
+	ASSERT_EQ(*it, "d");
+	ASSERT_EQ(vec.size(), 3);
+	ASSERT_EQ(vec.front(), "a");
+	ASSERT_EQ(vec.back(), "e");
+}
+
+TEST(small_vector, aliasing) {
+	std::string a(40, 'a'), b(40, 'b');
+	// growing out of the inline buffer
+	tp::small_vector<std::string, 2> vec{a, b};
+	vec.push_back(vec[0]);
+	ASSERT_EQ(vec.size(), 3);
+	ASSERT_EQ(vec[0], a);
+	ASSERT_EQ(vec[2], a);
+
+	// an element that the gap shifts
+	vec.insert(vec.begin(), vec[1]);
+	ASSERT_EQ(vec[0], b);
+	ASSERT_EQ(vec[2], b);
+	vec.insert(vec.begin(), 2, vec.back());
+	ASSERT_EQ(vec[0], a);
+	ASSERT_EQ(vec[1], a);
+	ASSERT_EQ(vec.size(), 6);
+	vec.emplace(vec.begin() + 1, vec[5]);
+	ASSERT_EQ(vec[1], a);
+	ASSERT_EQ(vec.size(), 7);
+}
+
+TEST(small_vector, move) {
+	tp::small_vector<std::string, 2> inl{"a"};
+	tp::small_vector<std::string, 2> heap{"a", "b", "c"};
+	const std::string *heap_data = heap.data();
+
+	tp::small_vector<std::string, 2> dst1(std::move(inl));
+	tp::small_vector<std::string, 2> dst2(std::move(heap));
+
+	ASSERT_TRUE(inl.empty());
+	ASSERT_TRUE(heap.empty());
+	ASSERT_TRUE(heap.is_inline());
+	ASSERT_EQ(dst1.size(), 1);
+	ASSERT_EQ(dst1[0], "a");
+	// heap buffer is taken over, not copied
+	ASSERT_EQ(dst2.data(), heap_data);
+
+	dst1.swap(dst2);
+	ASSERT_EQ(dst1.size(), 3);
+	ASSERT_EQ(dst2.size(), 1);
+	ASSERT_EQ(dst1[2], "c");
+	ASSERT_EQ(dst2[0], "a");
+}
+
+TEST(small_vector, vector_conversion) {
+	vector<int> vec{1, 2, 3, 4, 5};
+	const int *vec_data = vec.data();
+
+	tp::small_vector<int, 2> svec(std::move(vec));
+	ASSERT_EQ(svec.data(), vec_data);
+	ASSERT_EQ(svec.size(), 5);
+	ASSERT_TRUE(vec.empty());
+
+	vector<int> back = std::move(svec).to_vector();
+	ASSERT_EQ(back.data(), vec_data);
+	ASSERT_EQ(back.size(), 5);
+	ASSERT_TRUE(svec.empty());
+	ASSERT_TRUE(svec.is_inline());
+
+	tp::small_vector<int, 8> small(back);
+	ASSERT_TRUE(small.is_inline());
+	vector<int> copy = small.to_vector();
+	ASSERT_EQ(copy.size(), 5);
+	for (int i = 0; i < 5; ++i)
+		ASSERT_EQ(copy[i], back[i]);
+}
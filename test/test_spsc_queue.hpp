@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <spsc_queue.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::size_t spsc_block_allocs = 0;
+static long spsc_live_strings        = 0;
+
+template <typename T> struct spsc_counting_allocator : std::allocator<T> {
+	template <typename U> struct rebind {
+		using other = spsc_counting_allocator<U>;
+	};
+
+	spsc_counting_allocator() = default;
+	template <typename U>
+	spsc_counting_allocator(const spsc_counting_allocator<U> &) {}
+
+	T *allocate(std::size_t n) {
+		++spsc_block_allocs;
+		return std::allocator<T>::allocate(n);
+	}
+
+	template <typename U, typename... Args>
+	void construct(U *p, Args &&...args) {
+		if constexpr (std::is_same_v<U, std::string>)
+			++spsc_live_strings;
+		::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+	}
+
+	template <typename U> void destroy(U *p) {
+		if constexpr (std::is_same_v<U, std::string>)
+			--spsc_live_strings;
+		p->~U();
+	}
+};
+
+TEST(spsc_queue, single_thread) {
+	tp::spsc_queue<int, 64> q;
+	ASSERT_EQ(q.block_size(), 16);
+	int v = -1;
+	ASSERT_TRUE(q.empty());
+	ASSERT_FALSE(q.try_pop(v));
+
+	// across several blocks
+	for (int i = 0; i < 100; ++i)
+		q.push(i);
+	ASSERT_FALSE(q.empty());
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_TRUE(q.try_pop(v));
+		ASSERT_EQ(v, i);
+	}
+	ASSERT_FALSE(q.try_pop(v));
+	ASSERT_TRUE(q.empty());
+}
+
+TEST(spsc_queue, batch) {
+	tp::spsc_queue<int, 64> q;
+	std::vector<int> src(100);
+	for (int i = 0; i < 100; ++i)
+		src[i] = i;
+	q.push(-1);
+	ASSERT_EQ(q.try_push_n(src.data(), 100), 100);
+
+	int out[150];
+	ASSERT_EQ(q.try_pop_n(out, 30), 30);
+	ASSERT_EQ(out[0], -1);
+	ASSERT_EQ(out[29], 28);
+	ASSERT_EQ(q.try_pop_n(out, 150), 71);
+	ASSERT_EQ(out[70], 99);
+	ASSERT_EQ(q.try_pop_n(out, 10), 0);
+}
+
+TEST(spsc_queue, recycles_blocks) {
+	spsc_block_allocs = 0;
+	tp::spsc_queue<int, 64, spsc_counting_allocator<int>> q;
+	int v;
+	for (int i = 0; i < 40; ++i)
+		q.push(i);
+	for (int round = 0; round < 1000; ++round) {
+		for (int i = 0; i < 40; ++i)
+			q.push(i);
+		for (int i = 0; i < 40; ++i)
+			ASSERT_TRUE(q.try_pop(v));
+	}
+	// 40 queued plus the 40 in flight fit in a handful of blocks
+	ASSERT_LE(spsc_block_allocs, 8);
+}
+
+TEST(spsc_queue, strings) {
+	tp::spsc_queue<std::string, 128> q;
+	std::string words[] = {"one", "two", "three"};
+	for (int i = 0; i < 20; ++i)
+		q.try_push_n(words, 3);
+	q.emplace(40, 'x');
+
+	std::string out[10];
+	ASSERT_EQ(q.try_pop_n(out, 10), 10);
+	ASSERT_EQ(out[9], "one");
+	std::string s;
+	ASSERT_TRUE(q.try_pop(s));
+	ASSERT_EQ(s, "two");
+	// the rest is destroyed with the queue
+}
+
+TEST(spsc_queue, allocator_construct) {
+	{
+		tp::spsc_queue<std::string, 128, spsc_counting_allocator<std::string>>
+		    q;
+		std::string words[] = {"one", "two", "three"};
+		for (int i = 0; i < 10; ++i)
+			q.try_push_n(words, 3);
+		q.emplace(40, 'x');
+		ASSERT_EQ(spsc_live_strings, 31);
+		std::string out[10];
+		q.try_pop_n(out, 10);
+		std::string s;
+		q.try_pop(s);
+		ASSERT_EQ(spsc_live_strings, 20);
+	}
+	ASSERT_EQ(spsc_live_strings, 0);
+}
+
+TEST(spsc_queue, two_threads) {
+	tp::spsc_queue<long, 256> q;
+	constexpr long n = 200000;
+	std::thread producer([&] {
+		long batch[7];
+		for (long i = 0; i < n;) {
+			if (i % 3 == 0 && i + 7 <= n) {
+				for (int k = 0; k < 7; ++k)
+					batch[k] = i + k;
+				q.try_push_n(batch, 7);
+				i += 7;
+			} else {
+				q.push(i++);
+			}
+		}
+	});
+
+	long expect = 0, buf[16];
+	while (expect < n) {
+		long got = q.try_pop_n(buf, 1 + expect % 16);
+		if (got == 0) {
+			std::this_thread::yield();
+			continue;
+		}
+		for (long k = 0; k < got; ++k)
+			ASSERT_EQ(buf[k], expect++);
+	}
+	producer.join();
+	ASSERT_TRUE(q.empty());
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <stable_vector.hpp>
+#include <string>
+#include <vector.hpp>
+
+TEST(stable_vector, pointer_stability) {
+	tp::stable_vector<int, 4> vec;
+	ASSERT_TRUE(vec.empty());
+
+	vec.push_back(0);
+	int *first = &vec[0];
+	vector<int *> ptrs;
+	for (int i = 1; i < 1000; ++i) {
+		vec.push_back(i);
+		ptrs.push_back(&vec.back());
+	}
+	// growth never moves an element
+	ASSERT_EQ(first, &vec[0]);
+	for (int i = 1; i < 1000; ++i) {
+		ASSERT_EQ(ptrs[i - 1], &vec[i]);
+		ASSERT_EQ(*ptrs[i - 1], i);
+	}
+
+	// blocks double: 4, 8, 16, ...
+	ASSERT_EQ(vec.block_size(0), 4);
+	ASSERT_EQ(vec.block_size(3), 32);
+	ASSERT_EQ(vec.capacity(), 1020);
+	ASSERT_EQ(vec.block_count(), 8);
+	ASSERT_EQ(vec.at(999), 999);
+	ASSERT_THROW(vec.at(1000), std::out_of_range);
+}
+
+TEST(stable_vector, iterator) {
+	tp::stable_vector<int, 2> vec;
+	for (int i = 0; i < 100; ++i)
+		vec.push_back(i);
+
+	int expect = 0;
+	for (int x : vec)
+		ASSERT_EQ(x, expect++);
+	ASSERT_EQ(expect, 100);
+	ASSERT_EQ(vec.end() - vec.begin(), 100);
+
+	// random access across block boundaries, both directions
+	auto it = vec.begin() + 37;
+	ASSERT_EQ(*it, 37);
+	it -= 30;
+	ASSERT_EQ(*it, 7);
+	ASSERT_EQ(it[50], 57);
+	ASSERT_EQ(*--(vec.begin() + 6), 5);
+	ASSERT_EQ(*(vec.end() - 1), 99);
+
+	expect = 99;
+	for (auto rit = vec.rbegin(); rit != vec.rend(); ++rit)
+		ASSERT_EQ(*rit, expect--);
+	ASSERT_EQ(expect, -1);
+
+	tp::stable_vector<int, 2>::const_iterator cit = vec.begin();
+	ASSERT_TRUE(cit == vec.cbegin());
+	ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end()));
+	std::sort(vec.begin(), vec.end(), std::greater<>());
+	ASSERT_EQ(vec.front(), 99);
+}
+
+TEST(stable_vector, resize_copy_move) {
+	tp::stable_vector<std::string> vec(40, "x");
+	ASSERT_EQ(vec.size(), 40);
+	vec.resize(10);
+	vec.resize(20, "y");
+	ASSERT_EQ(vec[9], "x");
+	ASSERT_EQ(vec[10], "y");
+
+	tp::stable_vector<std::string> copy(vec);
+	ASSERT_EQ(copy.size(), 20);
+	ASSERT_EQ(copy[19], "y");
+
+	std::string *p = &vec[5];
+	tp::stable_vector<std::string> moved(std::move(vec));
+	ASSERT_EQ(&moved[5], p);
+	ASSERT_TRUE(vec.empty());
+
+	vec = {"a", "b"};
+	ASSERT_EQ(vec.size(), 2);
+	vec = copy;
+	ASSERT_EQ(vec[19], "y");
+
+	// shrink_to_fit frees the blocks past the last element
+	moved.reserve(1000);
+	ASSERT_GE(moved.capacity(), 1000);
+	moved.pop_back();
+	moved.shrink_to_fit();
+	ASSERT_EQ(moved.capacity(), 48);
+	moved.clear();
+	moved.shrink_to_fit();
+	ASSERT_EQ(moved.capacity(), 0);
+}
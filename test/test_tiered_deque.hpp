@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <tiered_deque.hpp>
+
+TEST(tiered_deque, ends) {
+	tp::tiered_deque<int> td;
+	ASSERT_TRUE(td.empty());
+	ASSERT_EQ(td.begin(), td.end());
+
+	int n = int(td.block_size()) * 5 + 3;
+	for (int i = 0; i < n; ++i) {
+		td.push_back(i);
+		td.push_front(-i - 1);
+	}
+	ASSERT_EQ(td.size(), 2 * n);
+	ASSERT_EQ(td.front(), -n);
+	ASSERT_EQ(td.back(), n - 1);
+	for (int i = 0; i < 2 * n; ++i)
+		ASSERT_EQ(td[i], i - n);
+	ASSERT_THROW(td.at(2 * n), std::out_of_range);
+
+	for (int i = 0; i < n; ++i) {
+		td.pop_front();
+		td.pop_back();
+	}
+	ASSERT_TRUE(td.empty());
+	ASSERT_EQ(td.block_count(), 0);
+}
+
+TEST(tiered_deque, middle) {
+	// random inserts and erases checked against std::deque
+	std::mt19937 rng(7);
+	tp::tiered_deque<long> td;
+	std::deque<long> ref;
+	for (int step = 0; step < 40000; ++step) {
+		std::size_t pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+		if (step < 25000 || rng() % 3) {
+			td.insert(td.begin() + pos, step);
+			ref.insert(ref.begin() + pos, step);
+		} else if (pos < ref.size()) {
+			auto it = td.erase(td.begin() + pos);
+			ref.erase(ref.begin() + pos);
+			if (pos < ref.size()) {
+				ASSERT_EQ(*it, ref[pos]);
+			}
+		}
+		if (step % 997 == 0) {
+			ASSERT_TRUE(
+			    std::equal(td.begin(), td.end(), ref.begin(), ref.end()));
+		}
+	}
+	ASSERT_EQ(td.size(), ref.size());
+	for (std::size_t i = 0; i < ref.size(); ++i)
+		ASSERT_EQ(td[i], ref[i]);
+
+	// splits keep blocks at least half full on the way up
+	ASSERT_LE(td.block_count(), 2 * td.size() / td.block_size() + 2);
+
+	// erasing most of it merges the sparse blocks back
+	auto first = td.begin() + 10;
+	td.erase(first, first + (td.size() - 20));
+	ref.erase(ref.begin() + 10, ref.end() - 10);
+	ASSERT_TRUE(std::equal(td.begin(), td.end(), ref.begin(), ref.end()));
+	ASSERT_LE(td.block_count(), 2);
+}
+
+TEST(tiered_deque, iterator) {
+	tp::tiered_deque<int> td;
+	for (int i = 0; i < 1000; ++i)
+		td.push_back(i);
+	// uneven blocks
+	for (int i = 0; i < 300; ++i)
+		td.insert(td.begin() + 500, -1);
+	td.erase(td.begin() + 500, td.begin() + 800);
+
+	ASSERT_EQ(td.end() - td.begin(), 1000);
+	auto it = td.begin() + 123;
+	ASSERT_EQ(*it, 123);
+	ASSERT_EQ(it[400], 523);
+	ASSERT_EQ(*(it - 23), 100);
+	ASSERT_TRUE(it < td.end());
+	ASSERT_EQ(*--td.end(), 999);
+
+	int expect = 0;
+	for (int v : td)
+		ASSERT_EQ(v, expect++);
+
+	const tp::tiered_deque<int> &ctd = td;
+	tp::tiered_deque<int>::const_iterator cit = td.begin();
+	ASSERT_EQ(cit, ctd.begin());
+	ASSERT_EQ(*std::lower_bound(ctd.begin(), ctd.end(), 777), 777);
+
+	std::sort(td.begin(), td.end(), std::greater<>());
+	ASSERT_EQ(td.front(), 999);
+	ASSERT_EQ(td.back(), 0);
+}
+
+TEST(tiered_deque, strings) {
+	tp::tiered_deque<std::string> td{"a", "b", "c"};
+	for (int i = 0; i < 200; ++i)
+		td.insert(td.begin() + 1, std::string(i % 30, 'x'));
+	td.emplace(td.begin(), 3, 'z');
+	// an argument that refers into the container
+	td.insert(td.begin() + 2, td[0]);
+	ASSERT_EQ(td[0], "zzz");
+	ASSERT_EQ(td[2], "zzz");
+	ASSERT_EQ(td.back(), "c");
+
+	tp::tiered_deque<std::string> copy(td);
+	ASSERT_EQ(copy.size(), td.size());
+	ASSERT_TRUE(std::equal(copy.begin(), copy.end(), td.begin()));
+
+	tp::tiered_deque<std::string> moved(std::move(copy));
+	ASSERT_TRUE(copy.empty());
+	ASSERT_EQ(moved[1], "a");
+	while (moved.size() > 2)
+		moved.erase(moved.begin() + 1);
+	ASSERT_EQ(moved[1], "c");
+
+	td = moved;
+	ASSERT_EQ(td.size(), 2);
+}
+
+static long tiered_live = 0; // constructed minus destroyed
+
+template <typename T> struct tiered_tracking_allocator : std::allocator<T> {
+	template <typename U> struct rebind {
+		using other = tiered_tracking_allocator<U>;
+	};
+
+	tiered_tracking_allocator() = default;
+	template <typename U>
+	tiered_tracking_allocator(const tiered_tracking_allocator<U> &) {}
+
+	template <typename U, typename... Args>
+	void construct(U *p, Args &&...args) {
+		++tiered_live;
+		::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+	}
+
+	template <typename U> void destroy(U *p) {
+		--tiered_live;
+		p->~U();
+	}
+};
+
+TEST(tiered_deque, allocator_construct) {
+	{
+		tp::tiered_deque<std::string, tiered_tracking_allocator<std::string>>
+		    td;
+		// splits, merges and shifts all go through the allocator
+		for (int i = 0; i < 500; ++i)
+			td.insert(td.begin() + td.size() / 2, std::to_string(i));
+		ASSERT_EQ(tiered_live, 500);
+		for (int i = 0; i < 400; ++i)
+			td.erase(td.begin() + (i * 7) % td.size());
+		ASSERT_EQ(tiered_live, 100);
+		td.push_front("f");
+		td.push_back("b");
+		ASSERT_EQ(tiered_live, 102);
+	}
+	ASSERT_EQ(tiered_live, 0);
+}
@@ -0,0 +1,160 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <timer_wheel.hpp>
+#include <utility>
+#include <vector>
+
+struct wheel_timer {
+	int id                 = 0;
+	std::uint64_t fired_at = 0;
+	int fired              = 0;
+	tp::timer_hook timer;
+};
+
+using test_wheel = tp::timer_wheel<wheel_timer, &wheel_timer::timer>;
+
+TEST(timer_wheel, fires_on_time) {
+	// on and around every level boundary, and past the 2^32 span
+	std::vector<std::uint64_t> when = {
+	    1,     2,     255,   256,          257,
+	    511,   65535, 65536, 65537,        70000,
+	    1 << 24,      (1 << 24) + 1,       (1 << 24) + 300,
+	    1ull << 32,   (1ull << 32) + 5,    (1ull << 33) + 77};
+	std::vector<wheel_timer> timers(when.size());
+
+	test_wheel wheel;
+	for (std::size_t i = 0; i < when.size(); ++i) {
+		timers[i].id = int(i);
+		wheel.schedule(timers[i], when[i]);
+		ASSERT_TRUE(test_wheel::pending(timers[i]));
+	}
+
+	auto on_expire = [&](wheel_timer &t) {
+		t.fired_at = wheel.now();
+		++t.fired;
+	};
+	std::size_t fired = 0;
+	// uneven steps, then big jumps
+	for (std::uint64_t to = 0; to < 100000; to += 37)
+		fired += wheel.advance(to, on_expire);
+	for (std::uint64_t to = 100000; to <= (1ull << 33) + 100; to += 1 << 20)
+		fired += wheel.advance(to, on_expire);
+	fired += wheel.advance((1ull << 33) + 100, on_expire);
+
+	ASSERT_EQ(fired, when.size());
+	for (std::size_t i = 0; i < when.size(); ++i) {
+		ASSERT_EQ(timers[i].fired, 1) << when[i];
+		ASSERT_EQ(timers[i].fired_at, when[i]);
+		ASSERT_FALSE(test_wheel::pending(timers[i]));
+	}
+}
+
+TEST(timer_wheel, reschedule_cancel) {
+	test_wheel wheel(1000);
+	wheel_timer a, b, c;
+	wheel.schedule(a, 1010);
+	wheel.schedule(b, 1020);
+	wheel.schedule(c, 5000);
+
+	// a past expiry fires on the next tick
+	wheel_timer late;
+	wheel.schedule(late, 10);
+	ASSERT_EQ(late.timer.expires, 1001);
+
+	wheel.schedule(a, 1030); // moved
+	wheel.cancel(b);
+	ASSERT_FALSE(test_wheel::pending(b));
+	{
+		wheel_timer gone;
+		wheel.schedule(gone, 1015);
+	} // unlinked by its destructor
+
+	std::vector<wheel_timer *> order;
+	auto on_expire = [&](wheel_timer &t) { order.push_back(&t); };
+	ASSERT_EQ(wheel.advance(1100, on_expire), 2);
+	ASSERT_EQ(order, (std::vector<wheel_timer *>{&late, &a}));
+	ASSERT_TRUE(test_wheel::pending(c));
+	ASSERT_EQ(wheel.now(), 1100);
+}
+
+TEST(timer_wheel, callbacks) {
+	test_wheel wheel;
+	wheel_timer periodic, victim, self_cancel;
+	wheel.schedule(periodic, 10);
+	wheel.schedule(victim, 50);
+	wheel.schedule(self_cancel, 10);
+
+	// a periodic timer reschedules itself; a callback cancels another
+	// timer of the same tick and one in the future
+	int ticks = 0;
+	auto on_expire = [&](wheel_timer &t) {
+		if (&t == &periodic) {
+			++ticks;
+			wheel.cancel(self_cancel);
+			if (ticks == 3)
+				wheel.cancel(victim);
+			wheel.schedule(periodic, wheel.now() + 10);
+		}
+		++t.fired;
+	};
+	wheel.advance(100, on_expire);
+	ASSERT_EQ(ticks, 10);
+	ASSERT_EQ(victim.fired, 0);
+	ASSERT_EQ(self_cancel.fired, 0);
+	ASSERT_TRUE(test_wheel::pending(periodic));
+	ASSERT_EQ(periodic.timer.expires, 110);
+}
+
+TEST(timer_wheel, random) {
+	// 3 levels of 16 slots span 4096 ticks, so far timers are common
+	using small_wheel = tp::timer_wheel<wheel_timer, &wheel_timer::timer, 3, 4>;
+	small_wheel wheel(12345);
+	std::vector<wheel_timer> timers(500);
+	std::vector<std::uint64_t> due(timers.size(), 0); // 0: not pending
+	std::mt19937_64 rng(3);
+
+	auto arm = [&](int id) {
+		std::uint64_t delay = rng() % 4 == 0 ? rng() % 20000 : rng() % 300;
+		std::uint64_t at    = wheel.now() + 1 + delay;
+		wheel.schedule(timers[id], at);
+		due[id] = at;
+	};
+	for (std::size_t i = 0; i < timers.size(); ++i) {
+		timers[i].id = int(i);
+		arm(int(i));
+	}
+
+	std::uint64_t fired = 0;
+	bool rearm          = true;
+	auto on_expire      = [&](wheel_timer &t) {
+		ASSERT_EQ(wheel.now(), due[t.id]);
+		due[t.id] = 0;
+		++fired;
+		if (rearm && rng() % 2)
+			arm(t.id);
+	};
+	for (int step = 0; step < 3000; ++step) {
+		int id = int(rng() % timers.size());
+		switch (rng() % 3) {
+		case 0:
+			arm(id);
+			break;
+		case 1:
+			wheel.cancel(timers[id]);
+			due[id] = 0;
+			break;
+		default:
+			// mostly short steps, some jumps over several buckets
+			std::uint64_t by = rng() % 8 ? rng() % 64 : rng() % 5000;
+			wheel.advance(wheel.now() + by, on_expire);
+		}
+		for (std::size_t i = 0; i < timers.size(); ++i)
+			ASSERT_EQ(small_wheel::pending(timers[i]), due[i] != 0);
+	}
+	rearm = false;
+	wheel.advance(wheel.now() + 50000, on_expire);
+	ASSERT_GT(fired, 1000);
+	for (std::size_t i = 0; i < timers.size(); ++i)
+		ASSERT_FALSE(small_wheel::pending(timers[i]));
+}
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <unrolled_list.hpp>
+#include <vector>
+
+// 64-byte nodes hold 10 ints, so a few dozen elements span many nodes
+using small_unrolled = tp::unrolled_list<int, std::allocator<int>, 64>;
+
+template <typename List, typename Ref>
+static void expect_same(List &lt, const Ref &ref) {
+	ASSERT_EQ(lt.size(), ref.size());
+	ASSERT_TRUE(std::equal(lt.begin(), lt.end(), ref.begin(), ref.end()));
+	// walk back as well; node boundaries are crossed both ways
+	auto it = lt.end();
+	for (auto rit = ref.rbegin(); rit != ref.rend(); ++rit)
+		ASSERT_EQ(*--it, *rit);
+	ASSERT_TRUE(it == lt.begin());
+}
+
+TEST(unrolled_list, push_pop) {
+	small_unrolled lt;
+	ASSERT_EQ(small_unrolled::node_elems, 10);
+	ASSERT_TRUE(lt.empty());
+	ASSERT_TRUE(lt.begin() == lt.end());
+
+	std::list<int> ref;
+	for (int i = 0; i < 35; ++i) {
+		lt.push_back(i);
+		ref.push_back(i);
+		lt.push_front(-i);
+		ref.push_front(-i);
+	}
+	expect_same(lt, ref);
+	ASSERT_EQ(lt.front(), -34);
+	ASSERT_EQ(lt.back(), 34);
+	// push_back fills nodes completely
+	ASSERT_LE(lt.node_count(), 70 / 5 + 1);
+
+	for (int i = 0; i < 20; ++i) {
+		lt.pop_back();
+		ref.pop_back();
+		lt.pop_front();
+		ref.pop_front();
+	}
+	expect_same(lt, ref);
+	lt.clear();
+	ASSERT_TRUE(lt.empty());
+	ASSERT_EQ(lt.node_count(), 0);
+}
+
+TEST(unrolled_list, insert_split) {
+	small_unrolled lt(10, 0);
+	ASSERT_EQ(lt.node_count(), 1);
+
+	// into the middle of a full node: it splits
+	auto it = std::next(lt.begin(), 3);
+	it      = lt.insert(it, 7);
+	ASSERT_EQ(*it, 7);
+	ASSERT_EQ(lt.node_count(), 2);
+	std::vector<int> expect(10, 0);
+	expect.insert(expect.begin() + 3, 7);
+	expect_same(lt, expect);
+
+	// before every element; returned iterators stay usable
+	std::list<int> ref(lt.begin(), lt.end());
+	auto rit = ref.begin();
+	for (it = lt.begin(); it != lt.end(); ++it, ++rit) {
+		it  = lt.insert(it, 100);
+		rit = ref.insert(rit, 100);
+		++it;
+		++rit;
+	}
+	expect_same(lt, ref);
+
+	// emplace with an argument that lives in the list
+	lt.emplace(std::next(lt.begin()), lt.back());
+	ref.emplace(std::next(ref.begin()), ref.back());
+	expect_same(lt, ref);
+}
+
+TEST(unrolled_list, erase_merge) {
+	small_unrolled lt;
+	for (int i = 0; i < 100; ++i)
+		lt.push_back(i);
+	ASSERT_EQ(lt.node_count(), 10);
+
+	// drop most of every node: sparse nodes are merged
+	std::list<int> ref(lt.begin(), lt.end());
+	auto rit = ref.begin();
+	for (auto it = lt.begin(); it != lt.end();) {
+		ASSERT_EQ(*it, *rit);
+		if (*it % 10 < 8) {
+			it  = lt.erase(it);
+			rit = ref.erase(rit);
+		} else {
+			++it;
+			++rit;
+		}
+	}
+	expect_same(lt, ref);
+	ASSERT_EQ(lt.size(), 20);
+	ASSERT_LT(lt.node_count(), 10);
+
+	auto it = lt.erase(std::next(lt.begin(), 2), std::next(lt.begin(), 15));
+	ref.erase(std::next(ref.begin(), 2), std::next(ref.begin(), 15));
+	ASSERT_EQ(*it, *std::next(ref.begin(), 2));
+	expect_same(lt, ref);
+
+	it = lt.erase(lt.begin(), lt.end());
+	ASSERT_TRUE(it == lt.end());
+	ASSERT_TRUE(lt.empty());
+}
+
+TEST(unrolled_list, splice) {
+	small_unrolled a, b;
+	for (int i = 0; i < 25; ++i) {
+		a.push_back(i);
+		b.push_back(100 + i);
+	}
+	std::list<int> ra(a.begin(), a.end()), rb(b.begin(), b.end());
+
+	// inside a node: it is split, nothing else moves
+	a.splice(std::next(a.begin(), 13), b, std::next(b.begin(), 4),
+	         std::next(b.begin(), 17));
+	ra.splice(std::next(ra.begin(), 13), rb, std::next(rb.begin(), 4),
+	          std::next(rb.begin(), 17));
+	expect_same(a, ra);
+	expect_same(b, rb);
+
+	// at node boundaries
+	a.splice(a.begin(), b, b.begin(), b.end());
+	ra.splice(ra.begin(), rb, rb.begin(), rb.end());
+	expect_same(a, ra);
+	ASSERT_TRUE(b.empty());
+
+	small_unrolled c{1, 2, 3};
+	std::list<int> rc{1, 2, 3};
+	a.splice(a.end(), c);
+	ra.splice(ra.end(), rc);
+	expect_same(a, ra);
+	ASSERT_TRUE(c.empty());
+
+	a.splice(std::next(a.begin(), 5), small_unrolled{7, 8});
+	ra.splice(std::next(ra.begin(), 5), std::list<int>{7, 8});
+	expect_same(a, ra);
+
+	// first and last in the same node
+	small_unrolled d{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	std::list<int> rd(d.begin(), d.end());
+	a.splice(a.cend(), d, std::next(d.begin(), 2), std::next(d.begin(), 5));
+	ra.splice(ra.cend(), rd, std::next(rd.begin(), 2), std::next(rd.begin(), 5));
+	expect_same(a, ra);
+	expect_same(d, rd);
+
+	// within one list, pos in the node split at first
+	d.splice(std::next(d.begin(), 6), d, std::next(d.begin(), 1),
+	         std::next(d.begin(), 3));
+	rd.splice(std::next(rd.begin(), 6), rd, std::next(rd.begin(), 1),
+	          std::next(rd.begin(), 3));
+	expect_same(d, rd);
+
+	// the list keeps working after splitting nodes
+	a.push_back(-1);
+	ra.push_back(-1);
+	a.insert(std::next(a.begin(), 20), -2);
+	ra.insert(std::next(ra.begin(), 20), -2);
+	expect_same(a, ra);
+}
+
+TEST(unrolled_list, strings) {
+	tp::unrolled_list<std::string, std::allocator<std::string>, 128> lt;
+	std::list<std::string> ref;
+	std::mt19937 rng(7);
+	for (int step = 0; step < 3000; ++step) {
+		std::size_t pos =
+		    ref.empty() ? 0 : rng() % (ref.size() + (step % 3 == 0));
+		if (ref.empty() || rng() % 3) {
+			std::string s(20 + rng() % 20, char('a' + step % 26));
+			lt.insert(std::next(lt.begin(), pos), s);
+			ref.insert(std::next(ref.begin(), pos), s);
+		} else {
+			pos %= ref.size();
+			lt.erase(std::next(lt.begin(), pos));
+			ref.erase(std::next(ref.begin(), pos));
+		}
+	}
+	expect_same(lt, ref);
+
+	auto copy = lt;
+	ASSERT_TRUE(copy == lt);
+	auto moved = std::move(copy);
+	ASSERT_TRUE(copy.empty());
+	ASSERT_TRUE(moved == lt);
+	copy = moved;
+	moved.clear();
+	moved.swap(copy);
+	ASSERT_TRUE(copy.empty());
+	expect_same(moved, ref);
+}
+
+TEST(unrolled_list, insert_aliasing) {
+	using str_list = tp::unrolled_list<std::string, std::allocator<std::string>,
+	                                   256>;
+	str_list lt;
+	std::list<std::string> ref;
+	for (std::size_t i = 0; i < str_list::node_elems; ++i) {
+		lt.push_back(std::string(40, char('a' + i)));
+		ref.push_back(lt.back());
+	}
+	ASSERT_EQ(lt.node_count(), 1);
+	// the full node splits, moving the element being copied
+	lt.insert(std::next(lt.begin()), lt.back());
+	ref.insert(std::next(ref.begin()), ref.back());
+	expect_same(lt, ref);
+	lt.insert(std::next(lt.begin(), 2), std::move(lt.back()));
+	ref.insert(std::next(ref.begin(), 2), std::move(ref.back()));
+	expect_same(lt, ref);
+}
+
+TEST(unrolled_list, random_ops) {
+	small_unrolled lt;
+	std::list<int> ref;
+	std::mt19937 rng(1);
+	for (int step = 0; step < 20000; ++step) {
+		std::size_t pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+		switch (rng() % 6) {
+		case 0:
+		case 1:
+		case 2:
+			lt.insert(std::next(lt.begin(), pos), step);
+			ref.insert(std::next(ref.begin(), pos), step);
+			break;
+		case 3:
+		case 4:
+			if (pos < ref.size()) {
+				auto it  = lt.erase(std::next(lt.begin(), pos));
+				auto rit = ref.erase(std::next(ref.begin(), pos));
+				ASSERT_EQ(it == lt.end(), rit == ref.end());
+				if (rit != ref.end()) {
+					ASSERT_EQ(*it, *rit);
+				}
+			}
+			break;
+		default: {
+			small_unrolled other{step, step + 1, step + 2};
+			std::list<int> rother{step, step + 1, step + 2};
+			lt.splice(std::next(lt.begin(), pos), other);
+			ref.splice(std::next(ref.begin(), pos), rother);
+		}
+		}
+		if (step % 1000 == 0)
+			expect_same(lt, ref);
+	}
+	expect_same(lt, ref);
+}
@@ -1,5 +1,7 @@
 #include <vector.hpp>
 #include <gtest/gtest.h>
+#include <span>
+#include <string>
 
 TEST(vector, iterator) {
 	vector<int> vec{1,2,3,4};
@@ -167,3 +169,116 @@ TEST(vector, erase_2) {
 		++it;
 	}
 }
+
+TEST(vector, growth_policy) {
+	vector<int, std::allocator<int>, tp::exact_growth> exact;
+	vector<int, std::allocator<int>, tp::doubling_growth> doubling;
+	vector<int, std::allocator<int>, tp::golden_growth> golden;
+	vector<int, std::allocator<int>, tp::jemalloc_growth> jemalloc;
+	int nums[] = {1, 2, 3};
+
+	for (int i = 0; i < 10; ++i) {
+		exact.insert(exact.end(), nums, nums + 3);
+		doubling.insert(doubling.end(), nums, nums + 3);
+		golden.insert(golden.end(), nums, nums + 3);
+		jemalloc.insert(jemalloc.end(), nums, nums + 3);
+	}
+
+	ASSERT_EQ(exact.capacity(), 30);
+	ASSERT_EQ(doubling.capacity(), 48);
+	ASSERT_EQ(golden.capacity(), 42);
+	// 1.5x growth rounded up to 4-per-doubling size classes in bytes
+	ASSERT_EQ(jemalloc.capacity() * sizeof(int),
+	          tp::jemalloc_growth::size_class(jemalloc.capacity() *
+	                                          sizeof(int)));
+	ASSERT_GE(jemalloc.capacity(), 30);
+
+	for (std::size_t i = 0; i < 30; ++i) {
+		ASSERT_EQ(exact[i], nums[i % 3]);
+		ASSERT_EQ(doubling[i], nums[i % 3]);
+		ASSERT_EQ(golden[i], nums[i % 3]);
+		ASSERT_EQ(jemalloc[i], nums[i % 3]);
+	}
+}
+
+TEST(vector, resize) {
+	vector<int> vec{1, 2};
+	vec.resize(4);
+	ASSERT_EQ(vec.size(), 4);
+	ASSERT_EQ(vec[1], 2);
+	ASSERT_EQ(vec[3], 0);
+
+	vec.resize(6, 7);
+	ASSERT_EQ(vec.size(), 6);
+	ASSERT_EQ(vec[3], 0);
+	ASSERT_EQ(vec[5], 7);
+
+	vec.resize(1);
+	ASSERT_EQ(vec.size(), 1);
+	ASSERT_EQ(vec[0], 1);
+}
+
+TEST(vector, resize_for_overwrite) {
+	vector<int> vec{1, 2};
+	vec.resize_for_overwrite(5);
+	ASSERT_EQ(vec.size(), 5);
+	ASSERT_GE(vec.capacity(), 5);
+	ASSERT_EQ(vec[1], 2);
+
+	vec[2] = vec[3] = vec[4] = 3;
+	ASSERT_EQ(vec.back(), 3);
+}
+
+TEST(vector, append_range) {
+	vector<int> vec{1};
+	int nums[] = {2, 3, 4};
+	std::initializer_list<long> il{5, 6};
+
+	vec.append_range(nums);
+	vec.append_range(il);
+	vec.append_range(std::views::iota(7, 9));
+	ASSERT_EQ(vec.size(), 8);
+	for (int i = 0; i < 8; ++i)
+		ASSERT_EQ(vec[i], i + 1);
+}
+
+TEST(vector, append_range_self) {
+	vector<int> vec{1, 2, 3, 4};
+	vec.shrink_to_fit();
+	vec.append_range(std::span(vec.data(), vec.size()));
+	ASSERT_EQ(vec.size(), 8);
+	for (int i = 0; i < 8; ++i)
+		ASSERT_EQ(vec[i], i % 4 + 1);
+
+	// a view over the vector is read before the buffer moves
+	vec.shrink_to_fit();
+	vec.append_range(std::span(vec.data(), 4) | std::views::reverse);
+	ASSERT_EQ(vec.size(), 12);
+	ASSERT_EQ(vec[8], 4);
+	ASSERT_EQ(vec[11], 1);
+
+	vector<std::string> strs{std::string(40, 'a'), std::string(40, 'b')};
+	strs.shrink_to_fit();
+	strs.append_range(std::span(strs.data(), strs.size()));
+	ASSERT_EQ(strs.size(), 4);
+	ASSERT_EQ(strs[3], std::string(40, 'b'));
+}
+
+TEST(vector, append_uninitialized) {
+	vector<int> vec{1};
+
+	vec.append_uninitialized(3, [](int *first, std::size_t n) {
+		for (std::size_t i = 0; i < n; ++i)
+			first[i] = i + 2;
+	});
+	ASSERT_EQ(vec.size(), 4);
+
+	// a short write only appends what was written
+	vec.append_uninitialized(8, [](int *first, std::size_t) {
+		first[0] = 5;
+		return std::size_t(1);
+	});
+	ASSERT_EQ(vec.size(), 5);
+	for (int i = 0; i < 5; ++i)
+		ASSERT_EQ(vec[i], i + 1);
+}
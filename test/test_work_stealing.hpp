@@ -0,0 +1,147 @@
+#include <atomic>
+#include <chase_lev_deque.hpp>
+#include <gtest/gtest.h>
+#include <parallel.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector.hpp>
+#include <vector>
+#include <work_stealing_pool.hpp>
+
+TEST(chase_lev_deque, owner) {
+	tp::chase_lev_deque<long> dq(4);
+	long v;
+	ASSERT_FALSE(dq.pop(v));
+	ASSERT_FALSE(dq.steal(v));
+
+	// grows past the initial capacity
+	for (long i = 0; i < 100; ++i)
+		dq.push(i);
+	ASSERT_EQ(dq.size(), 100);
+	ASSERT_GE(dq.capacity(), 100);
+
+	// the owner takes the newest, a thief the oldest
+	ASSERT_TRUE(dq.pop(v));
+	ASSERT_EQ(v, 99);
+	ASSERT_TRUE(dq.steal(v));
+	ASSERT_EQ(v, 0);
+	for (long i = 98; i >= 1; --i) {
+		ASSERT_TRUE(dq.pop(v));
+		ASSERT_EQ(v, i);
+	}
+	ASSERT_FALSE(dq.pop(v));
+	ASSERT_TRUE(dq.empty());
+}
+
+TEST(chase_lev_deque, thieves) {
+	// every element is taken exactly once by the owner or one of the thieves
+	constexpr long n = 100000;
+	tp::chase_lev_deque<long> dq(16);
+	std::vector<std::atomic<int>> taken(n);
+	std::atomic<bool> done{false};
+
+	std::vector<std::thread> thieves;
+	for (int k = 0; k < 3; ++k)
+		thieves.emplace_back([&] {
+			long v;
+			while (!done.load()) {
+				if (dq.steal(v))
+					++taken[v];
+				else
+					std::this_thread::yield();
+			}
+		});
+
+	long v;
+	for (long i = 0; i < n; ++i) {
+		dq.push(i);
+		if (i % 3 == 0 && dq.pop(v))
+			++taken[v];
+	}
+	while (dq.pop(v))
+		++taken[v];
+	// what the thieves hold in flight is counted before they stop
+	while (!dq.empty())
+		std::this_thread::yield();
+	done = true;
+	for (auto &t : thieves)
+		t.join();
+	for (long i = 0; i < n; ++i)
+		ASSERT_EQ(taken[i], 1) << i;
+}
+
+static long ws_fib(long n, tp::work_stealing_pool &pool) {
+	if (n < 2)
+		return n;
+	long a, b;
+	tp::parallel_invoke([&] { a = ws_fib(n - 1, pool); },
+	                    [&] { b = ws_fib(n - 2, pool); }, pool);
+	return a + b;
+}
+
+TEST(work_stealing_pool, invoke) {
+	tp::work_stealing_pool pool(4);
+	ASSERT_EQ(pool.concurrency(), 4);
+	ASSERT_EQ(ws_fib(20, pool), 6765);
+
+	// several outside threads at once
+	std::vector<std::thread> callers;
+	std::atomic<long> total{0};
+	for (int k = 0; k < 3; ++k)
+		callers.emplace_back([&] { total += ws_fib(15, pool); });
+	for (auto &t : callers)
+		t.join();
+	ASSERT_EQ(total, 3 * 610);
+
+	tp::work_stealing_pool serial(1);
+	ASSERT_EQ(serial.concurrency(), 1);
+	ASSERT_EQ(ws_fib(15, serial), 610);
+}
+
+TEST(work_stealing_pool, exceptions) {
+	tp::work_stealing_pool pool(3);
+	std::atomic<int> ran{0};
+	ASSERT_THROW(tp::parallel_invoke([&] { ++ran; },
+	                                 [&] {
+		                                 ++ran;
+		                                 throw std::runtime_error("g");
+	                                 },
+	                                 pool),
+	             std::runtime_error);
+	ASSERT_EQ(ran, 2);
+
+	// f throws, g still runs before the exception gets out
+	ASSERT_THROW(tp::parallel_invoke([] { throw std::logic_error("f"); },
+	                                 [&] { ++ran; }, pool),
+	             std::logic_error);
+	ASSERT_EQ(ran, 3);
+
+	ASSERT_THROW(tp::parallel_for(
+	                 0, 1000,
+	                 [](int i) {
+		                 if (i == 777)
+			                 throw std::out_of_range("i");
+	                 },
+	                 10, pool),
+	             std::out_of_range);
+}
+
+TEST(work_stealing_pool, parallel_for) {
+	tp::work_stealing_pool pool(4);
+	std::vector<std::atomic<int>> hits(10000);
+	tp::parallel_for(0, 10000, [&](int i) { ++hits[i]; }, 0, pool);
+	for (auto &h : hits)
+		ASSERT_EQ(h, 1);
+
+	vector<long> vec;
+	vec.resize(5000);
+	tp::parallel_for(vec.begin(), vec.end(), [](auto it) { *it = 2; }, 64,
+	                 pool);
+	long sum = 0;
+	for (long x : vec)
+		sum += x;
+	ASSERT_EQ(sum, 10000);
+
+	// empty range
+	tp::parallel_for(5, 5, [](int) { FAIL(); }, 0, pool);
+}